@@ -0,0 +1,387 @@
+#include "includes.h"
+#include "headers.h"
+#include <atomic>
+#include <climits>
+#include <chrono>
+
+/**\brief Gibt den Dateinamen ohne Verzeichnis zurück (für die Meldungen)
+ * \param path
+ * \return string
+ */
+static string fileName(const string &path) {
+    size_t pos = path.find_last_of('/');
+    return pos == string::npos ? path : path.substr(pos+1);
+}
+
+/**\brief Entfernt Zeilenumbruch und Leerzeichen am Ende einer Zeile
+ * \param line
+ * \return string
+ */
+static string trimmed(const string &line) {
+    size_t end = line.find_last_not_of(" \t\r");
+    return end == string::npos ? "" : line.substr(0, end+1);
+}
+
+/**\brief Formatiert das Ergebnis für die Ausgabe in der GUI bzw. in poscli
+ * \param maxProblems (so viele Abweichungen werden höchstens einzeln aufgeführt)
+ * \return vector<string>
+ */
+vector<string> AuditReport::toLines(int maxProblems) const {
+    vector<string> fLines;
+    char line[160];
+    fLines.push_back("|=====Audit=====|");
+    snprintf(line, sizeof(line), "%llu Buchungen und %llu Einzahlungen aus %d Dateien geprüft (%d Threads, %lld ms)", transactionLines, depositLines, sources, threads, elapsedMs);
+    fLines.push_back(line);
+    snprintf(line, sizeof(line), "%d Nutzer mit Buchungen, Kassenstand laut depositlog.txt: %s€", checkedUsers, logvBalance.toString().c_str());
+    fLines.push_back(line);
+    if (withdrawals > Money()) {
+        snprintf(line, sizeof(line), "Entnahmen aus der Kasse (withdraw): %s€", withdrawals.toString().c_str());
+        fLines.push_back(line);
+    }
+    if (problemCount == 0) {
+        fLines.push_back("Keine Abweichungen gefunden.");
+        return fLines;
+    }
+    fLines.push_back(to_string(problemCount) + " Abweichungen:");
+    for (int i=0; i < problems.size() && i < maxProblems; i++) {
+        fLines.push_back(problems[i]);
+    }
+    if (problemCount > maxProblems) {
+        fLines.push_back("... und " + to_string(problemCount - maxProblems) + " weitere");
+    }
+    return fLines;
+}
+
+/**\brief Konstruktor für LedgerAudit-Objekte (ohne prepare() wird nichts geprüft)
+ */
+LedgerAudit::LedgerAudit() {
+}
+
+/**\brief Merkt sich den Stand, gegen den geprüft wird, und welche Dateien gelesen werden
+ * Von den aktiven Logdateien wird nur gelesen, was jetzt schon darin steht; was danach gebucht wird, gehört nicht mehr zum gemerkten Stand.
+ * \param fUsers, fSystem (gespeicherter Stand), fTransactionSegments, transactionLog, transactionMonth (Segmente, aktive Datei von transactionlog.txt und deren Monat JJJJMM),
+ *        fDepositSegments, depositLog (dasselbe für depositlog.txt), deletionLog (gelöschte Nutzer, siehe Persistence::deletionLogEntry)
+ */
+void LedgerAudit::prepare(const vector<User> &fUsers, const System &fSystem, const vector<LogSegmentInfo> &fTransactionSegments, string transactionLog, int transactionMonth, const vector<LogSegmentInfo> &fDepositSegments, string depositLog, string deletionLog) {
+    balances.clear();
+    for (int i=0; i < fUsers.size(); i++) {
+        balances.push_back(make_pair(fUsers[i].getName(), fUsers[i].getBalance()));
+    }
+    vBalance = fSystem.getvBalance();
+    transactionSources.clear();
+    depositSources.clear();
+    for (int i=0; i < fTransactionSegments.size(); i++) {
+        Source source = {fTransactionSegments[i].file, true, 0, fTransactionSegments[i].month};
+        transactionSources.push_back(source);
+    }
+    for (int i=0; i < fDepositSegments.size(); i++) {
+        Source source = {fDepositSegments[i].file, true, 0, fDepositSegments[i].month};
+        depositSources.push_back(source);
+    }
+    ifstream file;
+    file.open(transactionLog, ios::in | ios::binary | ios::ate);
+    Source transactionSource = {transactionLog, false, file.is_open() ? (unsigned long long)file.tellg() : 0, transactionMonth};
+    transactionSources.push_back(transactionSource);
+    file.close();
+    file.open(depositLog, ios::in | ios::binary | ios::ate);
+    Source depositSource = {depositLog, false, file.is_open() ? (unsigned long long)file.tellg() : 0, 0};
+    depositSources.push_back(depositSource);
+    readDeletions(deletionLog);
+}
+
+/**\brief Liest deletionlog.txt und ordnet jede Löschung der Datei von transactionlog.txt zu, in der sie stattgefunden hat
+ * Zeilen: "<Zeitstempel> | <NutzerID> | <Name> | <JJJJMM> | <Position>". Eine Löschung gehört zur letzten Datei, deren Monat nicht nach dem vermerkten liegt;
+ * ohne bekannte Position (-1) gilt sie erst am Ende dieser Datei.
+ * \param deletionLog
+ */
+void LedgerAudit::readDeletions(string deletionLog) {
+    ifstream file;
+    file.open(deletionLog, ios::in);
+    string line;
+    while (getline(file, line)) { // Name kann beliebige Zeichen enthalten, daher Monat und Position von hinten
+        size_t posPosition = line.rfind(" | ");
+        size_t posMonth = posPosition == string::npos || posPosition == 0 ? string::npos : line.rfind(" | ", posPosition-1);
+        size_t posID = line.find(" | ");
+        if (posMonth == string::npos || posID >= posMonth) {
+            continue;
+        }
+        int userID = atoi(line.c_str() + posID+3);
+        int month = atoi(line.c_str() + posMonth+3);
+        long long position = atoll(line.c_str() + posPosition+3);
+        int source = 0;
+        for (int i=1; i < transactionSources.size() && transactionSources[i].month <= month; i++) {
+            source = i;
+        }
+        transactionSources[source].deletions.push_back(make_pair(position < 0 ? ULLONG_MAX : (unsigned long long) position, userID));
+    }
+}
+
+/**\brief Liest alle vollständigen Zeilen einer Datei (Segment oder aktive Logdatei bis zur gemerkten Länge)
+ * \param source, lines, lineOffsets (Ausgabe: Zeilen und ihre Positionen in der (ursprünglichen) Logdatei)
+ * \return bool (false, wenn die Datei nicht gelesen werden konnte)
+ */
+bool LedgerAudit::readLines(const Source &source, vector<string> &lines, vector<unsigned long long> &lineOffsets) {
+    lines.clear();
+    lineOffsets.clear();
+    if (source.segment) {
+        Segment segment;
+        if (!segment.open(source.file) || !segment.readLineOffsets(lineOffsets)) {
+            return false;
+        }
+        lines.reserve(lineOffsets.size());
+        for (int i=0; i < lineOffsets.size(); i++) {
+            string line;
+            if (!segment.readLine(lineOffsets[i], line)) {
+                return false;
+            }
+            lines.push_back(line);
+        }
+        return true;
+    }
+    if (source.length == 0) {
+        return true;
+    }
+    ifstream file;
+    file.open(source.file, ios::in | ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    string content(source.length, '\0');
+    file.read(&content[0], source.length);
+    content.resize(file.gcount());
+    size_t start = 0;
+    size_t end;
+    while ((end = content.find('\n', start)) != string::npos) { // ohne Zeilenumbruch am Ende wird die Zeile gerade geschrieben
+        lines.push_back(content.substr(start, end-start));
+        lineOffsets.push_back(start);
+        start = end + 1;
+    }
+    return true;
+}
+
+/**\brief Beendet die Kette eines gelöschten Nutzers; die Ketten der folgenden Nutzer laufen unter der um eins kleineren ID weiter
+ * \param userID (ID beim Löschen), current (aktuelle NutzerID -> Kette in result.chains), result
+ */
+void LedgerAudit::deleteUser(int userID, map<int, int> &current, SourceResult &result) {
+    map<int, int> shifted;
+    for (map<int, int>::iterator it = current.begin(); it != current.end(); ++it) {
+        if (it->first != userID) {
+            shifted[it->first > userID ? it->first - 1 : it->first] = it->second;
+        }
+    }
+    current.swap(shifted);
+    result.deletions.push_back(userID);
+}
+
+/**\brief Prüft die Guthaben innerhalb einer Datei von transactionlog.txt
+ * Pro Nutzer muss jede Zeile mit dem Guthaben weiterrechnen, mit dem die vorige aufgehört hat. Die Enden der Ketten werden für den Abgleich über die Dateigrenzen hinweg zurückgegeben.
+ * Die Löschungen der Datei werden vor der ersten Zeile an oder nach ihrer Position angewendet (siehe deleteUser).
+ * \param source, result (Ausgabe)
+ */
+void LedgerAudit::checkTransactions(const Source &source, SourceResult &result) {
+    result.lines = 0;
+    result.problemCount = 0;
+    map<int, int> current; // aktuelle NutzerID -> Kette in result.chains
+    vector<string> lines;
+    vector<unsigned long long> lineOffsets;
+    size_t nextDeletion = 0;
+    if (!readLines(source, lines, lineOffsets)) {
+        result.problemCount++;
+        result.problems.push_back(fileName(source.file) + ": Datei konnte nicht gelesen werden");
+        return;
+    }
+    for (int i=0; i < lines.size(); i++) {
+        for (; nextDeletion < source.deletions.size() && source.deletions[nextDeletion].first <= lineOffsets[i]; nextDeletion++) {
+            deleteUser(source.deletions[nextDeletion].second, current, result);
+        }
+        string line = trimmed(lines[i]);
+        if (line.empty()) {
+            continue;
+        }
+        result.lines++;
+        int userID;
+        string beverage;
+        Money amount;
+        Money balance;
+        if (!ColumnStore::parseLine(line, userID, beverage, amount, balance)) {
+            if (result.problemCount++ < maxProblemsPerSource) {
+                result.problems.push_back(fileName(source.file) + ": Zeile nicht lesbar: " + line);
+            }
+            continue;
+        }
+        map<int, int>::iterator index = current.find(userID);
+        if (index == current.end()) {
+            int startID = userID;
+            for (int d = (int) result.deletions.size() - 1; d >= 0; d--) { // ID vor den bisherigen Löschungen in dieser Datei
+                if (startID >= result.deletions[d]) {
+                    startID++;
+                }
+            }
+            Chain fChain = {balance - amount, balance, line, line, startID, -1};
+            current[userID] = result.chains.size();
+            result.chains.push_back(fChain);
+            continue;
+        }
+        Chain &chain = result.chains[index->second];
+        if (chain.after + amount != balance && result.problemCount++ < maxProblemsPerSource) {
+            result.problems.push_back(fileName(source.file) + ": Nutzer " + to_string(userID) + ": erwartet " + (chain.after + amount).toString() + "€ in \"" + line + "\" nach \"" + chain.lastLine + "\"");
+        }
+        chain.after = balance;
+        chain.lastLine = line;
+    }
+    for (; nextDeletion < source.deletions.size(); nextDeletion++) {
+        deleteUser(source.deletions[nextDeletion].second, current, result);
+    }
+    for (map<int, int>::iterator it = current.begin(); it != current.end(); ++it) {
+        result.chains[it->second].endID = it->first;
+    }
+}
+
+/**\brief Prüft den Kassenstand in depositlog.txt (Segmente und aktive Datei nacheinander) und vergleicht ihn mit System::vBalance
+ * Jede Einzahlung muss den Kassenstand der vorigen um ihren Betrag erhöhen; nach einem cleardeplog gilt der dort genannte Kassenstand.
+ * Entnahmen mit withdraw stehen mit negativem Betrag in depositlog.txt und werden als Entnahmen gezählt; jeder andere Sprung im Kassenstand ist eine Abweichung.
+ * \param report (Ausgabe)
+ */
+void LedgerAudit::checkDeposits(AuditReport &report) const {
+    static const string resetMarker = "neuer Kontostand [€]: ";
+    bool known = false;
+    Money current;
+    string lastLine;
+    for (int i=0; i < depositSources.size(); i++) {
+        vector<string> lines;
+        vector<unsigned long long> lineOffsets;
+        if (!readLines(depositSources[i], lines, lineOffsets)) {
+            report.problemCount++;
+            report.problems.push_back(fileName(depositSources[i].file) + ": Datei konnte nicht gelesen werden");
+            continue;
+        }
+        for (int j=0; j < lines.size(); j++) {
+            string line = trimmed(lines[j]);
+            if (line.empty() || line == "---") {
+                continue;
+            }
+            report.depositLines++;
+            size_t posReset = line.find(resetMarker);
+            if (posReset != string::npos) {
+                Money balance;
+                if (Money::parse(line.substr(posReset + resetMarker.size()), balance)) {
+                    known = true;
+                    current = balance;
+                    lastLine = line;
+                    continue;
+                }
+            }
+            size_t posLD = line.rfind('|');
+            size_t posTD = posLD == string::npos || posLD == 0 ? string::npos : line.rfind('|', posLD-1);
+            Money amount;
+            Money balance;
+            if (posTD == string::npos || !Money::parse(line.c_str() + posTD+1, posLD-posTD-1, amount) || !Money::parse(line.substr(posLD+1), balance)) {
+                report.problemCount++;
+                report.problems.push_back(fileName(depositSources[i].file) + ": Zeile nicht lesbar: " + line);
+                continue;
+            }
+            if (amount < Money()) {
+                report.withdrawals -= amount;
+            }
+            if (known && current + amount != balance) {
+                report.problemCount++;
+                report.problems.push_back(fileName(depositSources[i].file) + ": Kasse: erwartet " + (current + amount).toString() + "€ in \"" + line + "\" nach \"" + lastLine + "\"");
+            }
+            known = true;
+            current = balance;
+            lastLine = line;
+        }
+    }
+    report.logvBalance = current;
+    if (known && vBalance != current) {
+        report.problemCount++;
+        report.problems.push_back("Kassenstand " + vBalance.toString() + "€, laut depositlog.txt aber " + current.toString() + "€ (letzte Zeile: \"" + lastLine + "\")");
+    }
+}
+
+/**\brief Führt die Prüfung durch
+ * Die Dateien von transactionlog.txt werden auf bis zu threads Threads verteilt (jeder nimmt sich die nächste noch nicht gelesene Datei);
+ * depositlog.txt ist deutlich kleiner und wird währenddessen im aufrufenden Thread geprüft.
+ * \param threads (Anzahl der Threads, mindestens 1)
+ * \return AuditReport
+ */
+AuditReport LedgerAudit::run(int threads) const {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    AuditReport report;
+    report.transactionLines = 0;
+    report.depositLines = 0;
+    report.checkedUsers = 0;
+    report.problemCount = 0;
+    report.sources = transactionSources.size() + depositSources.size();
+    report.threads = max(1, min(threads, (int)transactionSources.size()));
+    vector<SourceResult> results(transactionSources.size());
+    atomic<int> next(0);
+    vector<std::thread> workers;
+    for (int i=0; i < report.threads; i++) {
+        workers.push_back(std::thread([this, &results, &next]() {
+            int index;
+            while ((index = next++) < transactionSources.size()) {
+                checkTransactions(transactionSources[index], results[index]);
+            }
+        }));
+    }
+    checkDeposits(report);
+    for (int i=0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    map<int, Chain> chains; // über alle Dateien aneinandergehängt
+    for (int i=0; i < results.size(); i++) {
+        report.transactionLines += results[i].lines;
+        report.problemCount += results[i].problemCount;
+        report.problems.insert(report.problems.end(), results[i].problems.begin(), results[i].problems.end());
+        map<int, Chain> fChains; // NutzerIDs am Ende dieser Datei
+        for (int c=0; c < results[i].chains.size(); c++) {
+            const Chain &chain = results[i].chains[c];
+            Chain merged = chain;
+            map<int, Chain>::iterator previous = chains.find(chain.startID);
+            if (previous != chains.end()) {
+                if (previous->second.after != chain.before) {
+                    report.problemCount++;
+                    report.problems.push_back(fileName(transactionSources[i].file) + ": Nutzer " + to_string(chain.startID) + ": Guthaben springt von " + previous->second.after.toString() + "€ auf " + chain.before.toString() + "€ zwischen \"" + previous->second.lastLine + "\" und \"" + chain.firstLine + "\"");
+                }
+                merged.before = previous->second.before;
+                merged.firstLine = previous->second.firstLine;
+                chains.erase(previous);
+            }
+            if (chain.endID >= 0) {
+                fChains[chain.endID] = merged;
+            }
+        }
+        for (map<int, Chain>::iterator chain = chains.begin(); chain != chains.end(); ++chain) { // Nutzer ohne Zeilen in dieser Datei rücken nur bei Löschungen nach
+            int userID = chain->first;
+            for (int d=0; d < results[i].deletions.size() && userID >= 0; d++) {
+                userID = userID == results[i].deletions[d] ? -1 : userID > results[i].deletions[d] ? userID - 1 : userID;
+            }
+            if (userID >= 0) {
+                fChains[userID] = chain->second;
+            }
+        }
+        chains.swap(fChains);
+    }
+    for (int i=0; i < balances.size(); i++) {
+        map<int, Chain>::iterator chain = chains.find(i);
+        if (chain == chains.end()) {
+            if (balances[i].second != Money()) {
+                report.problemCount++;
+                report.problems.push_back("Nutzer " + to_string(i) + " (" + balances[i].first + "): Guthaben " + balances[i].second.toString() + "€, aber keine Buchungen im Log");
+            }
+            continue;
+        }
+        report.checkedUsers++;
+        if (chain->second.after != balances[i].second) {
+            report.problemCount++;
+            report.problems.push_back("Nutzer " + to_string(i) + " (" + balances[i].first + "): Guthaben " + balances[i].second.toString() + "€, laut Log " + chain->second.after.toString() + "€ (letzte Zeile: \"" + chain->second.lastLine + "\")");
+        }
+    }
+    for (map<int, Chain>::iterator chain = chains.lower_bound(balances.size()); chain != chains.end(); ++chain) {
+        report.problemCount++;
+        report.problems.push_back("Nutzer " + to_string(chain->first) + " existiert nicht mehr (gelöscht?), letzte Zeile: \"" + chain->second.lastLine + "\"");
+    }
+    report.elapsedMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,68 @@
+#include "includes.h"
+
+/**\brief Ergebnis einer Prüfung der Logs gegen den gespeicherten Stand (siehe LedgerAudit::run)
+ */
+struct AuditReport {
+    vector<string> problems; // gefundene Abweichungen, jeweils mit den betroffenen Zeilen (pro Datei höchstens die ersten 100)
+    unsigned long long problemCount; // Anzahl aller gefundenen Abweichungen
+    unsigned long long transactionLines; // geprüfte Zeilen aus transactionlog.txt (inkl. Segmente)
+    unsigned long long depositLines; // geprüfte Zeilen aus depositlog.txt (inkl. Segmente)
+    int checkedUsers; // Nutzer, deren Guthaben mit dem Log verglichen wurde
+    Money logvBalance; // Kassenstand laut depositlog.txt
+    Money withdrawals; // Entnahmen (withdraw) laut depositlog.txt
+    int sources; // gelesene Dateien (Segmente und aktive Logs)
+    int threads;
+    long long elapsedMs;
+    vector<string> toLines(int maxProblems) const;
+};
+
+/**\brief Klasse "Auditclass" für den Abgleich von transactionlog.txt, depositlog.txt und dem gespeicherten Stand (Guthaben und Kassenstand)
+ * Jede Zeile in transactionlog.txt enthält den Betrag und das Guthaben danach; pro Nutzer muss also altes Guthaben + Betrag das neue Guthaben ergeben,
+ * und die letzte Zeile eines Nutzers muss mit seinem Guthaben übereinstimmen. Genauso enthält jede Zeile in depositlog.txt den Kassenstand danach.
+ * Die Prüfung wird in zwei Schritten aufgerufen:
+ *      prepare() merkt sich im aufrufenden Thread die Guthaben, den Kassenstand und welche Dateien bis zu welcher Länge gelesen werden (die Logs müssen vorher mit Persistence::flush geschrieben sein),
+ *      run() liest danach die Segmente und die aktiven Logs und darf auch in einem anderen Thread laufen (z.B. im Hintergrund beim Start).
+ * run() verteilt die Dateien (ein Segment pro Monat, dazu die aktiven Logs) auf mehrere Threads. Jeder Thread prüft die Kette innerhalb seiner Datei und merkt sich pro Nutzer
+ * das Guthaben vor der ersten und nach der letzten Zeile; danach werden die Dateien in zeitlicher Reihenfolge aneinandergehängt, sodass auch Sprünge an den Monatsgrenzen auffallen.
+ * Beim Löschen eines Nutzers rücken alle folgenden eine ID nach vorne; deleteUser vermerkt das in deletionlog.txt mit Monat und Position in transactionlog.txt (siehe Persistence::deletionLogEntry).
+ * Dort endet die Kette des gelöschten Nutzers, und die Ketten aller folgenden Nutzer werden ab dieser Position unter der neuen ID weitergeführt.
+ */
+class LedgerAudit {
+private:
+    struct Source {
+        string file;
+        bool segment; // komprimiertes Segment, sonst aktive Logdatei
+        unsigned long long length; // nur aktive Logdatei: so weit wird gelesen (Stand bei prepare())
+        int month; // JJJJMM
+        vector<pair<unsigned long long, int> > deletions; // Position in der (ursprünglichen) Logdatei und NutzerID der Löschungen in dieser Datei, in zeitlicher Reihenfolge
+    };
+    struct Chain {
+        Money before; // Guthaben vor der ersten Zeile
+        Money after; // Guthaben nach der letzten Zeile
+        string firstLine;
+        string lastLine;
+        int startID; // NutzerID am Anfang der Datei (vor den Löschungen in der Datei)
+        int endID; // NutzerID am Ende der Datei (-1, wenn der Nutzer in der Datei gelöscht wurde)
+    };
+    struct SourceResult {
+        vector<Chain> chains; // Ketten innerhalb der Datei
+        vector<int> deletions; // gelöschte NutzerIDs in der Reihenfolge der Datei (jeweils nach den vorigen Löschungen gezählt)
+        vector<string> problems;
+        unsigned long long problemCount;
+        unsigned long long lines;
+    };
+    static const int maxProblemsPerSource = 100;
+    vector<Source> transactionSources; // älteste zuerst
+    vector<Source> depositSources; // älteste zuerst
+    vector<pair<string, Money> > balances; // Name und Guthaben pro NutzerID
+    Money vBalance;
+    static bool readLines(const Source &source, vector<string> &lines, vector<unsigned long long> &lineOffsets);
+    static void deleteUser(int userID, map<int, int> &current, SourceResult &result);
+    static void checkTransactions(const Source &source, SourceResult &result);
+    void readDeletions(string deletionLog);
+    void checkDeposits(AuditReport &report) const;
+public:
+    LedgerAudit();
+    void prepare(const vector<User> &fUsers, const System &fSystem, const vector<LogSegmentInfo> &fTransactionSegments, string transactionLog, int transactionMonth, const vector<LogSegmentInfo> &fDepositSegments, string depositLog, string deletionLog);
+    AuditReport run(int threads) const;
+};
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Benchmark posbench für die Bibliothek poscore (synthetische Datenbanken, Ergebnisse als JSON-Zeilen)
+#
+#-------------------------------------------------
+
+TARGET = posbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+OBJECTS_DIR = .obj/bench
+
+LIBS += -L$$OUT_PWD -lposcore -lz
+PRE_TARGETDEPS += $$OUT_PWD/libposcore.a
+
+SOURCES += \
+        benchmain.cpp
@@ -0,0 +1,218 @@
+#include "includes.h"
+#include "headers.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+/**\brief Benchmark "posbench" für die Bibliothek poscore
+ * Erzeugt synthetische Textdatenbanken (userDB.txt, beverageDB.txt, systemDB.txt) und Logs (transactionlog.txt, depositlog.txt)
+ * in einem eigenen Verzeichnis pro Größe und misst darauf Laden, Schreiben, Verkaufen, Historie, Einzahlungsliste, Verbrauchsliste und Auswertung (analyze).
+ * Jede Messung wird als eine JSON-Zeile auf der Standardausgabe ausgegeben, z.B.
+ *   {"benchmark":"sell","users":1000,"lines":1000,"ops":10000,"total_us":81234,"ns_per_op":8123}
+ * sodass die Ergebnisse zweier Versionen direkt verglichen werden können (Fortschritt und Hinweise gehen nach stderr).
+ * Aufruf: posbench [--max-users <n>] [--max-lines <n>] [--dir <Verzeichnis>]
+ * Das Verzeichnis muss neu oder leer sein (siehe ScratchDirectory); es wird nach dem Lauf wieder geleert.
+ */
+
+const int benchUserScales[] = {100, 1000, 10000, 100000};
+const long long benchLineScales[] = {1000, 10000, 100000, 1000000, 10000000};
+const int benchBeverages = 50; // so viele Getränke hat jede synthetische Datenbank
+const int benchDefaultUsers = 1000; // Nutzerzahl für die Messungen über die Loggröße
+const long long benchDefaultLines = 1000; // Loggröße für die Messungen über die Nutzerzahl
+const int benchSales = 10000; // Anzahl der einzelnen Verkäufe pro Messung
+const int benchRepeats = 20; // Wiederholungen der schnellen Messungen (Historie, Verbrauchsliste)
+
+typedef chrono::steady_clock BenchClock;
+
+static ScratchDirectory scratch; // Arbeitsverzeichnis, zwischen den Größen geleert
+
+/**\brief Gibt eine Messung als JSON-Zeile aus
+ * \param name, users, lines (Größe der Datenbank), ops (Anzahl der gemessenen Operationen), start (Beginn der Messung)
+ */
+static void report(const char *name, int users, long long lines, long long ops, BenchClock::time_point start) {
+    long long totalNs = chrono::duration_cast<chrono::nanoseconds>(BenchClock::now() - start).count();
+    cout << "{\"benchmark\":\"" << name << "\",\"users\":" << users << ",\"lines\":" << lines << ",\"ops\":" << ops
+         << ",\"total_us\":" << totalNs / 1000 << ",\"ns_per_op\":" << (ops > 0 ? totalNs / ops : 0) << "}" << endl;
+}
+
+/**\brief Lädt die Engine und bricht den Benchmark ab, wenn der gespeicherte Stand nicht lesbar ist
+ */
+static void loadEngine(PosEngine &engine) {
+    string error;
+    if (!engine.load(error)) {
+        cerr << error << endl;
+        exit(1);
+    }
+}
+
+/**\brief Erzeugt synthetische Textdatenbanken und Logs im aktuellen Verzeichnis
+ * Jeder Nutzer hat genug Guthaben für alle Verkäufe, jedes Getränk genug Bestand; die Logzeilen sind gleichmäßig auf alle Nutzer verteilt.
+ * Auf zehn Buchungen kommt eine Einzahlung in depositlog.txt.
+ * \param users, lines (Anzahl der Zeilen in transactionlog.txt)
+ */
+static void generate(int users, long long lines) {
+    string month = PosEngine::timestamp("%Y%m");
+    ofstream userDB("userDB.txt");
+    for (int i=0; i < users; i++) {
+        userDB << "user" << i << ";1000.00;" << (i == 0 ? 2 : 0) << "\n";
+    }
+    ofstream beverageDB("beverageDB.txt");
+    for (int i=0; i < benchBeverages; i++) {
+        beverageDB << "drink" << i << ";1." << (i % 10) << "0;" << 4000000 + i << ";" << 1000000 - i * 1000 << ";1000000\n";
+    }
+    ofstream systemDB("systemDB.txt");
+    systemDB << "1234\n0\n0\n";
+    ofstream transactionlog("transactionlog.txt");
+    ofstream depositlog("depositlog.txt");
+    char line[128];
+    for (long long i=0; i < lines; i++) {
+        int userID = i % users;
+        int day = 1 + (i * 28 / max(lines, 1LL));
+        snprintf(line, sizeof(line), "%s%02d120000 | %s | -1.10\t| 998.90\t| drink%d\n", month.c_str(), day, PosEngine::convertUserID(userID).c_str(), (int) (i % benchBeverages));
+        transactionlog << line;
+        if (i % 10 == 0) {
+            snprintf(line, sizeof(line), "%s%s%02d120000 | user%d\t| +5.00\t| %lld.00\n", PosEngine::convertUserID(userID).c_str(), month.c_str(), day, userID, 5 * (i / 10 + 1));
+            depositlog << line;
+        }
+    }
+}
+
+/**\brief Misst alle Lade- und Schreibvorgänge sowie die Verkäufe für eine Datenbankgröße
+ * \param users, lines
+ */
+static void benchDatabase(int users, long long lines) {
+    scratch.clear();
+    generate(users, lines);
+    {
+        PosEngine engine;
+        BenchClock::time_point start = BenchClock::now();
+        loadEngine(engine); // Textdatenbanken importieren, Logindex aufbauen, ersten Snapshot schreiben
+        engine.flush();
+        report("load_textdb", users, lines, 1, start);
+
+        start = BenchClock::now();
+        engine.exportDB();
+        report("export_textdb", users, lines, 1, start);
+
+        start = BenchClock::now();
+        engine.importDB();
+        engine.flush();
+        report("import_textdb", users, lines, 1, start);
+
+        string error;
+        start = BenchClock::now();
+        for (int i=0; i < benchSales; i++) {
+            vector<pair<int, int> > fSales(1, make_pair(i % users, i % benchBeverages));
+            engine.sell(fSales, error);
+        }
+        report("sell_submit", users, lines, benchSales, start);
+        engine.flush();
+        report("sell", users, lines, benchSales, start);
+
+        start = BenchClock::now();
+        for (int i=0; i < benchRepeats; i++) {
+            engine.getConsumption();
+        }
+        report("getconsumption", users, lines, benchRepeats, start);
+        engine.stop();
+    }
+    {
+        PosEngine engine;
+        BenchClock::time_point start = BenchClock::now();
+        loadEngine(engine); // Snapshot und Journal der vorherigen Verkäufe
+        report("load_snapshot", users, lines, 1, start);
+        engine.stop();
+    }
+}
+
+/**\brief Misst Historie und Einzahlungsliste für eine Loggröße
+ * \param users, lines
+ */
+static void benchLogs(int users, long long lines) {
+    scratch.clear();
+    generate(users, lines);
+    PosEngine engine;
+    BenchClock::time_point start = BenchClock::now();
+    loadEngine(engine);
+    report("load_interactive", users, lines, 1, start); // Nutzer und Getränke sind da, die Logs laden noch
+    engine.flush();
+    report("load_logindex", users, lines, 1, start);
+
+    start = BenchClock::now();
+    long long rows = 0;
+    for (int i=0; i < benchRepeats; i++) {
+        LogView view;
+        engine.openUserTransactions(i % users, 0, 99991231, view);
+        rows += view.readRows(0, view.getRowCount()).size();
+    }
+    report("history", users, lines, benchRepeats, start);
+
+    int today = atoi(PosEngine::timestamp("%Y%m").c_str()) * 100;
+    start = BenchClock::now();
+    for (int i=0; i < benchRepeats; i++) {
+        LogView view;
+        engine.openUserTransactions(i % users, today + 10, today + 12, view); // drei der 28 Tage
+        rows += view.readRows(0, view.getRowCount()).size();
+    }
+    report("history_range", users, lines, benchRepeats, start);
+
+    start = BenchClock::now();
+    LogView view;
+    engine.openDeposits(0, 99991231, view);
+    rows += view.readRows(0, view.getRowCount()).size();
+    report("depositlog", users, lines, 1, start);
+
+    start = BenchClock::now();
+    for (int i=0; i < benchRepeats; i++) {
+        LogView dayView;
+        engine.openDeposits(today + 1 + i % 28, today + 1 + i % 28, dayView);
+        rows += dayView.readRows(0, dayView.getRowCount()).size();
+    }
+    report("depositlog_day", users, lines, benchRepeats, start);
+
+    start = BenchClock::now();
+    for (int i=0; i < benchRepeats; i++) {
+        engine.getAnalysis(0, 99991231, 10);
+    }
+    report("analyze", users, lines, benchRepeats, start);
+    engine.stop();
+    cerr << "  " << rows << " Zeilen gelesen" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    int maxUsers = benchUserScales[3];
+    long long maxLines = benchLineScales[4];
+    string directory = "posbench.tmp";
+    for (int i=1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-users") == 0 && i+1 < argc) {
+            maxUsers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-lines") == 0 && i+1 < argc) {
+            maxLines = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && i+1 < argc) {
+            directory = argv[++i];
+        }
+        else {
+            cerr << "Aufruf: posbench [--max-users <n>] [--max-lines <n>] [--dir <Verzeichnis>]" << endl;
+            return 1;
+        }
+    }
+    string error;
+    if (!scratch.enter(directory, "posbench", error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    for (int i=0; i < 4 && benchUserScales[i] <= maxUsers; i++) {
+        cerr << "Datenbank mit " << benchUserScales[i] << " Nutzern..." << endl;
+        benchDatabase(benchUserScales[i], benchDefaultLines);
+    }
+    for (int i=0; i < 5 && benchLineScales[i] <= maxLines; i++) {
+        cerr << "Logs mit " << benchLineScales[i] << " Zeilen..." << endl;
+        benchLogs(benchDefaultUsers, benchLineScales[i]);
+    }
+    scratch.leave();
+    return 0;
+}
@@ -1,6 +1,16 @@
 #include "includes.h"
 #include "headers.h"
 
+/**\brief Konstruktor fuer Beverage Objekte
+ * Initialisiert ein Getraenk ohne Bestand und ohne bisherige Verkaeufe.
+ */
+Beverage::Beverage() {
+    barcode = 0;
+    stock = 0;
+    lastOrder = 0;
+    sold = 0;
+}
+
 //
 // set/edit-Methoden
 //
@@ -11,7 +21,7 @@
  * \return bool (true, wenn alle drei Methoden erfolgreich abgeschlossen wurden)
  * \warning Der Bestand ist erst einmal fest auf 0 gestellt
  */
-bool Beverage::createBeverage(string nName, double nPrice, int nBarcode) {
+bool Beverage::createBeverage(string nName, Money nPrice, long long nBarcode) {
     bool name_ch,price_ch,barcode_ch;
     name_ch = editName(nName);
     price_ch = editPrice(nPrice);
@@ -46,8 +56,8 @@ bool Beverage::editName(string nName) {
  * Ueberprueft, ob der eingegebene Preis positiv und groeßer 0 ist.
  * \return bool (true, wenn Preisänderung erfolgreich)
  */
-bool Beverage::editPrice(double price) {
-    if (price >= 0) {
+bool Beverage::editPrice(Money price) {
+    if (price >= Money()) {
         this->price = price;
         return true;
     }
@@ -62,7 +72,7 @@ bool Beverage::editPrice(double price) {
  * \return bool (true, wenn Barcodeänderung erfolgreich)
  * \warning Vor Aufrufen dieser Funktion sollte geprueft werden, ob bereits ein Objekt mit dem neuen gewuenschten Barcode exisitiert!
  */
-bool Beverage::editBarcode(int nBarcode) {
+bool Beverage::editBarcode(long long nBarcode) {
 	if (nBarcode >= 0) {
 		barcode = nBarcode;
         return true;
@@ -88,6 +98,16 @@ void Beverage::setLastOrder(int nBottles)
     lastOrder = nBottles;
 }
 
+/**\brief Setzt die laufend mitgefuehrten Verkaufszahlen (Verkauf, Journal und Snapshot)
+ * \param nSold verkaufte Flaschen
+ * \param nRevenue Umsatz mit diesem Getraenk
+ */
+void Beverage::setSales(int nSold, Money nRevenue)
+{
+    sold = nSold;
+    revenue = nRevenue;
+}
+
 
 //
 // get-Methoden
@@ -96,28 +116,28 @@ void Beverage::setLastOrder(int nBottles)
 /**\brief Gibt den Namen eines Getraenks zurueck
  * \return name (als string)
  */
-string Beverage::getName() {
+string Beverage::getName() const {
 	return name;
 }
 
 /**\brief Gibt den Preis eines Nutzers zurueck
- * \return price (als double)
+ * \return price (als Money)
  */
-double Beverage::getPrice() {
+Money Beverage::getPrice() const {
 	return price;
 }
 
 /**\brief Gibt den Barcode eines Getraenks zurueck
- * \return barcode (als int)
+ * \return barcode (als long long)
  */
-int Beverage::getBarcode() {
+long long Beverage::getBarcode() const {
     return barcode;
 }
 
 /**\brief Gibt den aktuellen Bestand der Getraenke zurueck
  * \return stock (als int)
  */
-int Beverage::getStock()
+int Beverage::getStock() const
 {
     return stock;
 }
@@ -125,7 +145,23 @@ int Beverage::getStock()
 /**\brief Gibt den Bestand, der durch die letzte Buchung entstanden ist, zurück
  * \return lastOrder (als int)
  */
-int Beverage::getLastOrder()
+int Beverage::getLastOrder() const
 {
     return lastOrder;
 }
+
+/**\brief Gibt die Anzahl der bisher verkauften Flaschen zurueck
+ * \return sold (als int)
+ */
+int Beverage::getSold() const
+{
+    return sold;
+}
+
+/**\brief Gibt den bisherigen Umsatz mit dem Getraenk zurueck
+ * \return revenue (als Money)
+ */
+Money Beverage::getRevenue() const
+{
+    return revenue;
+}
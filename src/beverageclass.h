@@ -11,22 +11,28 @@
 class Beverage {
 	private:
         string name; // Name des Getränks. Sollte einzigartig sein!
-		double price;
-        int barcode; // Barcode des Getraenks. Muss einzigartg sein!
+		Money price; // in Cent
+        long long barcode; // Barcode des Getraenks (EAN-13 passt nicht in int). Muss einzigartg sein!
         int stock;
         int lastOrder;
+        int sold; // bisher verkaufte Flaschen (laufend mitgeführt und im Snapshot gesichert)
+        Money revenue; // Umsatz mit diesem Getränk
 	public:
-        bool createBeverage(string nName, double nPrice, int nBarcode);
+        Beverage();
+        bool createBeverage(string nName, Money nPrice, long long nBarcode);
         bool editName(string nName);
-        bool editPrice(double nPrice);
-        bool editBarcode(int nBarcode);
+        bool editPrice(Money nPrice);
+        bool editBarcode(long long nBarcode);
         void setStock(int nStock);
         void setLastOrder(int nBottles);
-		string getName();
-		double getPrice();
-		int getBarcode();
-        int getStock();
-        int getLastOrder();
+        void setSales(int nSold, Money nRevenue);
+		string getName() const;
+		Money getPrice() const;
+		long long getBarcode() const;
+        int getStock() const;
+        int getLastOrder() const;
+        int getSold() const;
+        Money getRevenue() const;
 };
 
 
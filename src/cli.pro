@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Kommandozeilenprogramm poscli über derselben PosEngine wie die GUI
+#
+#-------------------------------------------------
+
+TARGET = poscli
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+OBJECTS_DIR = .obj/cli
+
+LIBS += -L$$OUT_PWD -lposcore -lz
+PRE_TARGETDEPS += $$OUT_PWD/libposcore.a
+
+SOURCES += \
+        climain.cpp
+
+DESTDIR = ../currentrelease
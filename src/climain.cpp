@@ -0,0 +1,334 @@
+#include "includes.h"
+#include "headers.h"
+#include <sstream>
+#include <cstdlib>
+
+/**\brief Kommandozeilenprogramm "poscli" über derselben PosEngine wie die GUI
+ * Arbeitet im aktuellen Verzeichnis mit denselben Dateien (Snapshot, Journal, Logs) wie die GUI; beide dürfen also nicht gleichzeitig laufen.
+ * Aufruf mit einem Kommando als Parameter (z.B. "poscli sell 3 0 0 2") oder ohne Parameter: dann wird ein Kommando pro Zeile von der Standardeingabe gelesen.
+ * Mit "--batch" werden die Kommandos der Standardeingabe als ein Stapel ausgeführt: gespeichert wird erst am Ende (ein Snapshot),
+ * beim ersten fehlgeschlagenen Kommando wird abgebrochen und nichts gespeichert.
+ * Mit "help" werden alle Kommandos aufgelistet.
+ */
+
+/**\brief Liest eine GetränkeID mit optionaler Anzahl ("<GetränkeID>" oder "<GetränkeID>:<Anzahl>")
+ * \return bool (false bei ungültiger Eingabe)
+ */
+static bool parseItem(const string &item, int &id, int &count) {
+    size_t posColon = item.find(':');
+    char *end;
+    id = strtol(item.c_str(), &end, 10);
+    count = 1;
+    if (end == item.c_str() || (*end != '\0' && *end != ':')) {
+        return false;
+    }
+    if (posColon != string::npos) {
+        const char *sCount = item.c_str() + posColon + 1;
+        count = strtol(sCount, &end, 10);
+        if (end == sCount || *end != '\0' || count <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**\brief Liest eine Ganzzahl
+ * \return bool (false, wenn text keine Ganzzahl ist)
+ */
+static bool parseInt(const string &text, int &value) {
+    char *end;
+    value = strtol(text.c_str(), &end, 10);
+    return end != text.c_str() && *end == '\0';
+}
+
+/**\brief Gibt alle Zeilen einer Ansicht aus (Historie bzw. Einzahlungsliste)
+ */
+static void printView(LogView &view) {
+    const int pageSize = 100;
+    for (int first = 0; first < view.getRowCount(); first += pageSize) {
+        vector<string> fRows = view.readRows(first, pageSize);
+        for (int i=0; i < fRows.size(); i++) {
+            cout << fRows[i] << endl;
+        }
+    }
+}
+
+/**\brief Führt ein Kommando aus
+ * \param engine, args (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte; der Grund wurde dann ausgegeben)
+ */
+static bool runCommand(PosEngine &engine, const vector<string> &args) {
+    const vector<User> &users = engine.getUsers();
+    const vector<Beverage> &beverages = engine.getBeverages();
+    string error;
+    if (args.empty()) {
+        return true;
+    }
+    if (args[0] == "help") {
+        cout << "lsusr" << endl;
+        cout << "   [Listet alle Nutzer mit ID und Guthaben auf]" << endl;
+        cout << "lsbvr" << endl;
+        cout << "   [Listet alle Getränke mit ID, Preis und Bestand auf]" << endl;
+        cout << "statement" << endl;
+        cout << "   [Gibt das Geld in der Kasse aus]" << endl;
+        cout << "sell <NutzerID> <GetränkeID>[:<Anzahl>] ..." << endl;
+        cout << "   [Bucht alle Getränke in einem Stapel für einen Nutzer]" << endl;
+        cout << "deposit <NutzerID> <Betrag>" << endl;
+        cout << "   [Lädt das Konto eines Nutzers auf]" << endl;
+        cout << "withdraw <Betrag>" << endl;
+        cout << "   [Entnimmt Geld aus der Kasse]" << endl;
+        cout << "abvro <GetränkeID> <Anzahl>" << endl;
+        cout << "   [Bucht eine Lieferung]" << endl;
+        cout << "history <NutzerID> [<von> [<bis>]]" << endl;
+        cout << "   [Gibt alle Buchungen eines Nutzers aus, neueste zuerst; <von>/<bis> als JJJJMMTT oder ganze Monate als JJJJMM]" << endl;
+        cout << "depositlog [<von> [<bis>]]" << endl;
+        cout << "   [Gibt die Einzahlungsliste aus; <von>/<bis> als JJJJMMTT oder ganze Monate als JJJJMM]" << endl;
+        cout << "sales [<vonJJJJMMTT> [<bisJJJJMMTT>]]" << endl;
+        cout << "   [Gibt Flaschen, Umsatz und Einzahlungen pro Tag aus, ohne Parameter für den aktuellen Monat]" << endl;
+        cout << "topusr [<Anzahl>]" << endl;
+        cout << "   [Gibt die Nutzer mit den meisten gekauften Flaschen aus]" << endl;
+        cout << "analyze [<vonJJJJMMTT> [<bisJJJJMMTT>]]" << endl;
+        cout << "   [Wertet alle Buchungen des Zeitraums nach Tagen, Getränken und Nutzern aus, ohne Parameter den aktuellen Monat]" << endl;
+        cout << "audit [<Threads>]" << endl;
+        cout << "   [Prüft transactionlog.txt und depositlog.txt gegen alle Guthaben und den Kassenstand, ohne Parameter mit allen Prozessorkernen]" << endl;
+        cout << "stats" << endl;
+        cout << "   [Gibt p50/p99/max der Phasen von Verkauf und Einzahlung aus und setzt sie zurück]" << endl;
+        return true;
+    }
+    else if (args[0] == "lsusr" && args.size() == 1) {
+        for (int i=0; i < users.size(); i++) {
+            cout << i << " | " << users[i].getName() << " | " << users[i].getBalance() << endl;
+        }
+        return true;
+    }
+    else if (args[0] == "lsbvr" && args.size() == 1) {
+        for (int i=0; i < beverages.size(); i++) {
+            cout << i << " | " << beverages[i].getName() << " | " << beverages[i].getPrice() << " | " << beverages[i].getStock() << endl;
+        }
+        return true;
+    }
+    else if (args[0] == "statement" && args.size() == 1) {
+        cout << engine.getSystem().getvBalance() << endl;
+        return true;
+    }
+    else if (args[0] == "sell" && args.size() >= 3) {
+        int userID;
+        vector<pair<int, int> > fSales;
+        if (!parseInt(args[1], userID)) {
+            cout << "Falsche Parameter für 'sell'..." << endl;
+            return false;
+        }
+        for (int i=2; i < args.size(); i++) {
+            int id;
+            int count;
+            if (!parseItem(args[i], id, count)) {
+                cout << "Falsche Parameter für 'sell'..." << endl;
+                return false;
+            }
+            for (int j=0; j < count; j++) {
+                fSales.push_back(make_pair(userID, id));
+            }
+        }
+        if (!engine.sell(fSales, error)) {
+            cout << error << endl;
+            return false;
+        }
+        cout << users[userID].getName() << ": " << users[userID].getBalance() << endl;
+        return true;
+    }
+    else if (args[0] == "deposit" && args.size() == 3) {
+        int userID;
+        Money amount;
+        if (!parseInt(args[1], userID) || !Money::parse(args[2], amount)) {
+            cout << "Falsche Parameter für 'deposit'..." << endl;
+            return false;
+        }
+        if (!engine.deposit(userID, amount, engine.newTransactionID(userID), error)) {
+            cout << error << endl;
+            return false;
+        }
+        cout << users[userID].getName() << ": " << users[userID].getBalance() << endl;
+        return true;
+    }
+    else if (args[0] == "withdraw" && args.size() == 2) {
+        Money amount;
+        if (!Money::parse(args[1], amount) || !engine.withdraw(amount, error)) {
+            cout << "Nicht genug Geld in der Kasse..." << endl;
+            return false;
+        }
+        cout << engine.getSystem().getvBalance() << endl;
+        return true;
+    }
+    else if (args[0] == "abvro" && args.size() == 3) {
+        int id;
+        int bottles;
+        if (!parseInt(args[1], id) || !parseInt(args[2], bottles) || !engine.restock(id, bottles, error)) {
+            cout << (error.empty() ? "Falsche Parameter für 'abvro'..." : error) << endl;
+            return false;
+        }
+        cout << beverages[id].getName() << ": " << beverages[id].getStock() << endl;
+        return true;
+    }
+    else if (args[0] == "history" && args.size() >= 2 && args.size() <= 4) {
+        int userID;
+        if (!parseInt(args[1], userID) || userID < 0 || userID >= users.size()) {
+            cout << "Unbekannter Nutzer" << endl;
+            return false;
+        }
+        int fromDay = 0;
+        int toDay = 99991231;
+        if (args.size() >= 3 && !parseInt(args[2], fromDay)) {
+            cout << "Falsche Parameter für 'history'..." << endl;
+            return false;
+        }
+        toDay = args.size() >= 3 ? fromDay : toDay;
+        if (args.size() == 4 && !parseInt(args[3], toDay)) {
+            cout << "Falsche Parameter für 'history'..." << endl;
+            return false;
+        }
+        PosEngine::expandDayRange(fromDay, toDay);
+        LogView view;
+        engine.openUserTransactions(userID, fromDay, toDay, view);
+        printView(view);
+        return true;
+    }
+    else if (args[0] == "depositlog" && args.size() <= 3) {
+        int fromDay = 0;
+        int toDay = 99991231;
+        if (args.size() >= 2 && !parseInt(args[1], fromDay)) {
+            cout << "Falsche Parameter für 'depositlog'..." << endl;
+            return false;
+        }
+        toDay = args.size() >= 2 ? fromDay : toDay;
+        if (args.size() == 3 && !parseInt(args[2], toDay)) {
+            cout << "Falsche Parameter für 'depositlog'..." << endl;
+            return false;
+        }
+        PosEngine::expandDayRange(fromDay, toDay);
+        LogView view;
+        engine.openDeposits(fromDay, toDay, view);
+        printView(view);
+        return true;
+    }
+    else if (args[0] == "sales" && args.size() <= 3) {
+        int fromDay = PosEngine::today() / 100 * 100 + 1;
+        int toDay = fromDay + 30;
+        if (args.size() >= 2 && !parseInt(args[1], fromDay)) {
+            cout << "Falsche Parameter für 'sales'..." << endl;
+            return false;
+        }
+        toDay = args.size() >= 2 ? fromDay : toDay;
+        if (args.size() == 3 && !parseInt(args[2], toDay)) {
+            cout << "Falsche Parameter für 'sales'..." << endl;
+            return false;
+        }
+        vector<string> fLines = engine.getSalesReport(fromDay, toDay);
+        for (int i=0; i < fLines.size(); i++) {
+            cout << fLines[i] << endl;
+        }
+        return true;
+    }
+    else if (args[0] == "analyze" && args.size() <= 3) {
+        int fromDay = PosEngine::today() / 100 * 100 + 1;
+        int toDay = fromDay + 30;
+        if (args.size() >= 2 && !parseInt(args[1], fromDay)) {
+            cout << "Falsche Parameter für 'analyze'..." << endl;
+            return false;
+        }
+        toDay = args.size() >= 2 ? fromDay : toDay;
+        if (args.size() == 3 && !parseInt(args[2], toDay)) {
+            cout << "Falsche Parameter für 'analyze'..." << endl;
+            return false;
+        }
+        vector<string> fLines = engine.getAnalysis(fromDay, toDay, 10);
+        for (int i=0; i < fLines.size(); i++) {
+            cout << fLines[i] << endl;
+        }
+        return true;
+    }
+    else if (args[0] == "topusr" && args.size() <= 2) {
+        int count = 10;
+        if (args.size() == 2 && !parseInt(args[1], count)) {
+            cout << "Falsche Parameter für 'topusr'..." << endl;
+            return false;
+        }
+        vector<string> fLines = engine.getUserReport(count);
+        for (int i=0; i < fLines.size(); i++) {
+            cout << fLines[i] << endl;
+        }
+        return true;
+    }
+    else if (args[0] == "audit" && args.size() <= 2) {
+        int threads = 0;
+        if (args.size() == 2 && (!parseInt(args[1], threads) || threads <= 0)) {
+            cout << "Falsche Parameter für 'audit'..." << endl;
+            return false;
+        }
+        vector<string> fLines = engine.audit(threads);
+        for (int i=0; i < fLines.size(); i++) {
+            cout << fLines[i] << endl;
+        }
+        return true;
+    }
+    else if (args[0] == "stats" && args.size() == 1) {
+        vector<string> fLines = engine.getLatencyStats().report();
+        for (int i=0; i < fLines.size(); i++) {
+            cout << fLines[i] << endl;
+        }
+        engine.getLatencyStats().reset();
+        return true;
+    }
+    cout << "Das Kommando wurde nicht erkannt oder hat falsche Parameter ('help' listet alle Kommandos auf)." << endl;
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    PosEngine engine;
+    string error;
+    if (!engine.load(error)) {
+        cout << error << endl;
+        return 1;
+    }
+    if (engine.getUsers().empty()) {
+        cout << "Noch kein Nutzer vorhanden, bitte zuerst das First-Time-Setup in der GUI durchführen." << endl;
+    }
+    bool success = true;
+    bool batch = argc == 2 && string(argv[1]) == "--batch";
+    if (argc > 1 && !batch) {
+        vector<string> args(argv + 1, argv + argc);
+        success = runCommand(engine, args);
+    }
+    else {
+        if (batch) {
+            engine.beginBatch();
+        }
+        string line;
+        int lineNumber = 0;
+        while (getline(cin, line)) {
+            lineNumber++;
+            istringstream words(line);
+            vector<string> args;
+            string word;
+            while (words >> word) {
+                args.push_back(word);
+            }
+            if (batch && (args.empty() || args[0][0] == '#')) {
+                continue;
+            }
+            success = runCommand(engine, args) && success;
+            if (batch && !success) {
+                cout << "Stapel in Zeile " << lineNumber << " abgebrochen, es wurde nichts gespeichert." << endl;
+                break;
+            }
+        }
+        if (batch && success) {
+            engine.commitBatch();
+        }
+        else if (batch) {
+            engine.rollbackBatch();
+        }
+    }
+    engine.stop();
+    return success ? 0 : 1;
+}
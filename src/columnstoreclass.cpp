@@ -0,0 +1,470 @@
+#include "includes.h"
+#include "headers.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t columnRowSize = 32; // Zeitpunkt (8) + NutzerID (4) + Getränk (4) + Betrag (8) + Guthaben (8)
+
+/**\brief Sortierreihenfolge für die Ranglisten: größter Wert zuerst, bei Gleichstand nach dem Schlüssel
+ */
+template <typename Key>
+static bool largerFirst(const pair<Key, long long> &a, const pair<Key, long long> &b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+}
+
+/**\brief Konstruktor für ColumnStore-Objekte
+ * Standardmäßig liegen die Spalten in transactions.col, das Wörterbuch der Getränke in transactions.dict und die abgedeckte Position der Logdatei in transactions.pos.
+ */
+ColumnStore::ColumnStore() {
+    setPaths("transactions.col", "transactions.dict", "transactions.pos");
+}
+
+/**\brief Setzt die Pfade der Spaltendatei, des Wörterbuchs und der Positionsdatei
+ * \param nPath (Pfad der Spaltendatei), nDictionaryPath (Pfad des Wörterbuchs), nPositionPath (Pfad der Positionsdatei)
+ */
+void ColumnStore::setPaths(string nPath, string nDictionaryPath, string nPositionPath) {
+    lock_guard<mutex> lock(storeMutex);
+    path = nPath;
+    dictionaryPath = nDictionaryPath;
+    positionPath = nPositionPath;
+    coveredMonth = 0;
+    coveredSize = 0;
+    storedRows = 0;
+    chunks.clear();
+    names.clear();
+    codes.clear();
+    pendingRows.clear();
+    pendingNames.clear();
+}
+
+/**\brief Zerlegt eine Zeile aus transactionlog.txt (z.B. "0705122046 | 03 | -0.80\t| 29.20\t| Fritz Cola")
+ * \param line, userID, beverage (Getränkename bzw. "AUFLADUNG"), amount (mit Vorzeichen), balance (Guthaben danach)
+ * \return bool (false, wenn die Zeile nicht dem Format entspricht)
+ */
+bool ColumnStore::parseLine(const string &line, int &userID, string &beverage, Money &amount, Money &balance) {
+    size_t posFD = line.find('|');
+    size_t posSD = posFD == string::npos ? string::npos : line.find('|', posFD+1);
+    size_t posTD = posSD == string::npos ? string::npos : line.find('|', posSD+1);
+    size_t posLD = posTD == string::npos ? string::npos : line.find('|', posTD+1);
+    if (posLD == string::npos) {
+        return false;
+    }
+    userID = LogIndex::parseUserID(line);
+    if (userID < 0 || !Money::parse(line.c_str() + posSD+1, posTD-posSD-1, amount) || !Money::parse(line.c_str() + posTD+1, posLD-posTD-1, balance)) {
+        return false;
+    }
+    size_t start = line.find_first_not_of(" \t", posLD+1);
+    size_t end = line.find_last_not_of(" \t\r");
+    beverage = start == string::npos || end < start ? "" : line.substr(start, end-start+1);
+    return true;
+}
+
+/**\brief Gibt die Unixzeit von Mitternacht (Ortszeit) eines Tages zurück
+ * Ungültige Tage werden wie bei mktime weitergezählt (z.B. der 32. Januar ist der 1. Februar).
+ * \param year, month (1-12), day
+ * \return long long (Unixzeit)
+ */
+long long ColumnStore::dayStart(int year, int month, int day) {
+    struct tm local;
+    memset(&local, 0, sizeof(local));
+    local.tm_year = year - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = day;
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+/**\brief Gibt den Tag (Ortszeit) eines Zeitpunkts zurück
+ * \param time (Unixzeit)
+ * \return int (JJJJMMTT)
+ */
+int ColumnStore::dayOf(long long time) {
+    time_t t = time;
+    struct tm local;
+    localtime_r(&t, &local);
+    return (local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday;
+}
+
+/**\brief Gibt den Code eines Getränks im Wörterbuch zurück und legt ihn bei Bedarf an
+ */
+int32_t ColumnStore::codeOf(const string &name) {
+    int code = codes.find(name);
+    if (code < 0) {
+        code = names.size();
+        names.push_back(name);
+        codes.insert(name, code);
+        pendingNames.push_back(name);
+    }
+    return code;
+}
+
+/**\brief Hängt eine Zeile an den letzten Block an (bzw. beginnt einen neuen) und führt Min/Max des Blocks mit
+ */
+void ColumnStore::addRow(int64_t time, int32_t userID, int32_t beverage, int64_t amount, int64_t balance) {
+    if (chunks.empty() || chunks.back().count == chunkRows) {
+        chunks.push_back(Chunk());
+        chunks.back().minTime = time;
+        chunks.back().maxTime = time;
+        chunks.back().minUser = userID;
+        chunks.back().maxUser = userID;
+    }
+    Chunk &chunk = chunks.back();
+    chunk.times[chunk.count] = time;
+    chunk.users[chunk.count] = userID;
+    chunk.beverages[chunk.count] = beverage;
+    chunk.amounts[chunk.count] = amount;
+    chunk.balances[chunk.count] = balance;
+    chunk.count++;
+    chunk.minTime = min(chunk.minTime, time);
+    chunk.maxTime = max(chunk.maxTime, time);
+    chunk.minUser = min(chunk.minUser, userID);
+    chunk.maxUser = max(chunk.maxUser, userID);
+}
+
+/**\brief Lädt Positionsdatei, Wörterbuch und Spaltendatei
+ * Zeilen hinter der in der Positionsdatei vermerkten Zeilenzahl (z.B. eine unvollständige letzte Zeile nach einem Absturz beim Schreiben) werden abgeschnitten,
+ * damit spätere Zeilen wieder an der richtigen Stelle angehängt werden. Zeilen mit unbekanntem Getränk werden übersprungen.
+ * Ein unvollständiger letzter Eintrag im Wörterbuch wird ebenfalls abgeschnitten.
+ * \return bool (false, wenn eine der Dateien fehlt, nicht zusammenpasst oder nicht gekürzt werden konnte; dann muss der Spaltenspeicher neu aufgebaut werden)
+ */
+bool ColumnStore::load() {
+    lock_guard<mutex> lock(storeMutex);
+    chunks.clear();
+    names.clear();
+    codes.clear();
+    pendingRows.clear();
+    pendingNames.clear();
+    coveredMonth = 0;
+    coveredSize = 0;
+    storedRows = 0;
+    ifstream position;
+    position.open(positionPath);
+    if (!position.is_open() || !(position >> coveredMonth >> coveredSize >> storedRows)) {
+        return false;
+    }
+    position.close();
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || (unsigned long long) info.st_size < storedRows * columnRowSize) {
+        return false;
+    }
+    if ((unsigned long long) info.st_size > storedRows * columnRowSize && truncate(path.c_str(), storedRows * columnRowSize) != 0) {
+        return false;
+    }
+    ifstream dictionary;
+    dictionary.open(dictionaryPath);
+    if (!dictionary.is_open()) {
+        return false;
+    }
+    string name;
+    unsigned long long dictionarySize = 0;
+    while (getline(dictionary, name)) {
+        if (dictionary.eof()) { // kein Zeilenumbruch am Ende: Absturz beim Schreiben
+            dictionary.close();
+            if (truncate(dictionaryPath.c_str(), dictionarySize) != 0) {
+                return false;
+            }
+            break;
+        }
+        codes.insert(name, names.size());
+        names.push_back(name);
+        dictionarySize += name.size() + 1;
+    }
+    dictionary.close();
+    ifstream columns;
+    columns.open(path, ios::in | ios::binary);
+    if (!columns.is_open()) {
+        return false;
+    }
+    vector<char> buffer(columnRowSize * chunkRows);
+    unsigned long long rowsRead = 0;
+    while (columns.read(buffer.data(), buffer.size()) || columns.gcount() > 0) {
+        size_t rows = columns.gcount() / columnRowSize;
+        for (size_t i=0; i < rows; i++) {
+            const char *row = buffer.data() + i * columnRowSize;
+            int64_t time;
+            int32_t userID;
+            int32_t beverage;
+            int64_t amount;
+            int64_t balance;
+            memcpy(&time, row, 8);
+            memcpy(&userID, row + 8, 4);
+            memcpy(&beverage, row + 12, 4);
+            memcpy(&amount, row + 16, 8);
+            memcpy(&balance, row + 24, 8);
+            if (beverage < (int32_t) names.size()) {
+                addRow(time, userID, beverage, amount, balance);
+            }
+        }
+        rowsRead += rows;
+    }
+    columns.close();
+    return rowsRead == storedRows;
+}
+
+/**\brief Leert den Spaltenspeicher samt Dateien (vor dem Neuaufbau)
+ * \return bool (false, wenn die Dateien nicht geleert werden konnten)
+ */
+bool ColumnStore::clear() {
+    lock_guard<mutex> lock(storeMutex);
+    chunks.clear();
+    names.clear();
+    codes.clear();
+    pendingRows.clear();
+    pendingNames.clear();
+    midnights.clear();
+    coveredMonth = 0;
+    coveredSize = 0;
+    storedRows = 0;
+    remove(positionPath.c_str());
+    ofstream emptyColumns(path, ios::out | ios::trunc | ios::binary);
+    ofstream emptyDictionary(dictionaryPath, ios::out | ios::trunc);
+    return emptyColumns.is_open() && emptyDictionary.is_open();
+}
+
+/**\brief Trägt eine neue Zeile von transactionlog.txt ein; an die Dateien angehängt wird erst mit commit()
+ * Einzahlungen ("AUFLADUNG" mit positivem Betrag) bekommen kein Getränk (-1). Zeilen, die nicht zerlegt werden können, werden ignoriert.
+ * \param time (Zeitpunkt der Buchung als Unixzeit), line
+ */
+void ColumnStore::add(long long time, const string &line) {
+    int userID;
+    string beverage;
+    Money amount;
+    Money balance;
+    if (!parseLine(line, userID, beverage, amount, balance)) {
+        return;
+    }
+    lock_guard<mutex> lock(storeMutex);
+    int32_t code = amount > Money() && beverage == "AUFLADUNG" ? -1 : codeOf(beverage);
+    addRow(time, userID, code, amount.getCents(), balance.getCents());
+    char row[columnRowSize];
+    int64_t t = time;
+    int32_t id = userID;
+    int64_t cents = amount.getCents();
+    int64_t balanceCents = balance.getCents();
+    memcpy(row, &t, 8);
+    memcpy(row + 8, &id, 4);
+    memcpy(row + 12, &code, 4);
+    memcpy(row + 16, &cents, 8);
+    memcpy(row + 24, &balanceCents, 8);
+    pendingRows.insert(pendingRows.end(), row, row + columnRowSize);
+}
+
+/**\brief Trägt eine Zeile aus einer bereits geschriebenen Logdatei ein (Neuaufbau)
+ * Der Zeitpunkt wird aus dem Zeitstempel der Zeile bestimmt (siehe LogArchive::parseStamp; bei älteren Zeilen ohne Jahr zählt das Jahr des Monats, in dem die Logdatei geschrieben wurde).
+ * \param month (JJJJMM der Logdatei bzw. des Segments), line
+ */
+void ColumnStore::addLogLine(int month, const string &line) {
+    long long stamp = LogArchive::parseStamp(line, month, false);
+    if (stamp < 0) {
+        return;
+    }
+    int day = stamp / 1000000;
+    int clock = stamp % 1000000;
+    long long time;
+    {
+        lock_guard<mutex> lock(storeMutex);
+        map<int, long long>::iterator it = midnights.find(day);
+        if (it == midnights.end()) {
+            it = midnights.insert(make_pair(day, dayStart(day / 10000, day / 100 % 100, day % 100))).first;
+        }
+        time = it->second + (clock / 10000) * 3600 + (clock / 100 % 100) * 60 + clock % 100;
+    }
+    add(time, line);
+}
+
+/**\brief Hängt alle neuen Getränke an das Wörterbuch und alle neuen Zeilen an die Spaltendatei an und vermerkt, bis wohin transactionlog.txt damit abgedeckt ist
+ * Das Wörterbuch wird zuerst geschrieben, damit jede gespeicherte Zeile ein bekanntes Getränk hat; die Positionsdatei zuletzt, damit sie nie Zeilen abdeckt, die noch fehlen.
+ * \param month (JJJJMM der aktiven Logdatei), logSize (Größe von transactionlog.txt mit allen eingetragenen Zeilen; negativ, wenn unbekannt: dann wird die Positionsdatei gelöscht und der Spaltenspeicher beim nächsten Start neu aufgebaut)
+ * \return bool (false, wenn eine der Dateien nicht geschrieben werden konnte)
+ */
+bool ColumnStore::commit(int month, long long logSize) {
+    lock_guard<mutex> lock(storeMutex);
+    unsigned long long rowsBefore = storedRows;
+    if (!pendingNames.empty()) {
+        ofstream dictionary;
+        dictionary.open(dictionaryPath, ios::out | ios::app);
+        if (!dictionary.is_open()) {
+            return false;
+        }
+        for (int i=0; i < pendingNames.size(); i++) {
+            dictionary << pendingNames[i] << "\n";
+        }
+        dictionary.close();
+        if (!dictionary) {
+            remove(positionPath.c_str()); // Teil der Namen ist evtl. geschrieben, die Codes stimmen nicht mehr
+            return false;
+        }
+        pendingNames.clear();
+    }
+    if (!pendingRows.empty()) {
+        ofstream columns;
+        columns.open(path, ios::out | ios::app | ios::binary);
+        if (!columns.is_open()) {
+            return false;
+        }
+        columns.write(pendingRows.data(), pendingRows.size());
+        columns.close();
+        if (!columns) {
+            remove(positionPath.c_str()); // Teil der Zeilen ist evtl. geschrieben, die Zeilenzahl stimmt nicht mehr
+            return false;
+        }
+        storedRows += pendingRows.size() / columnRowSize;
+        pendingRows.clear();
+    }
+    if (logSize < 0) {
+        remove(positionPath.c_str());
+        return false;
+    }
+    if (month == coveredMonth && (unsigned long long) logSize == coveredSize && storedRows == rowsBefore) {
+        return true;
+    }
+    coveredMonth = month;
+    coveredSize = logSize;
+    ofstream position;
+    position.open(positionPath, ios::out | ios::trunc);
+    if (!position.is_open()) {
+        return false;
+    }
+    position << coveredMonth << " " << coveredSize << " " << storedRows << "\n";
+    position.close();
+    return !position.fail();
+}
+
+/**\brief Gibt den Monat der aktiven Logdatei zurück, auf den sich getCoveredSize() bezieht
+ * \return int (JJJJMM; 0, wenn nicht geladen)
+ */
+int ColumnStore::getCoveredMonth() const {
+    lock_guard<mutex> lock(storeMutex);
+    return coveredMonth;
+}
+
+/**\brief Gibt zurück, bis zu welcher Byte-Position transactionlog.txt eingetragen ist
+ */
+unsigned long long ColumnStore::getCoveredSize() const {
+    lock_guard<mutex> lock(storeMutex);
+    return coveredSize;
+}
+
+/**\brief Gibt die Anzahl aller gespeicherten Buchungen zurück
+ */
+unsigned long long ColumnStore::getRowCount() const {
+    lock_guard<mutex> lock(storeMutex);
+    unsigned long long rows = 0;
+    for (size_t i=0; i < chunks.size(); i++) {
+        rows += chunks[i].count;
+    }
+    return rows;
+}
+
+/**\brief Wertet alle Buchungen eines Zeitraums aus: Umsatz pro Tag, meistverkaufte Getränke und Nutzer mit den höchsten Käufen
+ * Blöcke, die laut Min/Max nicht im Zeitraum liegen, werden übersprungen. In den übrigen werden die Spalten in einfachen Schleifen ohne Verzweigungen summiert;
+ * liegt ein Block ganz im Zeitraum, entfällt auch der Vergleich der Zeitpunkte.
+ * \param from, to (Unixzeit, von einschließlich bis ausschließlich), count (Länge der Ranglisten)
+ * \return ColumnReport
+ */
+ColumnReport ColumnStore::analyze(long long from, long long to, int count) const {
+    ColumnReport report;
+    report.rows = 0;
+    report.scannedChunks = 0;
+    report.skippedChunks = 0;
+    lock_guard<mutex> lock(storeMutex);
+    // Zeitraum auf die vorhandenen Buchungen begrenzen, damit nicht für jeden Tag eines offenen Zeitraums eine Grenze berechnet wird
+    long long firstTime = to;
+    long long lastTime = from;
+    for (size_t c=0; c < chunks.size(); c++) {
+        firstTime = min(firstTime, (long long) chunks[c].minTime);
+        lastTime = max(lastTime, (long long) chunks[c].maxTime + 1);
+    }
+    from = max(from, firstTime);
+    to = min(to, lastTime);
+    // Tagesgrenzen (Ortszeit) im Zeitraum: Tag i geht von bounds[i] bis bounds[i+1]
+    vector<long long> bounds;
+    vector<int> days;
+    for (long long start = from; start < to; ) {
+        int day = dayOf(start);
+        bounds.push_back(start);
+        days.push_back(day);
+        start = max(start + 1, dayStart(day / 10000, day / 100 % 100, day % 100 + 1));
+    }
+    bounds.push_back(to);
+    vector<int64_t> dayRevenue(days.size(), 0);
+    int64_t deposited = 0;
+    vector<long long> bottles(names.size(), 0);
+    vector<int64_t> spend;
+    for (size_t c=0; c < chunks.size(); c++) {
+        const Chunk &chunk = chunks[c];
+        if (days.empty() || chunk.maxTime < from || chunk.minTime >= to) {
+            report.skippedChunks++;
+            continue;
+        }
+        report.scannedChunks++;
+        const int64_t *times = chunk.times;
+        const int64_t *amounts = chunk.amounts;
+        const int32_t *beverages = chunk.beverages;
+        const int32_t *users = chunk.users;
+        int rows = chunk.count;
+        // Umsatz und Einzahlungen pro Tag, der den Block überschneidet
+        int first = upper_bound(bounds.begin(), bounds.end(), (long long) chunk.minTime) - bounds.begin() - 1;
+        for (int d = max(first, 0); d < days.size() && bounds[d] <= chunk.maxTime; d++) {
+            int64_t lo = bounds[d];
+            int64_t hi = bounds[d+1];
+            int64_t sales = 0;
+            int64_t deposits = 0;
+            long long matches = 0;
+            for (int i=0; i < rows; i++) {
+                int64_t inside = (times[i] >= lo) & (times[i] < hi);
+                int64_t amount = amounts[i];
+                sales += inside * (amount < 0 ? -amount : 0);
+                deposits += inside * (amount > 0 ? amount : 0);
+                matches += inside;
+            }
+            dayRevenue[d] += sales;
+            deposited += deposits;
+            report.rows += matches;
+        }
+        // Getränke und Nutzer (nur Käufe)
+        if (spend.size() <= (size_t) chunk.maxUser) {
+            spend.resize(chunk.maxUser + 1, 0);
+        }
+        bool whole = chunk.minTime >= from && chunk.maxTime < to;
+        for (int i=0; i < rows; i++) {
+            if ((whole || (times[i] >= from && times[i] < to)) && amounts[i] < 0 && beverages[i] >= 0) {
+                bottles[beverages[i]]++;
+                spend[users[i]] -= amounts[i];
+            }
+        }
+    }
+
+    for (size_t d=0; d < days.size(); d++) {
+        if (dayRevenue[d] > 0) {
+            report.revenuePerDay.push_back(make_pair(days[d], Money::fromCents(dayRevenue[d])));
+            report.revenue += Money::fromCents(dayRevenue[d]);
+        }
+    }
+    report.deposited = Money::fromCents(deposited);
+    vector<pair<string, long long> > fBottles;
+    for (size_t i=0; i < bottles.size(); i++) {
+        if (bottles[i] > 0) {
+            fBottles.push_back(make_pair(names[i], bottles[i]));
+        }
+    }
+    vector<pair<int, long long> > fSpend;
+    for (size_t i=0; i < spend.size(); i++) {
+        if (spend[i] > 0) {
+            fSpend.push_back(make_pair((int) i, (long long) spend[i]));
+        }
+    }
+    sort(fBottles.begin(), fBottles.end(), largerFirst<string>);
+    sort(fSpend.begin(), fSpend.end(), largerFirst<int>);
+    fBottles.resize(min(fBottles.size(), (size_t) max(count, 0)));
+    fSpend.resize(min(fSpend.size(), (size_t) max(count, 0)));
+    report.bottlesPerBeverage = fBottles;
+    for (size_t i=0; i < fSpend.size(); i++) {
+        report.spendPerUser.push_back(make_pair(fSpend[i].first, Money::fromCents(fSpend[i].second)));
+    }
+    return report;
+}
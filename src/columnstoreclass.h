@@ -0,0 +1,76 @@
+#include "includes.h"
+#include <cstdint>
+
+/**\brief Ergebnis einer Auswertung von transactionlog.txt über einen Zeitraum (siehe ColumnStore::analyze)
+ */
+struct ColumnReport {
+    vector<pair<int, Money> > revenuePerDay; // JJJJMMTT -> Umsatz (nur Tage mit Verkäufen, aufsteigend)
+    vector<pair<string, long long> > bottlesPerBeverage; // Getränk -> verkaufte Flaschen (meiste zuerst)
+    vector<pair<int, Money> > spendPerUser; // NutzerID -> Summe der Käufe (höchste zuerst)
+    Money revenue; // Umsatz im ganzen Zeitraum
+    Money deposited; // Einzahlungen im ganzen Zeitraum
+    unsigned long long rows; // Buchungen im Zeitraum
+    int scannedChunks; // durchsuchte Blöcke
+    int skippedChunks; // anhand von Min/Max übersprungene Blöcke
+};
+
+/**\brief Klasse "ColumnStoreclass" für schnelle Auswertungen über alle Buchungen aus transactionlog.txt (inklusive der versiegelten Monate)
+ * Jede Zeile wird beim Schreiben zusätzlich zerlegt und spaltenweise abgelegt: Zeitpunkt, NutzerID, Getränk, Betrag (Cent, negativ bei Käufen) und Guthaben danach.
+ * Die Spalten liegen in Blöcken zu je chunkRows Zeilen als einfache Arrays; zu jedem Block werden Min/Max von Zeitpunkt und NutzerID mitgeführt,
+ * sodass eine Auswertung ganze Blöcke außerhalb des Zeitraums überspringt und in den übrigen nur enge Schleifen über die Arrays laufen (ohne Strings, vom Compiler vektorisierbar).
+ * Getränke werden als Code eines Wörterbuchs gespeichert (-1 bei Einzahlungen), damit Umbenennen oder Löschen eines Getränks die Historie nicht verändert.
+ * Gesichert wird in zwei Dateien, an die nur angehängt wird (wie beim LogIndex), und einer kleinen Positionsdatei:
+ *      "transactions.col"   pro Zeile 32 Byte: Zeitpunkt (int64, Unixzeit), NutzerID (int32), Getränk (int32), Betrag (int64), Guthaben (int64)
+ *      "transactions.dict"  ein Getränkename pro Zeile, die Zeilennummer ist der Code
+ *      "transactions.pos"   "<Monat der aktiven Logdatei (JJJJMM)> <abgedeckte Größe von transactionlog.txt> <Anzahl der Zeilen in transactions.col>"
+ * Die Positionsdatei wird nach jedem Anhängen neu geschrieben. Beim Laden wird die Spaltendatei auf die dort vermerkte Zeilenzahl gekürzt (unvollständige oder nicht abgedeckte Zeilen nach einem Absturz),
+ * danach trägt die Persistenz die Zeilen von transactionlog.txt ab der abgedeckten Größe nach.
+ * Fehlt eine der Dateien oder passt sie nicht zur Logdatei, baut die Persistenz den Spaltenspeicher beim Start aus allen Segmenten und der aktiven Logdatei neu auf.
+ */
+class ColumnStore {
+private:
+    static const int chunkRows = 4096;
+    struct Chunk {
+        int count;
+        int64_t minTime;
+        int64_t maxTime;
+        int32_t minUser;
+        int32_t maxUser;
+        int64_t times[chunkRows];
+        int32_t users[chunkRows];
+        int32_t beverages[chunkRows];
+        int64_t amounts[chunkRows];
+        int64_t balances[chunkRows];
+        Chunk() { count = 0; }
+    };
+    string path;
+    string dictionaryPath;
+    string positionPath;
+    deque<Chunk> chunks;
+    vector<string> names; // Wörterbuch der Getränke (Code = Position)
+    HashIndex<string> codes; // Getränkename -> Code
+    vector<char> pendingRows; // neue Zeilen, die noch an die Spaltendatei angehängt werden müssen
+    vector<string> pendingNames; // neue Getränke, die noch an das Wörterbuch angehängt werden müssen
+    map<int, long long> midnights; // JJJJMMTT -> Unixzeit von Mitternacht (beim Einlesen der Logs)
+    int coveredMonth; // Monat der aktiven Logdatei, auf die sich coveredSize bezieht
+    unsigned long long coveredSize; // bis zu dieser Byte-Position ist transactionlog.txt eingetragen
+    unsigned long long storedRows; // Zeilen in der Spaltendatei
+    mutable mutex storeMutex;
+    void addRow(int64_t time, int32_t userID, int32_t beverage, int64_t amount, int64_t balance);
+    int32_t codeOf(const string &name);
+public:
+    ColumnStore();
+    void setPaths(string nPath, string nDictionaryPath, string nPositionPath);
+    static bool parseLine(const string &line, int &userID, string &beverage, Money &amount, Money &balance);
+    static long long dayStart(int year, int month, int day);
+    static int dayOf(long long time);
+    bool load();
+    bool clear();
+    void add(long long time, const string &line);
+    void addLogLine(int month, const string &line);
+    bool commit(int month, long long logSize);
+    int getCoveredMonth() const;
+    unsigned long long getCoveredSize() const;
+    unsigned long long getRowCount() const;
+    ColumnReport analyze(long long from, long long to, int count) const;
+};
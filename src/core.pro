@@ -0,0 +1,55 @@
+#-------------------------------------------------
+#
+# Bibliothek poscore: die Getränkekasse ohne Oberfläche (PosEngine, Persistenz, Nutzer, Getränke, System)
+# wird von der GUI (gui.pro) und dem Kommandozeilenprogramm (cli.pro) gelinkt
+#
+#-------------------------------------------------
+
+TARGET = poscore
+TEMPLATE = lib
+CONFIG += staticlib c++11
+CONFIG -= qt
+OBJECTS_DIR = .obj/core
+
+SOURCES += \
+        auditclass.cpp \
+        beverageclass.cpp \
+        columnstoreclass.cpp \
+        journalclass.cpp \
+        latencystatsclass.cpp \
+        logarchiveclass.cpp \
+        logindexclass.cpp \
+        logviewclass.cpp \
+        logwriterclass.cpp \
+        moneyclass.cpp \
+        persistenceclass.cpp \
+        posengineclass.cpp \
+        prefixindexclass.cpp \
+        scratchdirectoryclass.cpp \
+        segmentclass.cpp \
+        snapshotclass.cpp \
+        userclass.cpp \
+        systemclass.cpp
+
+HEADERS += \
+        auditclass.h \
+        beverageclass.h \
+        columnstoreclass.h \
+        hashindexclass.h \
+        headers.h \
+        includes.h \
+        journalclass.h \
+        latencystatsclass.h \
+        logarchiveclass.h \
+        logindexclass.h \
+        logviewclass.h \
+        logwriterclass.h \
+        moneyclass.h \
+        persistenceclass.h \
+        posengineclass.h \
+        prefixindexclass.h \
+        scratchdirectoryclass.h \
+        segmentclass.h \
+        snapshotclass.h \
+        userclass.h \
+        systemclass.h
@@ -0,0 +1,54 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2019-06-02T20:05:58
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = src
+TEMPLATE = app
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which has been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can also make your code fail to compile if you use deprecated APIs.
+# In order to do so, uncomment the following line.
+# You can also select to disable deprecated APIs only up to a certain version of Qt.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+CONFIG += c++11
+
+# Oberfläche über der Bibliothek poscore (siehe core.pro); zlib für die komprimierten Logsegmente
+LIBS += -L$$OUT_PWD -lposcore -lz
+PRE_TARGETDEPS += $$OUT_PWD/libposcore.a
+OBJECTS_DIR = .obj/gui
+
+SOURCES += \
+        logmodelclass.cpp \
+        main.cpp \
+        usermodelclass.cpp \
+        userwindow.cpp
+
+HEADERS += \
+        logmodelclass.h \
+        usermodelclass.h \
+        userwindow.h
+
+FORMS += \
+        userwindow.ui
+
+DESTDIR = ../currentrelease
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+RESOURCES += \
+        res.qrc
@@ -0,0 +1,152 @@
+#include "includes.h"
+#include <functional>
+
+/**\brief Klasse "HashIndexclass" für das Nachschlagen von Nutzern und Getränken über einen Schlüssel (Name, Barcode)
+ * Ordnet jedem Schlüssel die Position (Slot) des Objekts im Vektor users bzw. beverages zu.
+ * Offene Adressierung mit linearem Sondieren: alle Einträge liegen in einem einzigen Array, dessen Größe eine Zweierpotenz ist.
+ * Gelöschte Einträge werden als Grabstein markiert, damit Sondierungsketten nicht abreißen; ab 70% Füllung (inkl. Grabsteine) wird neu aufgebaut.
+ * Nachschlagen, Einfügen und Löschen kosten also unabhängig von der Anzahl der Nutzer bzw. Getränke im Mittel konstant viel.
+ * Als Template nur im Header, damit derselbe Code für Namen (string) und Barcodes (long long) verwendet werden kann.
+ */
+template <typename Key>
+class HashIndex {
+private:
+    enum State { Empty, Used, Deleted };
+    struct Bucket {
+        Key key;
+        int slot;
+        char state;
+    };
+    vector<Bucket> buckets;
+    int used; // belegte Einträge
+    int deleted; // Grabsteine
+
+    /**\brief Sucht den Eintrag eines Schlüssels
+     * \return int (Position im Array, -1 wenn der Schlüssel fehlt)
+     */
+    int locate(const Key &key) const {
+        if (buckets.empty()) {
+            return -1;
+        }
+        size_t mask = buckets.size() - 1;
+        for (size_t pos = std::hash<Key>()(key) & mask; ; pos = (pos + 1) & mask) {
+            if (buckets[pos].state == Empty) {
+                return -1;
+            }
+            if (buckets[pos].state == Used && buckets[pos].key == key) {
+                return pos;
+            }
+        }
+    }
+
+    /**\brief Baut das Array mit neuer Größe auf und entfernt dabei alle Grabsteine
+     * \param capacity (Zweierpotenz)
+     */
+    void rehash(size_t capacity) {
+        vector<Bucket> fBuckets(capacity);
+        for (size_t i=0; i < fBuckets.size(); i++) {
+            fBuckets[i].state = Empty;
+        }
+        fBuckets.swap(buckets);
+        used = 0;
+        deleted = 0;
+        for (size_t i=0; i < fBuckets.size(); i++) {
+            if (fBuckets[i].state == Used) {
+                insert(fBuckets[i].key, fBuckets[i].slot);
+            }
+        }
+    }
+
+public:
+    HashIndex() {
+        used = 0;
+        deleted = 0;
+    }
+
+    /**\brief Leert den Index
+     */
+    void clear() {
+        buckets.clear();
+        used = 0;
+        deleted = 0;
+    }
+
+    /**\brief Trägt einen Schlüssel ein
+     * \param key, slot (Position im Vektor)
+     * \return bool (false, wenn der Schlüssel bereits vergeben ist; der Index bleibt dann unverändert)
+     */
+    bool insert(const Key &key, int slot) {
+        if ((used + deleted + 1) * 10 > (int) buckets.size() * 7) {
+            size_t capacity = 16;
+            while ((size_t) (used + 1) * 10 > capacity * 5) { // nach dem Neuaufbau höchstens halb voll
+                capacity *= 2;
+            }
+            rehash(capacity);
+        }
+        size_t mask = buckets.size() - 1;
+        int tombstone = -1;
+        for (size_t pos = std::hash<Key>()(key) & mask; ; pos = (pos + 1) & mask) {
+            if (buckets[pos].state == Empty) {
+                if (tombstone >= 0) { // Grabstein auf der Sondierungskette wiederverwenden
+                    pos = tombstone;
+                    deleted--;
+                }
+                buckets[pos].key = key;
+                buckets[pos].slot = slot;
+                buckets[pos].state = Used;
+                used++;
+                return true;
+            }
+            if (buckets[pos].state == Deleted) {
+                if (tombstone < 0) {
+                    tombstone = pos;
+                }
+            }
+            else if (buckets[pos].key == key) {
+                return false;
+            }
+        }
+    }
+
+    /**\brief Sucht die Position zu einem Schlüssel
+     * \return int (Position im Vektor, -1 wenn der Schlüssel fehlt)
+     */
+    int find(const Key &key) const {
+        int pos = locate(key);
+        return pos < 0 ? -1 : buckets[pos].slot;
+    }
+
+    /**\brief Entfernt einen Schlüssel
+     * \return bool (false, wenn der Schlüssel fehlt)
+     */
+    bool erase(const Key &key) {
+        int pos = locate(key);
+        if (pos < 0) {
+            return false;
+        }
+        buckets[pos].key = Key();
+        buckets[pos].state = Deleted;
+        used--;
+        deleted++;
+        return true;
+    }
+
+    /**\brief Passt die Positionen an, nachdem ein Objekt aus dem Vektor gelöscht wurde (alle folgenden rücken eins nach vorne)
+     * Der Schlüssel des gelöschten Objekts muss vorher mit erase() entfernt worden sein.
+     * \param slot (Position des gelöschten Objekts)
+     */
+    void removeSlot(int slot) {
+        for (size_t i=0; i < buckets.size(); i++) {
+            if (buckets[i].state == Used && buckets[i].slot > slot) {
+                buckets[i].slot--;
+            }
+        }
+    }
+
+    /**\brief Gibt die Anzahl der eingetragenen Schlüssel zurück
+     * \return int
+     */
+    int size() const {
+        return used;
+    }
+};
@@ -1,4 +1,20 @@
 // Lokale includes
+#include "moneyclass.h"
 #include "userclass.h"
 #include "beverageclass.h"
 #include "systemclass.h"
+#include "hashindexclass.h"
+#include "prefixindexclass.h"
+#include "logwriterclass.h"
+#include "journalclass.h"
+#include "snapshotclass.h"
+#include "segmentclass.h"
+#include "logindexclass.h"
+#include "logarchiveclass.h"
+#include "logviewclass.h"
+#include "columnstoreclass.h"
+#include "auditclass.h"
+#include "persistenceclass.h"
+#include "latencystatsclass.h"
+#include "scratchdirectoryclass.h"
+#include "posengineclass.h"
@@ -3,5 +3,10 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
@@ -0,0 +1,340 @@
+#include "includes.h"
+#include "headers.h"
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+/**\brief Zerlegt eine Journalzeile anhand der Semikolons in ihre Felder
+ * \param line (eine Zeile aus dem Journal)
+ * \return vector<string> (die einzelnen Felder; leer, wenn die Zeile leere Felder enthält, z.B. weil sie bei einem Absturz nur halb geschrieben wurde)
+ */
+static vector<string> splitRecord(string line) {
+    vector<string> fields;
+    size_t start = 0;
+    size_t pos = line.find(";");
+    while (pos != string::npos) {
+        fields.push_back(line.substr(start, pos-start));
+        start = pos+1;
+        pos = line.find(";", start);
+    }
+    fields.push_back(line.substr(start));
+    for (int i=0; i < fields.size(); i++) {
+        if (fields[i].empty()) {
+            fields.clear();
+            break;
+        }
+    }
+    return fields;
+}
+
+/**\brief Konstruktor für Journal-Objekte
+ * Standardmäßig wird das Journal neben die Datenbanken in "journal.txt" geschrieben.
+ */
+Journal::Journal() {
+    setPath("journal.txt");
+}
+
+/**\brief Setzt den Pfad des aktiven Journals
+ * \param nPath (Pfad des Journals)
+ */
+void Journal::setPath(string nPath) {
+    path = nPath;
+    writer.setPath(nPath);
+    records = 0;
+    current = false;
+}
+
+/**\brief Erzeugt den Eintrag für einen Verkauf (neues Guthaben des Nutzers, neuer Bestand des Getränks und die neuen Summen von Nutzer, Getränk und Tag)
+ * \param userID, user, beverageID, beverage (jeweils schon mit dem neuen Stand), day (JJJJMMTT), totals (neue Umsätze des Tages)
+ * \return string (Journalzeile ohne Zeilenumbruch)
+ */
+string Journal::saleRecord(int userID, const User &user, int beverageID, const Beverage &beverage, int day, const DayTotals &totals) {
+    ostringstream line;
+    line << "S;" << userID << ";" << user.getBalance() << ";" << beverageID << ";" << beverage.getStock() << ";" << day
+         << ";" << user.getConsumed() << ";" << user.getSpent() << ";" << beverage.getSold() << ";" << beverage.getRevenue()
+         << ";" << totals.sales << ";" << totals.revenue;
+    return line.str();
+}
+
+/**\brief Erzeugt den Eintrag für eine Einzahlung (neues Guthaben des Nutzers, neuer Kassenstand und die neuen Summen von Nutzer und Tag)
+ * \param userID, user (schon mit dem neuen Stand), vBalance, day (JJJJMMTT), totals (neue Umsätze des Tages)
+ * \return string (Journalzeile ohne Zeilenumbruch)
+ */
+string Journal::depositRecord(int userID, const User &user, Money vBalance, int day, const DayTotals &totals) {
+    ostringstream line;
+    line << "D;" << userID << ";" << user.getBalance() << ";" << vBalance << ";" << day
+         << ";" << user.getDeposited() << ";" << totals.deposits << ";" << totals.deposited;
+    return line.str();
+}
+
+/**\brief Erzeugt den Eintrag für eine Nachbestellung (abvro)
+ * \return string (Journalzeile ohne Zeilenumbruch)
+ */
+string Journal::restockRecord(int beverageID, int stock, int lastOrder) {
+    ostringstream line;
+    line << "R;" << beverageID << ";" << stock << ";" << lastOrder;
+    return line.str();
+}
+
+/**\brief Erzeugt den Eintrag für eine Preisänderung (setbvrprice)
+ * \return string (Journalzeile ohne Zeilenumbruch)
+ */
+string Journal::priceRecord(int beverageID, Money price) {
+    ostringstream line;
+    line << "P;" << beverageID << ";" << price;
+    return line.str();
+}
+
+/**\brief Erzeugt den Eintrag für einen neuen Kassenstand (withdraw)
+ * \return string (Journalzeile ohne Zeilenumbruch)
+ */
+string Journal::vBalanceRecord(Money vBalance) {
+    ostringstream line;
+    line << "V;" << vBalance;
+    return line.str();
+}
+
+/**\brief Liest eine ganze Zahl aus einem Feld; das ganze Feld muss aus der Zahl bestehen
+ * \param field, value (wird nur bei Erfolg gesetzt)
+ * \return bool (false, wenn das Feld keine gültige Zahl ist, z.B. weil die Zeile nur halb geschrieben wurde)
+ */
+static bool parseField(const string &field, int &value) {
+    char *end = nullptr;
+    errno = 0;
+    long parsed = strtol(field.c_str(), &end, 10);
+    if (field.empty() || *end != '\0' || errno != 0 || parsed < INT_MIN || parsed > INT_MAX) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+/**\brief Wendet einen einzelnen Journaleintrag auf die übergebenen Objekte an
+ * Unvollständige oder unbekannte Zeilen (z.B. nach einem Stromausfall) werden übersprungen; es wird erst etwas verändert, wenn alle Felder gültig sind.
+ * \return bool (true, wenn der Eintrag angewendet wurde)
+ */
+bool Journal::apply(string line, vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    vector<string> f = splitRecord(line);
+    if (f.empty()) {
+        return false;
+    }
+    Money amount;
+    if (f[0] == "S" && (f.size() == 5 || f.size() == 12) && Money::parse(f[2], amount)) {
+        int userID;
+        int beverageID;
+        int stock;
+        if (!parseField(f[1], userID) || !parseField(f[3], beverageID) || !parseField(f[4], stock)
+                || userID < 0 || userID >= fUsers.size() || beverageID < 0 || beverageID >= fBeverages.size()) {
+            return false;
+        }
+        int day;
+        int consumed;
+        int sold;
+        Money spent;
+        Money revenue;
+        DayTotals totals;
+        bool withTotals = f.size() == 12;
+        if (withTotals && !(parseField(f[5], day) && parseField(f[6], consumed) && Money::parse(f[7], spent) && parseField(f[8], sold)
+                            && Money::parse(f[9], revenue) && parseField(f[10], totals.sales) && Money::parse(f[11], totals.revenue))) {
+            return false;
+        }
+        fUsers[userID].setBalance(fUsers[userID].getBalance() - amount); // setBalance zieht ab, also Differenz zum neuen Guthaben übergeben
+        fBeverages[beverageID].setStock(stock);
+        if (withTotals) {
+            fUsers[userID].setTotals(consumed, spent, fUsers[userID].getDeposited());
+            fBeverages[beverageID].setSales(sold, revenue);
+            DayTotals previous = fSystem.getDayTotals(day);
+            totals.deposits = previous.deposits;
+            totals.deposited = previous.deposited;
+            fSystem.setDayTotals(day, totals);
+        }
+        return true;
+    }
+    else if (f[0] == "D" && (f.size() == 4 || f.size() == 8) && Money::parse(f[2], amount)) {
+        int userID;
+        Money vBalance;
+        if (!parseField(f[1], userID) || userID < 0 || userID >= fUsers.size() || !Money::parse(f[3], vBalance)) {
+            return false;
+        }
+        int day;
+        Money deposited;
+        DayTotals totals;
+        bool withTotals = f.size() == 8;
+        if (withTotals && !(parseField(f[4], day) && Money::parse(f[5], deposited) && parseField(f[6], totals.deposits) && Money::parse(f[7], totals.deposited))) {
+            return false;
+        }
+        fUsers[userID].setBalance(fUsers[userID].getBalance() - amount);
+        fSystem.setvBalance(vBalance);
+        if (withTotals) {
+            fUsers[userID].setTotals(fUsers[userID].getConsumed(), fUsers[userID].getSpent(), deposited);
+            DayTotals previous = fSystem.getDayTotals(day);
+            totals.sales = previous.sales;
+            totals.revenue = previous.revenue;
+            fSystem.setDayTotals(day, totals);
+        }
+        return true;
+    }
+    else if (f[0] == "R" && f.size() == 4) {
+        int beverageID;
+        int stock;
+        int lastOrder;
+        if (parseField(f[1], beverageID) && parseField(f[2], stock) && parseField(f[3], lastOrder) && beverageID >= 0 && beverageID < fBeverages.size()) {
+            fBeverages[beverageID].setStock(stock);
+            fBeverages[beverageID].setLastOrder(lastOrder);
+            return true;
+        }
+    }
+    else if (f[0] == "P" && f.size() == 3 && Money::parse(f[2], amount)) {
+        int beverageID;
+        if (parseField(f[1], beverageID) && beverageID >= 0 && beverageID < fBeverages.size()) {
+            fBeverages[beverageID].editPrice(amount);
+            return true;
+        }
+    }
+    else if (f[0] == "V" && f.size() == 2 && Money::parse(f[1], amount)) {
+        fSystem.setvBalance(amount);
+        return true;
+    }
+    return false;
+}
+
+/**\brief Sammelt einen Eintrag für das aktive Journal; geschrieben wird er erst mit commit()
+ * \param line (fertig formatierter Eintrag ohne Zeilenumbruch)
+ */
+void Journal::append(string line) {
+    writer.add(line);
+    records++;
+}
+
+/**\brief Sammelt mehrere Einträge, die nur gemeinsam gelten (z.B. alle Verkäufe eines Warenkorbs)
+ * Vor die Einträge wird "B;<Anzahl>" geschrieben. Der ganze Stapel wird als ein Block an den LogWriter übergeben, landet also mit einem write() (und höchstens einem fsync) im Journal.
+ * Fehlt nach einem Absturz auch nur ein Teil des Stapels, wird er beim Einlesen komplett verworfen (siehe replay()).
+ * \param lines (fertig formatierte Einträge ohne Zeilenumbruch)
+ */
+void Journal::appendBatch(const vector<string> &lines) {
+    if (lines.size() == 1) {
+        append(lines[0]);
+        return;
+    }
+    if (lines.empty()) {
+        return;
+    }
+    string block = "B;" + to_string(lines.size());
+    for (int i=0; i < lines.size(); i++) {
+        block += "\n";
+        block += lines[i];
+    }
+    writer.add(block);
+    records += lines.size();
+}
+
+/**\brief Hängt alle gesammelten Einträge gemeinsam an das aktive Journal an
+ * \return bool (false, wenn das Journal nicht geschrieben werden konnte)
+ */
+bool Journal::commit() {
+    return writer.commit();
+}
+
+/**\brief Setzt die Durability des Journals (siehe LogWriter::setDurability)
+ */
+void Journal::setDurability(int nDurability) {
+    writer.setDurability(nDurability);
+}
+
+/**\brief Gibt die Schreibstatistik des Journals zurück
+ * \return LogWriterStats
+ */
+LogWriterStats Journal::getStats() {
+    return writer.getStats();
+}
+
+/**\brief Setzt die Schreibstatistik des Journals zurück
+ */
+void Journal::resetStats() {
+    writer.resetStats();
+}
+
+/**\brief Wendet alle Einträge des aktiven Journals auf die übergebenen Objekte an
+ * Das Journal wird nur angewendet, wenn seine Kopfzeile zur Generation des gelesenen Snapshots passt (ohne Kopfzeile: Generation 0).
+ * Ein Stapel (B;<Anzahl>) wird nur angewendet, wenn alle seine Einträge vollständig (inkl. Zeilenumbruch) im Journal stehen; dasselbe gilt für den letzten einzelnen Eintrag.
+ * \param generation (Generation des gelesenen Snapshots)
+ * \return int (Anzahl der angewendeten Einträge)
+ */
+int Journal::replay(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem, unsigned int generation) {
+    records = 0;
+    current = false;
+    ifstream journal;
+    journal.open(path);
+    if (journal.is_open()) {
+        string line;
+        bool first = true;
+        while (getline(journal, line)) {
+            vector<string> f = splitRecord(line);
+            if (first) {
+                first = false;
+                unsigned int fileGeneration = 0;
+                bool header = f.size() == 2 && f[0] == "G" && !journal.eof();
+                if (header) {
+                    fileGeneration = strtoul(f[1].c_str(), nullptr, 10);
+                }
+                current = fileGeneration == generation;
+                if (!current) { // Journal eines anderen Snapshots: seine IDs passen nicht mehr
+                    break;
+                }
+                if (header) {
+                    continue;
+                }
+            }
+            if (f.size() == 2 && f[0] == "B") {
+                int count = 0;
+                parseField(f[1], count);
+                vector<string> fLines;
+                while (fLines.size() < count && getline(journal, line)) {
+                    fLines.push_back(line);
+                }
+                if (count > 0 && fLines.size() == count && !journal.eof()) { // eof: letzte Zeile ohne Zeilenumbruch, also nur halb geschrieben
+                    for (int i=0; i < fLines.size(); i++) {
+                        if (apply(fLines[i], fUsers, fBeverages, fSystem)) {
+                            records++;
+                        }
+                    }
+                }
+            }
+            else if (!journal.eof() && apply(line, fUsers, fBeverages, fSystem)) { // eof: letzte Zeile ohne Zeilenumbruch, also nur halb geschrieben
+                records++;
+            }
+        }
+    }
+    journal.close();
+    return records;
+}
+
+/**\brief Gibt zurück, ob das Journal laut Kopfzeile zum gelesenen Snapshot gehört (siehe replay)
+ * \return bool (false bei einem leeren oder fremden Journal; es muss vor dem ersten neuen Eintrag mit clear() geleert werden, damit es die Kopfzeile bekommt)
+ */
+bool Journal::isCurrent() {
+    return current;
+}
+
+/**\brief Leert das Journal (inklusive der noch nicht geschriebenen Einträge) und beginnt es mit der Kopfzeile der übergebenen Generation
+ * Die Kopfzeile wird mit dem nächsten commit() geschrieben, also immer vor dem ersten neuen Eintrag.
+ * \param generation (Generation des gerade geschriebenen Snapshots)
+ * \return bool (false, wenn die Datei nicht geleert werden konnte; ihre Einträge würden beim nächsten Start erneut angewendet)
+ * \warning Darf nur aufgerufen werden, direkt nachdem ein vollständiger Snapshot geschrieben wurde!
+ */
+bool Journal::clear(unsigned int generation) {
+    records = 0;
+    current = true;
+    bool cleared = writer.reset();
+    writer.add("G;" + to_string(generation));
+    return cleared;
+}
+
+/**\brief Gibt die Anzahl der Einträge im aktiven Journal zurück
+ * \return records (als int)
+ */
+int Journal::getRecordCount() {
+    return records;
+}
@@ -0,0 +1,46 @@
+#include "includes.h"
+
+/**\brief Klasse "Journalclass" für das Protokollieren von kleinen Änderungen (Deltas)
+ * Anstatt bei jedem Verkauf die komplette Nutzer- und Getränkedatenbank neu zu schreiben, wird nur ein kurzer Eintrag an das Journal angehängt.
+ * Jeder Eintrag enthält die absoluten neuen Werte (z.B. neues Guthaben, neuer Bestand); Beträge stehen mit zwei Nachkommastellen darin (siehe Money). Ein Eintrag kann also beliebig oft wiederholt werden, ohne dass sich das Ergebnis ändert.
+ * Beim Programmstart wird zuerst der Snapshot gelesen und danach das Journal darauf angewendet.
+ * Die Einträge beziehen sich auf die Positionen der Nutzer und Getränke im Snapshot. Die erste Zeile enthält deshalb dessen Generation (siehe Snapshot::getGeneration);
+ * passt sie nicht (z.B. Absturz zwischen neuem Snapshot mit verschobenen IDs und dem Leeren des Journals), wird das Journal nicht angewendet. Journale ohne Kopfzeile gehören zu Generation 0.
+ * Geschrieben wird über einen LogWriter, d.h. mehrere Einträge werden gesammelt und mit commit() gemeinsam angehängt.
+ * Wird das Journal zu lang, wird es in einen neuen Snapshot "eingefaltet" (Kompaktierung) und danach geleert.
+ * Aufbau einer Zeile (Trennzeichen ";"):
+ *      S;<NutzerID>;<Guthaben>;<GetränkeID>;<Bestand>;<Tag>;<Flaschen des Nutzers>;<Käufe des Nutzers>;<verkaufte Flaschen>;<Umsatz des Getränks>;<Flaschen des Tages>;<Umsatz des Tages>   (Verkauf)
+ *      D;<NutzerID>;<Guthaben>;<Kassenstand>;<Tag>;<Einzahlungen des Nutzers>;<Anzahl Einzahlungen des Tages>;<Einzahlungen des Tages>   (Einzahlung)
+ *      R;<GetränkeID>;<Bestand>;<letzte Bestellung>     (Nachbestellung, abvro)
+ *      P;<GetränkeID>;<Preis>                           (Preisänderung)
+ *      V;<Kassenstand>                                  (Abbuchung von der Kasse)
+ *      B;<Anzahl>                                       (Beginn eines Stapels, z.B. Warenkorb: die folgenden <Anzahl> Einträge gelten nur zusammen)
+ *      G;<Generation>                                   (Kopfzeile: Generation des Snapshots, zu dem das Journal gehört)
+ * Auch die Summen für die Auswertungen (Nutzer, Getränk, Tag <JJJJMMTT>) stehen als absolute Werte in S und D. Ältere Einträge ohne diese Felder werden weiterhin angewendet.
+ */
+class Journal {
+private:
+    string path; // aktives Journal, z.B. "journal.txt"
+    LogWriter writer;
+    int records; // Anzahl der Einträge im aktiven Journal
+    bool current; // true, wenn das Journal laut Kopfzeile zum Snapshot gehört (siehe replay)
+public:
+    Journal();
+    void setPath(string nPath);
+    static string saleRecord(int userID, const User &user, int beverageID, const Beverage &beverage, int day, const DayTotals &totals);
+    static string depositRecord(int userID, const User &user, Money vBalance, int day, const DayTotals &totals);
+    static string restockRecord(int beverageID, int stock, int lastOrder);
+    static string priceRecord(int beverageID, Money price);
+    static string vBalanceRecord(Money vBalance);
+    static bool apply(string line, vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+    void append(string line);
+    void appendBatch(const vector<string> &lines);
+    bool commit();
+    void setDurability(int nDurability);
+    LogWriterStats getStats();
+    void resetStats();
+    int replay(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem, unsigned int generation);
+    bool isCurrent();
+    bool clear(unsigned int generation);
+    int getRecordCount();
+};
@@ -0,0 +1,146 @@
+#include "includes.h"
+#include "headers.h"
+#include <cstdio>
+
+/**\brief Konstruktor für LatencyHistogram-Objekte (leeres Histogramm)
+ */
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+/**\brief Bestimmt das Fach eines Werts
+ * Werte unter 16 ns haben ein eigenes Fach pro Nanosekunde, darüber bestimmen die höchsten 5 Bits (führende 1 und 4 weitere) das Fach.
+ * \param ns
+ * \return int (Fach)
+ */
+int LatencyHistogram::bucketOf(unsigned long long ns) {
+    if (ns < subBuckets) {
+        return (int) ns;
+    }
+    int exponent = 63 - __builtin_clzll(ns); // Position der führenden 1 (mindestens 4)
+    int bucket = (exponent - 3) * subBuckets + (int) ((ns >> (exponent - 4)) & (subBuckets - 1));
+    return bucket < bucketCount ? bucket : bucketCount - 1;
+}
+
+/**\brief Gibt den größten Wert zurück, der noch in ein Fach fällt
+ * \param bucket
+ * \return unsigned long long (ns)
+ */
+unsigned long long LatencyHistogram::upperBound(int bucket) {
+    if (bucket < subBuckets) {
+        return bucket;
+    }
+    int exponent = bucket / subBuckets + 3;
+    unsigned long long sub = bucket % subBuckets;
+    return ((subBuckets + sub + 1) << (exponent - 4)) - 1;
+}
+
+/**\brief Trägt eine Laufzeit ein
+ * \param ns (Nanosekunden)
+ */
+void LatencyHistogram::record(unsigned long long ns) {
+    counts[bucketOf(ns)]++;
+    count++;
+    if (ns > maxValue) {
+        maxValue = ns;
+    }
+}
+
+/**\brief Leert das Histogramm
+ */
+void LatencyHistogram::reset() {
+    for (int i=0; i < bucketCount; i++) {
+        counts[i] = 0;
+    }
+    count = 0;
+    maxValue = 0;
+}
+
+/**\brief Gibt die Anzahl der eingetragenen Laufzeiten zurück
+ */
+unsigned long long LatencyHistogram::getCount() const {
+    return count;
+}
+
+/**\brief Gibt die größte eingetragene Laufzeit zurück (exakt)
+ */
+unsigned long long LatencyHistogram::getMax() const {
+    return maxValue;
+}
+
+/**\brief Gibt ein Perzentil zurück (obere Grenze des Fachs, höchstens das Maximum)
+ * \param percentile (z.B. 50 oder 99)
+ * \return unsigned long long (ns; 0 bei leerem Histogramm)
+ */
+unsigned long long LatencyHistogram::getPercentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    unsigned long long rank = (unsigned long long) (percentile / 100.0 * count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    unsigned long long seen = 0;
+    for (int i=0; i < bucketCount; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return min(upperBound(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+/**\brief Konstruktor für LatencyStats-Objekte (alle Histogramme leer)
+ */
+LatencyStats::LatencyStats() {
+}
+
+/**\brief Trägt die Laufzeit einer Phase ein, die bei start begonnen hat und jetzt endet
+ * \param phase, start
+ * \return Clock::time_point (jetzt; Beginn der nächsten Phase)
+ */
+LatencyStats::Clock::time_point LatencyStats::record(Phase phase, Clock::time_point start) {
+    Clock::time_point now = Clock::now();
+    histograms[phase].record(chrono::duration_cast<chrono::nanoseconds>(now - start).count());
+    return now;
+}
+
+/**\brief Gibt das Histogramm einer Phase zurück
+ */
+const LatencyHistogram &LatencyStats::getHistogram(Phase phase) const {
+    return histograms[phase];
+}
+
+/**\brief Gibt den Namen einer Phase zurück (für das Kommando stats)
+ */
+const char *LatencyStats::getName(Phase phase) {
+    static const char *names[PhaseCount] = {"sale.validate", "sale.apply", "sale.format", "sale.submit", "sale.buttons", "sale.logout", "sale.total",
+                                            "deposit.parse", "deposit.apply", "deposit.format", "deposit.submit", "deposit.gui", "deposit.total"};
+    return names[phase];
+}
+
+/**\brief Erstellt die Ausgabe des Kommandos stats: pro gemessener Phase Anzahl, p50, p99 und Maximum in µs
+ * \return vector<string> (eine Zeile pro Phase)
+ */
+vector<string> LatencyStats::report() const {
+    vector<string> fLines;
+    char line[128];
+    for (int i=0; i < PhaseCount; i++) {
+        const LatencyHistogram &histogram = histograms[i];
+        if (histogram.getCount() == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%-15s n=%-7llu p50 %9.1f µs | p99 %9.1f µs | max %9.1f µs", getName((Phase) i), histogram.getCount(),
+                 histogram.getPercentile(50) / 1000.0, histogram.getPercentile(99) / 1000.0, histogram.getMax() / 1000.0);
+        fLines.push_back(line);
+    }
+    return fLines;
+}
+
+/**\brief Leert alle Histogramme
+ */
+void LatencyStats::reset() {
+    for (int i=0; i < PhaseCount; i++) {
+        histograms[i].reset();
+    }
+}
@@ -0,0 +1,46 @@
+#include "includes.h"
+#include <chrono>
+
+/**\brief Klasse "LatencyHistogram" für das Sammeln von Laufzeiten einer Phase (HDR-Histogramm)
+ * Jede Zweierpotenz von Nanosekunden wird in 16 gleich breite Fächer geteilt; ein Wert landet also mit höchstens 1/16 (6,25%) relativem Fehler in seinem Fach.
+ * Alle Fächer liegen in einem festen Array (keine Allokation beim Messen), erfasst werden Werte bis etwa 36 Minuten.
+ * Perzentile werden als obere Grenze des jeweiligen Fachs zurückgegeben, das Maximum exakt.
+ */
+class LatencyHistogram {
+private:
+    static const int subBuckets = 16;
+    static const int bucketCount = 38 * subBuckets;
+    unsigned int counts[bucketCount];
+    unsigned long long count;
+    unsigned long long maxValue;
+    static int bucketOf(unsigned long long ns);
+    static unsigned long long upperBound(int bucket);
+public:
+    LatencyHistogram();
+    void record(unsigned long long ns);
+    void reset();
+    unsigned long long getCount() const;
+    unsigned long long getMax() const;
+    unsigned long long getPercentile(double percentile) const;
+};
+
+/**\brief Klasse "LatencyStats" mit je einem Histogramm pro Phase des Verkaufs- und des Einzahlungspfads
+ * Die Phasen werden sowohl in der PosEngine (Prüfen, Buchen, Formatieren, Übergabe an den Schreib-Thread) als auch in der GUI (Buttons, Ausloggen) gemessen.
+ * record() gibt den aktuellen Zeitpunkt zurück, sodass aufeinanderfolgende Phasen mit nur einem Aufruf der Uhr pro Phase gemessen werden:
+ *   t = stats.record(LatencyStats::SaleValidate, t);
+ * Nicht threadsicher; wird nur vom GUI-Thread (bzw. dem Hauptthread von poscli) verwendet.
+ */
+class LatencyStats {
+public:
+    enum Phase { SaleValidate, SaleApply, SaleFormat, SaleSubmit, SaleButtons, SaleLogout, SaleTotal,
+                 DepositParse, DepositApply, DepositFormat, DepositSubmit, DepositGui, DepositTotal, PhaseCount };
+    typedef chrono::steady_clock Clock;
+    LatencyStats();
+    Clock::time_point record(Phase phase, Clock::time_point start);
+    const LatencyHistogram &getHistogram(Phase phase) const;
+    static const char *getName(Phase phase);
+    vector<string> report() const;
+    void reset();
+private:
+    LatencyHistogram histograms[PhaseCount];
+};
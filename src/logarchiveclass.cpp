@@ -0,0 +1,298 @@
+#include "includes.h"
+#include "headers.h"
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**\brief Prüft, ob ein Nutzer im Segment vorkommt (binäre Suche)
+ * \return bool
+ */
+bool LogSegmentInfo::hasUser(int userID) const {
+    return binary_search(userIDs.begin(), userIDs.end(), userID);
+}
+
+/**\brief Teilt eine Zeile des Manifests an den ";" auf
+ * \return vector<string> (Felder der Zeile)
+ */
+static vector<string> splitManifestLine(const string &line) {
+    vector<string> fields;
+    size_t start = 0;
+    size_t pos = line.find(";");
+    while (pos != string::npos) {
+        fields.push_back(line.substr(start, pos-start));
+        start = pos+1;
+        pos = line.find(";", start);
+    }
+    fields.push_back(line.substr(start));
+    return fields;
+}
+
+/**\brief Konstruktor für LogArchive-Objekte
+ * Standardmäßig wird transactionlog.txt (mit Index) archiviert.
+ */
+LogArchive::LogArchive() {
+    setPaths("transactionlog", "transactionlog.txt", "transactionlog.idx", LogIndex::parseUserID);
+}
+
+/**\brief Setzt die Namen der Dateien
+ * \param nBaseName (Präfix für Manifest und Segmente), nActivePath (aktive Logdatei), nActiveIndexPath (Index der aktiven Logdatei oder ""), nParseUserID (liest die NutzerID aus einer Zeile, -1 wenn keine vorhanden)
+ */
+void LogArchive::setPaths(string nBaseName, string nActivePath, string nActiveIndexPath, int (*nParseUserID)(const string &line)) {
+    baseName = nBaseName;
+    activePath = nActivePath;
+    activeIndexPath = nActiveIndexPath;
+    parseUserID = nParseUserID;
+    activeMonth = 0;
+    activeFirstTime = 0;
+    segments.clear();
+}
+
+/**\brief Gibt den Pfad des Manifests zurück
+ */
+string LogArchive::manifestPath() {
+    return baseName + ".manifest";
+}
+
+/**\brief Berechnet den Monat eines Zeitpunkts (Ortszeit)
+ * \param time (Unixzeit)
+ * \return int (Monat als JJJJMM, z.B. 202610)
+ */
+int LogArchive::monthOf(long long time) {
+    time_t t = time;
+    struct tm local;
+    localtime_r(&t, &local);
+    return (local.tm_year + 1900) * 100 + local.tm_mon + 1;
+}
+
+/**\brief Liest den Zeitstempel am Anfang einer Logzeile
+ * Aktuelle Zeilen beginnen mit dem vollen Zeitpunkt "JJJJMMTThhmmss" (transactionlog.txt) bzw. mit NutzerID + "JJJJMMTThhmmss" (TransaktionsID in depositlog.txt).
+ * Ältere Zeilen enthalten nur "MMTThhmmss" bzw. NutzerID + "MMTThhmm"; das Jahr wird dann aus dem Monat der Datei (Segment oder aktive Logdatei) ergänzt.
+ * \param line, month (JJJJMM der Datei, aus der die Zeile stammt), userPrefix (true, wenn vor dem Zeitstempel die NutzerID steht)
+ * \return long long (JJJJMMTThhmmss; -1, wenn die Zeile keinen Zeitstempel hat, z.B. "---" in depositlog.txt)
+ */
+long long LogArchive::parseStamp(const string &line, int month, bool userPrefix) {
+    size_t digits = 0;
+    while (digits < line.size() && line[digits] >= '0' && line[digits] <= '9') {
+        digits++;
+    }
+    size_t stampDigits;
+    if (userPrefix) {
+        stampDigits = digits >= 16 ? 14 : 8; // die NutzerID hat mindestens zwei Stellen (siehe PosEngine::convertUserID)
+        if (digits < stampDigits + 2) {
+            return -1;
+        }
+    }
+    else if (digits == 14 || digits == 10) {
+        stampDigits = digits;
+    }
+    else {
+        return -1;
+    }
+    long long stamp = 0;
+    for (size_t i = digits - stampDigits; i < digits; i++) {
+        stamp = stamp * 10 + (line[i] - '0');
+    }
+    if (stampDigits == 14) {
+        return stamp;
+    }
+    if (stampDigits == 8) { // "MMTThhmm"
+        stamp *= 100;
+    }
+    return (month / 100) * 10000000000LL + stamp;
+}
+
+/**\brief Liest das Manifest
+ * Wurde beim letzten Versiegeln zwar das Manifest, aber nicht mehr das Leeren der aktiven Logdatei geschafft (Absturz), wird die aktive Logdatei jetzt geleert.
+ * \return bool (false, wenn das Manifest zwar existiert, aber nicht gelesen werden konnte, oder wenn die bereits versiegelte aktive Logdatei nicht geleert werden konnte)
+ */
+bool LogArchive::load() {
+    lock_guard<mutex> lock(archiveMutex);
+    activeMonth = 0;
+    activeFirstTime = 0;
+    segments.clear();
+    ifstream manifest;
+    manifest.open(manifestPath());
+    if (!manifest.is_open()) {
+        return true; // noch nie versiegelt
+    }
+    string line;
+    while (getline(manifest, line)) {
+        vector<string> f = splitManifestLine(line);
+        try {
+            if (f[0] == "A" && f.size() == 3) {
+                activeMonth = stoi(f[1]);
+                activeFirstTime = stoll(f[2]);
+            }
+            else if (f[0] == "S" && f.size() == 9) {
+                LogSegmentInfo segment;
+                segment.month = stoi(f[1]);
+                segment.firstTime = stoll(f[2]);
+                segment.lastTime = stoll(f[3]);
+                segment.lines = stoul(f[4]);
+                segment.rawSize = stoull(f[5]);
+                segment.file = f[6];
+                segment.indexFile = (f[7] == "-") ? "" : f[7];
+                if (f[8] != "-") {
+                    size_t start = 0;
+                    size_t pos = f[8].find(",");
+                    while (pos != string::npos) {
+                        segment.userIDs.push_back(stoi(f[8].substr(start, pos-start)));
+                        start = pos+1;
+                        pos = f[8].find(",", start);
+                    }
+                    segment.userIDs.push_back(stoi(f[8].substr(start)));
+                }
+                segments.push_back(segment);
+            }
+        }
+        catch (const exception &) {
+            // beschädigte Zeile überspringen
+        }
+    }
+    manifest.close();
+    struct stat info;
+    if (!segments.empty() && stat(activePath.c_str(), &info) == 0 && info.st_size > 0 && (unsigned long long) info.st_size == segments.back().rawSize && info.st_mtime == segments.back().lastTime) {
+        return truncate(activePath.c_str(), 0) == 0; // Inhalt steckt bereits im letzten Segment
+    }
+    return true;
+}
+
+/**\brief Gibt den Monat der aktiven Logdatei zurück
+ * \return int (JJJJMM; 0, wenn noch kein Monat festgelegt ist)
+ */
+int LogArchive::getActiveMonth() {
+    lock_guard<mutex> lock(archiveMutex);
+    return activeMonth;
+}
+
+/**\brief Schreibt das Manifest neu (temporäre Datei, danach umbenennen)
+ * \return bool (false, wenn das Manifest nicht geschrieben werden konnte)
+ */
+bool LogArchive::writeManifest() {
+    string tmpPath = manifestPath() + ".tmp";
+    ofstream manifest;
+    manifest.open(tmpPath, ios::out | ios::trunc);
+    if (manifest.is_open()) {
+        for (int i=0; i < segments.size(); i++) {
+            manifest << "S;" << segments[i].month << ";" << segments[i].firstTime << ";" << segments[i].lastTime << ";" << segments[i].lines << ";" << segments[i].rawSize << ";" << segments[i].file << ";" << (segments[i].indexFile.empty() ? "-" : segments[i].indexFile) << ";";
+            if (segments[i].userIDs.empty()) {
+                manifest << "-";
+            }
+            for (int j=0; j < segments[i].userIDs.size(); j++) {
+                manifest << (j > 0 ? "," : "") << segments[i].userIDs[j];
+            }
+            manifest << "\n";
+        }
+        manifest << "A;" << activeMonth << ";" << activeFirstTime << "\n";
+    }
+    else {
+        return false;
+    }
+    manifest.close();
+    if (manifest.fail()) {
+        return false;
+    }
+    return rename(tmpPath.c_str(), manifestPath().c_str()) == 0;
+}
+
+/**\brief Versiegelt die aktive Logdatei, wenn eine Zeile aus einem anderen Monat geschrieben werden soll
+ * Alle gesammelten Zeilen müssen vorher geschrieben sein. Danach muss der Aufrufer die aktive Logdatei (und deren Index) leeren, sofern vorher schon ein Monat aktiv war.
+ * Eine Logdatei aus der Zeit vor den Segmenten (noch kein Monat festgelegt) wird nicht versiegelt, sondern dem neuen Monat zugeschlagen.
+ * \param time (Zeitpunkt der neuen Zeile als Unixzeit)
+ * Kann das Manifest nicht geschrieben werden, werden Segment und Umbenennung des Index wieder zurückgenommen, damit Manifest und Dateien zusammenpassen.
+ * \return bool (false, wenn das Segment oder das Manifest nicht geschrieben werden konnte; die aktive Logdatei und ihr Index bleiben dann unverändert)
+ */
+bool LogArchive::rotate(long long time) {
+    int month = monthOf(time);
+    lock_guard<mutex> lock(archiveMutex);
+    if (month == activeMonth) {
+        return true;
+    }
+    struct stat info;
+    bool sealed = false;
+    if (activeMonth != 0 && stat(activePath.c_str(), &info) == 0 && info.st_size > 0) {
+        LogSegmentInfo segment;
+        segment.month = activeMonth;
+        segment.firstTime = activeFirstTime;
+        segment.lastTime = info.st_mtime; // letzter Schreibzugriff = letzte Zeile
+        segment.rawSize = info.st_size;
+        segment.lines = 0;
+        string name = baseName + "-" + to_string(activeMonth);
+        for (int n = 2; stat((name + ".seg").c_str(), &info) == 0; n++) { // Monat schon einmal versiegelt (z.B. Uhr zurückgestellt)
+            name = baseName + "-" + to_string(activeMonth) + "-" + to_string(n);
+        }
+        segment.file = name + ".seg";
+
+        ifstream activeLog;
+        activeLog.open(activePath);
+        string line;
+        while (getline(activeLog, line)) {
+            segment.lines++;
+            int userID = parseUserID(line);
+            if (userID >= 0) {
+                segment.userIDs.push_back(userID);
+            }
+        }
+        activeLog.close();
+        sort(segment.userIDs.begin(), segment.userIDs.end());
+        segment.userIDs.erase(unique(segment.userIDs.begin(), segment.userIDs.end()), segment.userIDs.end());
+
+        if (!Segment::compress(activePath, segment.file)) {
+            return false;
+        }
+        if (!activeIndexPath.empty() && rename(activeIndexPath.c_str(), (name + ".idx").c_str()) == 0) {
+            segment.indexFile = name + ".idx";
+        }
+        segments.push_back(segment);
+        sealed = true;
+    }
+    int previousMonth = activeMonth;
+    long long previousFirstTime = activeFirstTime;
+    activeMonth = month;
+    activeFirstTime = time;
+    if (!writeManifest()) { // alten Stand wiederherstellen, das Segment steht nicht im Manifest
+        if (sealed) {
+            if (!segments.back().indexFile.empty() && rename(segments.back().indexFile.c_str(), activeIndexPath.c_str()) != 0) {
+                remove(segments.back().indexFile.c_str()); // der Index wird beim nächsten Start neu aufgebaut
+            }
+            remove(segments.back().file.c_str());
+            segments.pop_back();
+        }
+        activeMonth = previousMonth;
+        activeFirstTime = previousFirstTime;
+        return false;
+    }
+    return true;
+}
+
+/**\brief Löscht alle versiegelten Segmente (z.B. bei cleardeplog)
+ * \return bool (false, wenn das Manifest nicht geschrieben werden konnte)
+ */
+bool LogArchive::clear() {
+    lock_guard<mutex> lock(archiveMutex);
+    for (int i=0; i < segments.size(); i++) {
+        remove(segments[i].file.c_str());
+        if (!segments[i].indexFile.empty()) {
+            remove(segments[i].indexFile.c_str());
+        }
+    }
+    segments.clear();
+    return writeManifest();
+}
+
+/**\brief Gibt alle versiegelten Segmente eines Zeitraums zurück
+ * \param fromMonth, toMonth (JJJJMM, jeweils einschließlich)
+ * \return vector<LogSegmentInfo> (älteste zuerst)
+ */
+vector<LogSegmentInfo> LogArchive::getSegments(int fromMonth, int toMonth) {
+    lock_guard<mutex> lock(archiveMutex);
+    vector<LogSegmentInfo> fSegments;
+    for (int i=0; i < segments.size(); i++) {
+        if (segments[i].month >= fromMonth && segments[i].month <= toMonth) {
+            fSegments.push_back(segments[i]);
+        }
+    }
+    return fSegments;
+}
@@ -0,0 +1,49 @@
+#include "includes.h"
+
+/**\brief Beschreibung eines versiegelten Segments im Manifest
+ */
+struct LogSegmentInfo {
+    int month; // Monat des Segments als JJJJMM
+    long long firstTime; // Zeitpunkt der ersten Zeile (Unixzeit)
+    long long lastTime; // Zeitpunkt der letzten Zeile (Unixzeit)
+    unsigned long lines; // Anzahl der Zeilen
+    unsigned long long rawSize; // Größe der Logdatei vor der Kompression
+    string file; // Segmentdatei (siehe Segment)
+    string indexFile; // Index der Zeilen pro Nutzer (siehe LogIndex), leer wenn die Logdatei nicht indiziert wird
+    vector<int> userIDs; // alle Nutzer, die im Segment vorkommen (aufsteigend)
+    bool hasUser(int userID) const;
+};
+
+/**\brief Klasse "LogArchiveclass" für das Aufteilen einer Logdatei in Monatssegmente
+ * Die aktive Logdatei (z.B. "transactionlog.txt") enthält nur noch die Zeilen des aktuellen Monats.
+ * Beginnt ein neuer Monat, wird sie versiegelt: ihr Inhalt wird als komprimiertes Segment (z.B. "transactionlog-202609.seg") abgelegt, der Index wird mit umbenannt und die aktive Datei danach geleert.
+ * Im Manifest (z.B. "transactionlog.manifest") steht zu jedem Segment der Zeitraum und welche Nutzer darin vorkommen, damit Abfragen nur die Segmente öffnen müssen, die sie betreffen.
+ * Aufbau einer Zeile des Manifests (Trennzeichen ";", leere Felder als "-"):
+ *      A;<Monat>;<erste Zeile>                                                                  (aktive Logdatei)
+ *      S;<Monat>;<erste Zeile>;<letzte Zeile>;<Zeilen>;<Größe>;<Datei>;<Index>;<NutzerID,...>    (versiegeltes Segment)
+ * Die Zeitpunkte werden als Unixzeit gespeichert, der Monat als JJJJMM.
+ * Die Zeilen der Logdateien selbst beginnen mit einem vollen Zeitstempel (siehe parseStamp) und stehen in zeitlicher Reihenfolge, sodass Zeiträume per Binärsuche gefunden werden (siehe LogView).
+ */
+class LogArchive {
+private:
+    string baseName; // z.B. "transactionlog"
+    string activePath; // aktive Logdatei
+    string activeIndexPath; // Index der aktiven Logdatei, leer wenn nicht indiziert wird
+    int (*parseUserID)(const string &line);
+    int activeMonth; // 0, solange noch keine Zeile geschrieben wurde
+    long long activeFirstTime;
+    vector<LogSegmentInfo> segments; // älteste zuerst
+    mutex archiveMutex;
+    string manifestPath();
+    bool writeManifest();
+public:
+    LogArchive();
+    void setPaths(string nBaseName, string nActivePath, string nActiveIndexPath, int (*nParseUserID)(const string &line));
+    static int monthOf(long long time);
+    static long long parseStamp(const string &line, int month, bool userPrefix);
+    bool load();
+    int getActiveMonth();
+    bool rotate(long long time);
+    bool clear();
+    vector<LogSegmentInfo> getSegments(int fromMonth, int toMonth);
+};
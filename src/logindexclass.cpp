@@ -0,0 +1,302 @@
+#include "includes.h"
+#include "headers.h"
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
+
+static const size_t indexEntrySize = 16; // NutzerID (4) + Länge (4) + Position (8)
+static const int32_t headerID = -1; // NutzerID des Kopfs (erster Eintrag der Indexdatei)
+
+/**\brief Legt eine leere Indexdatei an, die nur aus einem Kopf ohne Logdatei (Größe und Zeit 0) besteht
+ * \return bool (false, wenn die Datei nicht geschrieben werden konnte)
+ */
+static bool createIndex(const string &indexPath) {
+    char header[indexEntrySize];
+    memset(header, 0, indexEntrySize);
+    memcpy(header, &headerID, 4);
+    ofstream emptyIndex(indexPath, ios::out | ios::trunc | ios::binary);
+    emptyIndex.write(header, indexEntrySize);
+    emptyIndex.close();
+    return !emptyIndex.fail();
+}
+
+/**\brief Konstruktor für LogIndex-Objekte
+ * Standardmäßig wird transactionlog.txt indiziert und der Index in transactionlog.idx gesichert.
+ */
+LogIndex::LogIndex() {
+    setPaths("transactionlog.txt", "transactionlog.idx");
+}
+
+/**\brief Setzt die Pfade der Logdatei und der Indexdatei
+ * \param nLogPath (Pfad der Logdatei), nIndexPath (Pfad der Indexdatei)
+ */
+void LogIndex::setPaths(string nLogPath, string nIndexPath) {
+    logPath = nLogPath;
+    indexPath = nIndexPath;
+    offsets.clear();
+    coveredSize = 0;
+    pendingEntries.clear();
+}
+
+/**\brief Liest die NutzerID aus einer Zeile der Logdatei
+ * Die ID steht zwischen dem ersten und dem zweiten " | " (z.B. "0705122046 | 03 | -0.8 | 29.2 | Fritz Cola").
+ * \return int (NutzerID; -1, wenn die Zeile keine gültige ID enthält)
+ */
+int LogIndex::parseUserID(const string &line) {
+    size_t posFD = line.find(" | ");
+    if (posFD == string::npos) {
+        return -1;
+    }
+    size_t posSD = line.find(" | ", posFD+3);
+    if (posSD == string::npos || posSD == posFD+3) {
+        return -1;
+    }
+    int userID = 0;
+    for (size_t i = posFD+3; i < posSD; i++) {
+        if (line[i] < '0' || line[i] > '9') {
+            return -1;
+        }
+        userID = userID * 10 + (line[i] - '0');
+    }
+    return userID;
+}
+
+/**\brief Trägt eine Zeile in den Index im Speicher ein
+ */
+void LogIndex::addEntry(int userID, unsigned long long offset, unsigned int length) {
+    offsets[userID].push_back(offset);
+    coveredSize = max(coveredSize, offset + length);
+}
+
+/**\brief Trägt eine neu an die Logdatei angehängte Zeile in den Index ein
+ * Der Eintrag wird erst mit commit() an die Indexdatei angehängt.
+ * \param userID (NutzerID der Zeile), offset (Position der Zeile in der Logdatei), length (Länge der Zeile inkl. Zeilenumbruch)
+ */
+void LogIndex::add(int userID, unsigned long long offset, unsigned int length) {
+    lock_guard<mutex> lock(indexMutex);
+    addEntry(userID, offset, length);
+    char entry[indexEntrySize];
+    int32_t id = userID;
+    uint32_t len = length;
+    uint64_t pos = offset;
+    memcpy(entry, &id, 4);
+    memcpy(entry + 4, &len, 4);
+    memcpy(entry + 8, &pos, 8);
+    pendingEntries.insert(pendingEntries.end(), entry, entry + indexEntrySize);
+}
+
+/**\brief Überschreibt den Kopf der Indexdatei mit Größe und Änderungszeit der Logdatei
+ * \return bool (false, wenn der Kopf nicht geschrieben werden konnte)
+ */
+bool LogIndex::writeHeader(fstream &index) {
+    struct stat info;
+    if (stat(logPath.c_str(), &info) != 0) {
+        return false;
+    }
+    char header[indexEntrySize];
+    uint32_t time = info.st_mtime;
+    uint64_t size = info.st_size;
+    memcpy(header, &headerID, 4);
+    memcpy(header + 4, &time, 4);
+    memcpy(header + 8, &size, 8);
+    index.seekp(0);
+    index.write(header, indexEntrySize);
+    index.flush();
+    return !index.fail();
+}
+
+/**\brief Hängt alle neuen Einträge an die Indexdatei an und vermerkt im Kopf den aktuellen Stand der Logdatei
+ * Fehlt die Indexdatei, wird sie hier nicht neu angelegt (ihr würden die älteren Einträge fehlen); sie wird dann beim nächsten load() neu aufgebaut.
+ * \return bool (false, wenn die Indexdatei nicht geschrieben werden konnte)
+ */
+bool LogIndex::commit() {
+    lock_guard<mutex> lock(indexMutex);
+    fstream index;
+    index.open(indexPath, ios::in | ios::out | ios::binary);
+    if (!index.is_open()) {
+        return false;
+    }
+    if (!pendingEntries.empty()) {
+        index.seekp(0, ios::end);
+        index.write(pendingEntries.data(), pendingEntries.size());
+        if (index.fail()) {
+            return false;
+        }
+        pendingEntries.clear();
+    }
+    bool written = writeHeader(index);
+    index.close();
+    return written;
+}
+
+/**\brief Indiziert die Logdatei ab einer bestimmten Position bis zum Ende
+ * Eine letzte Zeile ohne Zeilenumbruch (wird vermutlich gerade geschrieben) wird nicht indiziert.
+ * \return bool (false, wenn die Logdatei nicht gelesen werden konnte)
+ */
+bool LogIndex::scanLog(unsigned long long from) {
+    ifstream transactionlog;
+    transactionlog.open(logPath, ios::in | ios::binary);
+    if (!transactionlog.is_open()) {
+        return false;
+    }
+    transactionlog.seekg(from);
+    unsigned long long offset = from;
+    string transaction;
+    while (getline(transactionlog, transaction)) {
+        if (transactionlog.eof()) { // kein Zeilenumbruch am Ende
+            break;
+        }
+        unsigned int length = transaction.size() + 1;
+        int userID = parseUserID(transaction);
+        if (userID >= 0) {
+            add(userID, offset, length);
+        }
+        offset += length;
+    }
+    transactionlog.close();
+    lock_guard<mutex> lock(indexMutex);
+    coveredSize = max(coveredSize, offset);
+    return true;
+}
+
+/**\brief Prüft, ob an einer indizierten Position noch die passende Zeile der Logdatei steht
+ * \return bool (false, wenn dort eine Zeile anderer Länge oder eines anderen Nutzers steht)
+ */
+bool LogIndex::matchesLog(int userID, unsigned long long offset, unsigned int length) {
+    ifstream transactionlog;
+    transactionlog.open(logPath, ios::in | ios::binary);
+    if (!transactionlog.is_open() || length == 0) {
+        return false;
+    }
+    string line(length, '\0');
+    transactionlog.seekg(offset);
+    transactionlog.read(&line[0], length);
+    if (transactionlog.gcount() != length || line[length-1] != '\n') {
+        return false;
+    }
+    line.resize(length-1);
+    return line.find('\n') == string::npos && parseUserID(line) == userID;
+}
+
+/**\brief Lädt die Indexdatei und gleicht sie mit der Logdatei ab
+ * Fehlt die Indexdatei (oder ihr Kopf, z.B. bei einem Index einer älteren Version), wird sie komplett neu aufgebaut. Ist die Logdatei seit dem letzten Schreiben des Index gewachsen, werden nur die neuen Zeilen nachgetragen.
+ * Zeigt der Index hinter das Ende der Logdatei (Logdatei wurde gekürzt), wird er ebenfalls komplett neu aufgebaut.
+ * Stimmen Größe oder Änderungszeit der Logdatei nicht mit dem Kopf überein, wird zusätzlich geprüft, ob der letzte Eintrag noch auf eine passende Zeile zeigt; sonst wurde die Logdatei ersetzt und der Index wird neu aufgebaut.
+ * \return bool (false, wenn die Indexdatei nicht geschrieben werden konnte)
+ * \warning Nur aufrufen, solange noch kein anderer Thread an die Logdatei anhängt!
+ */
+bool LogIndex::load() {
+    struct stat info;
+    unsigned long long logSize = 0;
+    uint32_t logTime = 0;
+    if (stat(logPath.c_str(), &info) == 0) {
+        logSize = info.st_size;
+        logTime = info.st_mtime;
+    }
+    {
+        lock_guard<mutex> lock(indexMutex);
+        offsets.clear();
+        coveredSize = 0;
+        pendingEntries.clear();
+    }
+    bool rebuild = false;
+    uint32_t headerTime = 0;
+    uint64_t headerSize = 0;
+    int32_t lastID = headerID;
+    uint32_t lastLength = 0;
+    uint64_t lastOffset = 0;
+    ifstream index;
+    index.open(indexPath, ios::in | ios::binary);
+    if (index.is_open()) {
+        char entry[indexEntrySize];
+        int32_t id = 0;
+        if (index.read(entry, indexEntrySize)) {
+            memcpy(&id, entry, 4);
+            memcpy(&headerTime, entry + 4, 4);
+            memcpy(&headerSize, entry + 8, 8);
+        }
+        rebuild = id != headerID;
+        while (!rebuild && index.read(entry, indexEntrySize)) {
+            int32_t id;
+            uint32_t len;
+            uint64_t pos;
+            memcpy(&id, entry, 4);
+            memcpy(&len, entry + 4, 4);
+            memcpy(&pos, entry + 8, 8);
+            if (pos + len > logSize) {
+                rebuild = true;
+                break;
+            }
+            addEntry(id, pos, len);
+            lastID = id;
+            lastLength = len;
+            lastOffset = pos;
+        }
+        index.close();
+    }
+    else {
+        rebuild = true;
+    }
+    if (!rebuild && (headerSize != logSize || headerTime != logTime)) { // Logdatei wurde seitdem verändert: angehängt (Absturz vor dem Index) oder ersetzt
+        rebuild = headerSize > logSize || (lastID != headerID && !matchesLog(lastID, lastOffset, lastLength));
+    }
+    if (rebuild) {
+        {
+            lock_guard<mutex> lock(indexMutex);
+            offsets.clear();
+            coveredSize = 0;
+        }
+        createIndex(indexPath);
+    }
+    if (coveredSize < logSize) {
+        scanLog(coveredSize);
+    }
+    return commit();
+}
+
+/**\brief Leert den Index, nachdem die Logdatei geleert wurde (z.B. beim Versiegeln eines Monats)
+ * \return bool (false, wenn die Indexdatei nicht geleert werden konnte)
+ */
+bool LogIndex::clear() {
+    lock_guard<mutex> lock(indexMutex);
+    offsets.clear();
+    coveredSize = 0;
+    pendingEntries.clear();
+    return createIndex(indexPath);
+}
+
+/**\brief Gibt die Positionen aller Zeilen eines Nutzers zurück
+ * \return vector<unsigned long long> (aufsteigend, also älteste Buchung zuerst)
+ */
+vector<unsigned long long> LogIndex::getOffsets(int userID) {
+    lock_guard<mutex> lock(indexMutex);
+    map<int, vector<unsigned long long> >::iterator it = offsets.find(userID);
+    if (it == offsets.end()) {
+        return vector<unsigned long long>();
+    }
+    return it->second;
+}
+
+/**\brief Liest die Positionen aller Zeilen eines Nutzers direkt aus einer Indexdatei (z.B. dem Index eines versiegelten Segments)
+ * \param nIndexPath (Pfad der Indexdatei), userID
+ * \return vector<unsigned long long> (aufsteigend; leer, wenn die Datei fehlt)
+ */
+vector<unsigned long long> LogIndex::readOffsets(string nIndexPath, int userID) {
+    vector<unsigned long long> userOffsets;
+    ifstream index;
+    index.open(nIndexPath, ios::in | ios::binary);
+    if (index.is_open()) {
+        char entry[indexEntrySize];
+        while (index.read(entry, indexEntrySize)) {
+            int32_t id;
+            uint64_t pos;
+            memcpy(&id, entry, 4);
+            memcpy(&pos, entry + 8, 8);
+            if (id == userID) {
+                userOffsets.push_back(pos);
+            }
+        }
+    }
+    index.close();
+    return userOffsets;
+}
@@ -0,0 +1,34 @@
+#include "includes.h"
+
+/**\brief Klasse "LogIndexclass" für den Zugriff auf die Buchungen eines einzelnen Nutzers in transactionlog.txt
+ * Zu jeder Zeile der Logdatei wird gespeichert, zu welchem Nutzer sie gehört und an welcher Byte-Position sie steht.
+ * Die Historie eines Nutzers kann so direkt an die richtigen Stellen springen, anstatt die komplette Logdatei zu durchsuchen.
+ * Der Index wird zusätzlich in einer eigenen Datei (z.B. "transactionlog.idx") gesichert, an die bei jeder Buchung nur angehängt wird.
+ * Aufbau eines Eintrags (16 Byte): NutzerID (int32), Länge der Zeile inkl. Zeilenumbruch (uint32), Position in der Logdatei (uint64)
+ * Der erste Eintrag ist ein Kopf mit NutzerID -1, der Änderungszeit (uint32, Unixzeit) und der Größe der Logdatei (uint64) beim letzten commit(); er wird dabei jeweils überschrieben.
+ * Fehlt die Indexdatei oder deckt sie nicht die komplette Logdatei ab, wird sie beim Laden automatisch neu aufgebaut bzw. ergänzt.
+ * Passen Größe und Änderungszeit nicht mehr zum Kopf (z.B. Logdatei aus einer Sicherung zurückgespielt), muss zusätzlich der letzte Eintrag noch auf eine passende Zeile zeigen, sonst wird neu aufgebaut.
+ */
+class LogIndex {
+private:
+    string logPath;
+    string indexPath;
+    map<int, vector<unsigned long long> > offsets; // NutzerID -> Positionen aller Zeilen dieses Nutzers (aufsteigend)
+    unsigned long long coveredSize; // bis zu dieser Byte-Position ist die Logdatei indiziert
+    vector<char> pendingEntries; // neue Einträge, die noch an die Indexdatei angehängt werden müssen
+    mutex indexMutex;
+    void addEntry(int userID, unsigned long long offset, unsigned int length);
+    bool scanLog(unsigned long long from);
+    bool matchesLog(int userID, unsigned long long offset, unsigned int length);
+    bool writeHeader(fstream &index);
+public:
+    LogIndex();
+    void setPaths(string nLogPath, string nIndexPath);
+    static int parseUserID(const string &line);
+    bool load();
+    bool clear();
+    void add(int userID, unsigned long long offset, unsigned int length);
+    bool commit();
+    vector<unsigned long long> getOffsets(int userID);
+    static vector<unsigned long long> readOffsets(string nIndexPath, int userID);
+};
@@ -0,0 +1,86 @@
+#include "includes.h"
+#include "headers.h"
+#include "logmodelclass.h"
+
+const int logModelPageSize = 100; // so viele Zeilen werden pro fetchMore() gelesen
+
+/**\brief Konstruktor für LogModel-Objekte (leeres Model)
+ * \param parent (Qt-Elternobjekt)
+ */
+LogModel::LogModel(QObject *parent) :
+    QAbstractListModel(parent)
+{
+}
+
+/**\brief Gibt die Ansicht zurück, damit sie neu gefüllt werden kann (z.B. mit Persistence::openUserTransactions)
+ * Nach dem Füllen muss reload() aufgerufen werden.
+ * \return LogView&
+ */
+LogView &LogModel::getView() {
+    return view;
+}
+
+/**\brief Verwirft alle geladenen Zeilen; die erste Seite der (neu gefüllten) Ansicht wird danach von der QListView über fetchMore() angefordert
+ */
+void LogModel::reload() {
+    beginResetModel();
+    rows.clear();
+    endResetModel();
+}
+
+/**\brief Leert Model und Ansicht (z.B. beim Verlassen der Historie)
+ */
+void LogModel::clear() {
+    beginResetModel();
+    rows.clear();
+    view.clear();
+    endResetModel();
+}
+
+/**\brief Gibt die Anzahl der bereits geladenen Zeilen zurück
+ * \return int
+ */
+int LogModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return rows.size();
+}
+
+/**\brief Gibt den Text einer geladenen Zeile zurück
+ * \return QVariant (leer für andere Rollen als DisplayRole)
+ */
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return rows.at(index.row());
+}
+
+/**\brief Prüft, ob die Ansicht noch weitere (ältere) Zeilen hat
+ * \return bool
+ */
+bool LogModel::canFetchMore(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return false;
+    }
+    return rows.size() < view.getRowCount();
+}
+
+/**\brief Lädt die nächste Seite (ältere Zeilen) aus der Ansicht
+ */
+void LogModel::fetchMore(const QModelIndex &parent) {
+    if (parent.isValid()) {
+        return;
+    }
+    int count = qMin(logModelPageSize, view.getRowCount() - rows.size());
+    if (count <= 0) {
+        return;
+    }
+    vector<string> fRows = view.readRows(rows.size(), count);
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + fRows.size() - 1);
+    for (int i=0; i < fRows.size(); i++) {
+        rows.append(QString::fromStdString(fRows[i]));
+    }
+    endInsertRows();
+}
@@ -0,0 +1,26 @@
+#include <QAbstractListModel>
+#include <QStringList>
+#include "includes.h"
+
+/**\brief Klasse "LogModelclass" als Qt-Model für Logansichten (Historie, Einzahlungsliste)
+ * Die Zeilen kommen aus einem LogView und werden erst beim Scrollen seitenweise nachgeladen (canFetchMore/fetchMore), neueste zuerst.
+ * Eine QListView zeigt davon nur die sichtbaren Zeilen an; das Öffnen einer Historie mit 10.000 Buchungen dauert also genauso lange wie mit 10.
+ */
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogModel(QObject *parent = nullptr);
+    LogView &getView();
+    void reload();
+    void clear();
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    LogView view;
+    QStringList rows; // bereits geladene Zeilen
+};
@@ -0,0 +1,325 @@
+#include "includes.h"
+#include "headers.h"
+#include <algorithm>
+#include <climits>
+
+/**\brief Konstruktor für LogView-Objekte (leere Ansicht)
+ */
+LogView::LogView() {
+    rows = 0;
+    openSource = -1;
+}
+
+/**\brief Leert die Ansicht und schließt geöffnete Dateien
+ */
+void LogView::clear() {
+    paths.clear();
+    compressed.clear();
+    offsets.clear();
+    firstRows.clear();
+    rows = 0;
+    openSource = -1;
+    segment.close();
+    log.close();
+}
+
+/**\brief Hängt eine Quelle als neueste an die Ansicht an
+ */
+void LogView::addSource(string path, bool isSegment, const vector<unsigned long long> &lineOffsets) {
+    if (lineOffsets.empty()) {
+        return;
+    }
+    paths.push_back(path);
+    compressed.push_back(isSegment);
+    offsets.push_back(lineOffsets);
+    firstRows.push_back(rows);
+    rows += lineOffsets.size();
+}
+
+/**\brief Hängt Zeilen einer unkomprimierten Logdatei an (z.B. transactionlog.txt)
+ * \param path (Pfad der Logdatei), lineOffsets (Positionen der Zeilen, aufsteigend)
+ */
+void LogView::addLog(string path, const vector<unsigned long long> &lineOffsets) {
+    addSource(path, false, lineOffsets);
+}
+
+/**\brief Hängt Zeilen eines versiegelten Segments an (siehe Segment)
+ * \param path (Pfad der Segmentdatei), lineOffsets (Positionen der Zeilen in der ursprünglichen Logdatei, aufsteigend)
+ */
+void LogView::addSegment(string path, const vector<unsigned long long> &lineOffsets) {
+    addSource(path, true, lineOffsets);
+}
+
+/**\brief Hängt die Zeilen einer unkomprimierten Logdatei aus einem Zeitraum an (siehe addSourceRange)
+ * \param path, fromStamp, toStamp (JJJJMMTThhmmss, jeweils einschließlich), month (JJJJMM der Datei), userPrefix (siehe LogArchive::parseStamp)
+ */
+void LogView::addLogRange(string path, long long fromStamp, long long toStamp, int month, bool userPrefix) {
+    addSourceRange(path, false, fromStamp, toStamp, month, userPrefix);
+}
+
+/**\brief Hängt die Zeilen eines versiegelten Segments aus einem Zeitraum an (siehe addSourceRange)
+ * \param path, fromStamp, toStamp (JJJJMMTThhmmss, jeweils einschließlich), month (JJJJMM des Segments), userPrefix (siehe LogArchive::parseStamp)
+ */
+void LogView::addSegmentRange(string path, long long fromStamp, long long toStamp, int month, bool userPrefix) {
+    addSourceRange(path, true, fromStamp, toStamp, month, userPrefix);
+}
+
+/**\brief Hängt von den übergebenen Zeilen einer unkomprimierten Logdatei nur die aus einem Zeitraum an (z.B. die Zeilen eines Nutzers aus dem Index, siehe limitSource)
+ * \param path, lineOffsets (Positionen der Zeilen, aufsteigend), fromStamp, toStamp (JJJJMMTThhmmss, jeweils einschließlich), month (JJJJMM der Datei), userPrefix (siehe LogArchive::parseStamp)
+ */
+void LogView::addLogRange(string path, const vector<unsigned long long> &lineOffsets, long long fromStamp, long long toStamp, int month, bool userPrefix) {
+    if (lineOffsets.empty()) {
+        return;
+    }
+    addSource(path, false, lineOffsets);
+    limitSource(paths.size() - 1, fromStamp, toStamp, month, userPrefix);
+}
+
+/**\brief Hängt von den übergebenen Zeilen eines versiegelten Segments nur die aus einem Zeitraum an (siehe limitSource)
+ * \param path, lineOffsets (Positionen der Zeilen in der ursprünglichen Logdatei, aufsteigend), fromStamp, toStamp (JJJJMMTThhmmss, jeweils einschließlich), month (JJJJMM des Segments), userPrefix (siehe LogArchive::parseStamp)
+ */
+void LogView::addSegmentRange(string path, const vector<unsigned long long> &lineOffsets, long long fromStamp, long long toStamp, int month, bool userPrefix) {
+    if (lineOffsets.empty()) {
+        return;
+    }
+    addSource(path, true, lineOffsets);
+    limitSource(paths.size() - 1, fromStamp, toStamp, month, userPrefix);
+}
+
+/**\brief Hängt alle Zeilen einer Quelle aus einem Zeitraum an, ohne die ganze Datei zu lesen
+ * Die Zeilen stehen in zeitlicher Reihenfolge. Gesucht wird über die Position in der (ursprünglichen) Logdatei: für eine Position zählt der Zeitstempel der ersten Zeile,
+ * die danach beginnt. Danach werden ab der gefundenen Zeile nur so lange Zeilen gelesen, bis der Zeitraum vorbei ist.
+ * Zeilen ohne lesbaren Zeitstempel (z.B. "---" oder ältere Zeilen "JJJJMMTT-hh:mm:ss") werden nur angehängt, wenn sie zwischen zwei Zeilen des Zeitraums stehen.
+ */
+void LogView::addSourceRange(string path, bool isSegment, long long fromStamp, long long toStamp, int month, bool userPrefix) {
+    paths.push_back(path);
+    compressed.push_back(isSegment);
+    offsets.push_back(vector<unsigned long long>());
+    firstRows.push_back(rows);
+    int source = paths.size() - 1;
+    unsigned long long size = getSize(source);
+    unsigned long long low = 0;
+    unsigned long long high = size;
+    while (low < high) { // kleinste Position, nach der eine Zeile mit Zeitstempel >= fromStamp beginnt
+        unsigned long long middle = low + (high - low) / 2;
+        if (stampAfter(source, middle, size, month, userPrefix) >= fromStamp) {
+            high = middle;
+        }
+        else {
+            low = middle + 1;
+        }
+    }
+    unsigned long long offset = lineStartAfter(source, low);
+    string line;
+    vector<unsigned long long> fUnstamped; // Zeilen ohne Zeitstempel seit der letzten Zeile des Zeitraums
+    while (offset < size && readLine(source, offset, line)) {
+        long long stamp = LogArchive::parseStamp(line, month, userPrefix);
+        if (stamp > toStamp) {
+            break;
+        }
+        if (stamp < 0) {
+            if (!line.empty()) {
+                fUnstamped.push_back(offset);
+            }
+        }
+        else {
+            if (!offsets[source].empty()) {
+                offsets[source].insert(offsets[source].end(), fUnstamped.begin(), fUnstamped.end());
+            }
+            fUnstamped.clear();
+            offsets[source].push_back(offset);
+        }
+        offset += line.size() + 1;
+    }
+    rows += offsets[source].size();
+    removeEmptySource();
+}
+
+/**\brief Beschränkt die gerade angehängte (neueste) Quelle auf einen Zeitraum
+ * Die Grenzen werden per Binärsuche über die gespeicherten Positionen gefunden; gelesen werden nur die Zeilen, die dabei geprüft werden.
+ * Zeilen ohne lesbaren Zeitstempel vor der ersten Zeile des Zeitraums (z.B. ältere Zeilen "JJJJMMTT-hh:mm:ss") werden abgeschnitten.
+ * \param source, fromStamp, toStamp (JJJJMMTThhmmss, jeweils einschließlich), month (JJJJMM der Quelle), userPrefix (siehe LogArchive::parseStamp)
+ */
+void LogView::limitSource(int source, long long fromStamp, long long toStamp, int month, bool userPrefix) {
+    vector<unsigned long long> &lineOffsets = offsets[source];
+    size_t bounds[2];
+    long long stamps[2] = {fromStamp, toStamp + 1};
+    for (int i=0; i < 2; i++) { // erste Zeile mit Zeitstempel >= fromStamp bzw. > toStamp
+        size_t low = i == 0 ? 0 : bounds[0];
+        size_t high = lineOffsets.size();
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (stampOf(source, middle, month, userPrefix) >= stamps[i]) {
+                high = middle;
+            }
+            else {
+                low = middle + 1;
+            }
+        }
+        bounds[i] = low;
+    }
+    string line;
+    while (bounds[0] < bounds[1] && (!readLine(source, lineOffsets[bounds[0]], line) || LogArchive::parseStamp(line, month, userPrefix) < 0)) {
+        bounds[0]++;
+    }
+    rows -= lineOffsets.size();
+    lineOffsets.erase(lineOffsets.begin() + bounds[1], lineOffsets.end());
+    lineOffsets.erase(lineOffsets.begin(), lineOffsets.begin() + bounds[0]);
+    rows += lineOffsets.size();
+    removeEmptySource();
+}
+
+/**\brief Entfernt die zuletzt angehängte Quelle wieder, wenn sie keine Zeilen enthält
+ */
+void LogView::removeEmptySource() {
+    if (paths.empty() || !offsets.back().empty()) {
+        return;
+    }
+    if (openSource == (int) paths.size() - 1) {
+        segment.close();
+        log.close();
+        openSource = -1;
+    }
+    paths.pop_back();
+    compressed.pop_back();
+    offsets.pop_back();
+    firstRows.pop_back();
+}
+
+/**\brief Gibt die Länge der (ursprünglichen) Logdatei einer Quelle zurück
+ * \return unsigned long long (0, wenn die Datei nicht geöffnet werden kann)
+ */
+unsigned long long LogView::getSize(int source) {
+    if (!openFile(source)) {
+        return 0;
+    }
+    if (compressed[source]) {
+        return segment.getRawSize();
+    }
+    log.clear();
+    log.seekg(0, ios::end);
+    return log.tellg();
+}
+
+/**\brief Gibt die Position der ersten Zeile zurück, die bei oder nach position beginnt
+ * \return unsigned long long
+ */
+unsigned long long LogView::lineStartAfter(int source, unsigned long long position) {
+    if (position == 0) {
+        return 0;
+    }
+    string line;
+    if (!readLine(source, position - 1, line)) { // Rest der Zeile, in der position - 1 liegt
+        return position;
+    }
+    return position + line.size();
+}
+
+/**\brief Gibt den Zeitstempel der ersten Zeile mit Zeitstempel zurück, die bei oder nach position beginnt
+ * \return long long (JJJJMMTThhmmss; größer als jeder Zeitstempel, wenn danach keine Zeile mehr kommt)
+ */
+long long LogView::stampAfter(int source, unsigned long long position, unsigned long long size, int month, bool userPrefix) {
+    unsigned long long offset = lineStartAfter(source, position);
+    string line;
+    while (offset < size && readLine(source, offset, line)) {
+        long long stamp = LogArchive::parseStamp(line, month, userPrefix);
+        if (stamp >= 0) {
+            return stamp;
+        }
+        offset += line.size() + 1;
+    }
+    return LLONG_MAX;
+}
+
+/**\brief Gibt den Zeitstempel der Zeile index einer Quelle zurück (ohne Zeitstempel den der nächsten Zeile)
+ * \return long long (JJJJMMTThhmmss; größer als jeder Zeitstempel, wenn danach keine Zeile mehr kommt)
+ */
+long long LogView::stampOf(int source, size_t index, int month, bool userPrefix) {
+    string line;
+    for (; index < offsets[source].size(); index++) {
+        long long stamp = readLine(source, offsets[source][index], line) ? LogArchive::parseStamp(line, month, userPrefix) : -1;
+        if (stamp >= 0) {
+            return stamp;
+        }
+    }
+    return LLONG_MAX;
+}
+
+/**\brief Ermittelt die Positionen aller nicht leeren Zeilen einer unkomprimierten Logdatei
+ * \return vector<unsigned long long> (aufsteigend; leer, wenn die Datei fehlt)
+ */
+vector<unsigned long long> LogView::scanLog(string path) {
+    vector<unsigned long long> lineOffsets;
+    ifstream file;
+    file.open(path, ios::in | ios::binary);
+    unsigned long long offset = 0;
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty()) {
+            lineOffsets.push_back(offset);
+        }
+        offset += line.size() + 1;
+    }
+    file.close();
+    return lineOffsets;
+}
+
+/**\brief Gibt die Anzahl aller Zeilen der Ansicht zurück
+ * \return int
+ */
+int LogView::getRowCount() const {
+    return rows;
+}
+
+/**\brief Öffnet die Datei einer Quelle (die Datei der vorher gelesenen Quelle wird geschlossen)
+ * \return bool (false, wenn die Datei nicht geöffnet werden konnte)
+ */
+bool LogView::openFile(int source) {
+    if (source == openSource) {
+        return true;
+    }
+    segment.close();
+    log.close();
+    log.clear();
+    bool opened;
+    if (compressed[source]) {
+        opened = segment.open(paths[source]);
+    }
+    else {
+        log.open(paths[source], ios::in | ios::binary);
+        opened = log.is_open();
+    }
+    openSource = opened ? source : -1;
+    return opened;
+}
+
+/**\brief Liest eine Zeile aus einer Quelle; die Datei der Quelle bleibt für die nächsten Zeilen geöffnet
+ * \return bool (false, wenn die Zeile nicht gelesen werden konnte, z.B. weil die Logdatei inzwischen versiegelt wurde)
+ */
+bool LogView::readLine(int source, unsigned long long offset, string &line) {
+    if (!openFile(source)) {
+        return false;
+    }
+    if (compressed[source]) {
+        return segment.readLine(offset, line);
+    }
+    log.clear();
+    log.seekg(offset);
+    return (bool) getline(log, line);
+}
+
+/**\brief Liest mehrere aufeinanderfolgende Zeilen, neueste zuerst
+ * \param first (Nummer der ersten Zeile, 0 = neueste), count (Anzahl der Zeilen)
+ * \return vector<string> (Zeilen, die nicht mehr gelesen werden können, bleiben leer)
+ */
+vector<string> LogView::readRows(int first, int count) {
+    vector<string> fRows;
+    for (int row = first; row < first + count && row < rows; row++) {
+        int chronological = rows - 1 - row;
+        int source = upper_bound(firstRows.begin(), firstRows.end(), chronological) - firstRows.begin() - 1;
+        string line;
+        readLine(source, offsets[source][chronological - firstRows[source]], line);
+        fRows.push_back(line);
+    }
+    return fRows;
+}
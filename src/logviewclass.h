@@ -0,0 +1,42 @@
+#include "includes.h"
+
+/**\brief Klasse "LogViewclass" für das seitenweise Lesen von Logzeilen (z.B. für die Historie)
+ * Eine Ansicht besteht aus mehreren Quellen (versiegelte Segmente und die aktive Logdatei, älteste zuerst), zu denen jeweils nur die Positionen der anzuzeigenden Zeilen gespeichert werden.
+ * Gelesen wird erst, wenn eine Zeile tatsächlich angezeigt werden soll; die neueste Zeile hat die Nummer 0.
+ * Das Öffnen einer Ansicht kostet also unabhängig von der Anzahl der Zeilen fast nichts, und jede Seite liest nur die Zeilen, die auf ihr stehen.
+ * Für Zeiträume (z.B. history <Nutzer> <von> <bis>) wird die erste passende Zeile einer Quelle per Binärsuche über die Zeitstempel gefunden (siehe LogArchive::parseStamp);
+ * gelesen werden dann nur die Zeilen des Zeitraums und eine Handvoll Zeilen für die Suche.
+ */
+class LogView {
+private:
+    vector<string> paths; // Datei jeder Quelle
+    vector<bool> compressed; // true, wenn die Quelle ein Segment ist
+    vector<vector<unsigned long long> > offsets; // Positionen der Zeilen jeder Quelle (aufsteigend)
+    vector<int> firstRows; // Anzahl der Zeilen in allen älteren Quellen
+    int rows;
+    int openSource; // Quelle, die gerade geöffnet ist, -1 wenn keine
+    Segment segment;
+    ifstream log;
+    void addSource(string path, bool isSegment, const vector<unsigned long long> &lineOffsets);
+    void addSourceRange(string path, bool isSegment, long long fromStamp, long long toStamp, int month, bool userPrefix);
+    void limitSource(int source, long long fromStamp, long long toStamp, int month, bool userPrefix);
+    void removeEmptySource();
+    bool openFile(int source);
+    unsigned long long getSize(int source);
+    unsigned long long lineStartAfter(int source, unsigned long long position);
+    long long stampAfter(int source, unsigned long long position, unsigned long long size, int month, bool userPrefix);
+    long long stampOf(int source, size_t index, int month, bool userPrefix);
+    bool readLine(int source, unsigned long long offset, string &line);
+public:
+    LogView();
+    void clear();
+    void addLog(string path, const vector<unsigned long long> &lineOffsets);
+    void addSegment(string path, const vector<unsigned long long> &lineOffsets);
+    void addLogRange(string path, long long fromStamp, long long toStamp, int month, bool userPrefix);
+    void addSegmentRange(string path, long long fromStamp, long long toStamp, int month, bool userPrefix);
+    void addLogRange(string path, const vector<unsigned long long> &lineOffsets, long long fromStamp, long long toStamp, int month, bool userPrefix);
+    void addSegmentRange(string path, const vector<unsigned long long> &lineOffsets, long long fromStamp, long long toStamp, int month, bool userPrefix);
+    static vector<unsigned long long> scanLog(string path);
+    int getRowCount() const;
+    vector<string> readRows(int first, int count);
+};
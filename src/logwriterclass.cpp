@@ -0,0 +1,205 @@
+#include "includes.h"
+#include "headers.h"
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**\brief Konstruktor für LogWriter-Objekte
+ * Die Datei wird erst beim ersten commit() geöffnet. Standardmäßig wird jede Gruppe mit einem fsync gesichert.
+ */
+LogWriter::LogWriter() {
+    fd = -1;
+    durability = PerBatch;
+    repairSize = -1;
+    resetStats();
+}
+
+/**\brief Destruktor: schreibt noch gesammelte Zeilen und schließt die Datei
+ */
+LogWriter::~LogWriter() {
+    commit();
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/**\brief Setzt den Pfad der Datei; eine bereits geöffnete Datei wird vorher geschlossen
+ * \param nPath (Pfad der Logdatei)
+ */
+void LogWriter::setPath(string nPath) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    path = nPath;
+    repairSize = -1;
+}
+
+/**\brief Setzt die Durability (0 = kein fsync, 1 = fsync pro Gruppe, 2 = fsync pro Zeile)
+ * Ungültige Werte werden ignoriert.
+ */
+void LogWriter::setDurability(int nDurability) {
+    if (nDurability >= None && nDurability <= PerRecord) {
+        durability = nDurability;
+    }
+}
+
+/**\brief Öffnet die Datei zum Anhängen, falls das noch nicht geschehen ist
+ * \return bool (false, wenn die Datei nicht geöffnet werden konnte)
+ */
+bool LogWriter::openFile() {
+    if (fd < 0) {
+        fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    }
+    return fd >= 0;
+}
+
+/**\brief Schreibt den kompletten Inhalt, auch wenn write() nur einen Teil auf einmal annimmt
+ * \return bool (false bei einem Schreibfehler)
+ */
+bool LogWriter::writeAll(const string &data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t result = write(fd, data.data() + written, data.size() - written);
+        if (result < 0) {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+/**\brief Schneidet die Datei nach einem fehlgeschlagenen Schreibvorgang auf die letzte gültige Größe zurück (halbe Zeilen am Ende entfernen)
+ * Gelingt das nicht sofort, wird es vor dem nächsten Schreiben erneut versucht (siehe repair).
+ * \param size (Größe nach der letzten vollständig geschriebenen Zeile)
+ */
+void LogWriter::truncateTo(long long size) {
+    repairSize = size;
+    repair();
+}
+
+/**\brief Holt ein noch ausstehendes Zurückschneiden nach (siehe truncateTo)
+ * \return bool (false, wenn die Datei noch immer nicht zurückgeschnitten werden konnte; dann darf nichts angehängt werden)
+ */
+bool LogWriter::repair() {
+    if (repairSize < 0) {
+        return true;
+    }
+    if (!openFile() || ftruncate(fd, repairSize) != 0) {
+        return false;
+    }
+    repairSize = -1;
+    return true;
+}
+
+/**\brief Sammelt eine Zeile für den nächsten commit()
+ * \param line (Zeile ohne Zeilenumbruch)
+ */
+void LogWriter::add(string line) {
+    pending.push_back(line);
+}
+
+/**\brief Gibt die aktuelle Größe der Datei zurück (Position, an der die nächste Zeile landet)
+ * \return long long (Größe in Byte; -1, wenn die Datei nicht geöffnet werden konnte)
+ */
+long long LogWriter::getSize() {
+    struct stat info;
+    if (!openFile() || !repair() || fstat(fd, &info) != 0) {
+        return -1;
+    }
+    return info.st_size;
+}
+
+/**\brief Hängt alle gesammelten Zeilen an die Datei an (Group Commit)
+ * Je nach Durability wird einmal pro Gruppe oder nach jeder Zeile fsync aufgerufen. Dauer und Gruppengröße fließen in die Statistik ein.
+ * Bei einem Fehler wird die Datei auf die Größe nach der letzten vollständig geschriebenen Zeile zurückgeschnitten: mit PerRecord bleiben die bis dahin
+ * geschriebenen Zeilen in der Datei und werden aus der Sammlung entfernt, sonst wird die ganze Gruppe beim nächsten commit() erneut geschrieben.
+ * \return bool (false, wenn die Datei nicht geöffnet oder geschrieben werden konnte; die nicht geschriebenen Zeilen bleiben dann gesammelt, siehe getPendingCount)
+ */
+bool LogWriter::commit() {
+    if (pending.empty()) {
+        return true;
+    }
+    long long size = getSize(); // holt auch ein ausstehendes Zurückschneiden nach
+    if (size < 0) {
+        return false;
+    }
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    bool success = true;
+    size_t written = 0; // Zeilen, die vollständig (und je nach Durability gesichert) in der Datei stehen
+    if (durability == PerRecord) {
+        for (; written < pending.size(); written++) {
+            string line = pending[written] + "\n";
+            success = writeAll(line) && fsync(fd) == 0;
+            if (!success) {
+                break;
+            }
+            size += line.size();
+        }
+    }
+    else {
+        string batch;
+        for (int i=0; i < pending.size(); i++) {
+            batch += pending[i];
+            batch += "\n";
+        }
+        success = writeAll(batch);
+        if (success && durability == PerBatch) {
+            success = fsync(fd) == 0;
+        }
+        written = success ? pending.size() : 0;
+    }
+    if (!success) {
+        truncateTo(size);
+    }
+    if (written > 0) {
+        unsigned long latency = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+        lock_guard<mutex> lock(statsMutex);
+        stats.commits++;
+        stats.records += written;
+        stats.maxBatch = max(stats.maxBatch, (unsigned long) written);
+        stats.totalLatency += latency;
+        stats.maxLatency = max(stats.maxLatency, latency);
+    }
+    pending.erase(pending.begin(), pending.begin() + written);
+    return success;
+}
+
+/**\brief Verwirft alle gesammelten Zeilen und leert die Datei
+ * \return bool (false, wenn die Datei nicht geleert werden konnte)
+ */
+bool LogWriter::reset() {
+    pending.clear();
+    repairSize = -1;
+    if (!openFile()) {
+        return false;
+    }
+    return ftruncate(fd, 0) == 0;
+}
+
+/**\brief Gibt die Anzahl der gesammelten, noch nicht geschriebenen Zeilen zurück
+ * \return int
+ */
+int LogWriter::getPendingCount() {
+    return pending.size();
+}
+
+/**\brief Gibt eine Kopie der Statistik zurück (darf aus jedem Thread aufgerufen werden)
+ * \return LogWriterStats
+ */
+LogWriterStats LogWriter::getStats() {
+    lock_guard<mutex> lock(statsMutex);
+    return stats;
+}
+
+/**\brief Setzt die Statistik zurück
+ */
+void LogWriter::resetStats() {
+    lock_guard<mutex> lock(statsMutex);
+    stats.commits = 0;
+    stats.records = 0;
+    stats.maxBatch = 0;
+    stats.totalLatency = 0;
+    stats.maxLatency = 0;
+}
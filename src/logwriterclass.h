@@ -0,0 +1,47 @@
+#include "includes.h"
+
+/**\brief Kennzahlen eines LogWriters (für das Admin-Kommando "logstats")
+ */
+struct LogWriterStats {
+    unsigned long commits; // Anzahl der Schreibvorgänge (Gruppen)
+    unsigned long records; // Anzahl aller geschriebenen Zeilen
+    unsigned long maxBatch; // größte Gruppe in Zeilen
+    unsigned long totalLatency; // Summe der Dauer aller Schreibvorgänge in Mikrosekunden
+    unsigned long maxLatency; // längster Schreibvorgang in Mikrosekunden
+};
+
+/**\brief Klasse "LogWriterclass" für das gruppierte Anhängen von Zeilen an eine Datei (Group Commit)
+ * Die Datei bleibt dauerhaft geöffnet. Zeilen werden zuerst mit add() gesammelt und erst mit commit() in einem einzigen write() angehängt.
+ * Wie sicher die Zeilen danach auf der SD-Karte liegen, bestimmt die Durability:
+ *      0 (None)       kein fsync, das Betriebssystem schreibt irgendwann selbst
+ *      1 (PerBatch)   ein fsync pro Gruppe
+ *      2 (PerRecord)  jede Zeile wird einzeln geschrieben und mit fsync gesichert
+ * Schlägt ein Schreibvorgang fehl, wird die Datei auf die Größe nach der letzten vollständig geschriebenen Zeile zurückgeschnitten; bereits geschriebene Zeilen werden nie ein zweites Mal angehängt.
+ */
+class LogWriter {
+private:
+    string path;
+    int fd; // Dateideskriptor, -1 solange die Datei nicht geöffnet ist
+    int durability;
+    vector<string> pending; // gesammelte, noch nicht geschriebene Zeilen
+    long long repairSize; // nach einem Fehler: auf diese Größe muss die Datei noch zurückgeschnitten werden, sonst -1
+    mutex statsMutex;
+    LogWriterStats stats;
+    bool openFile();
+    bool writeAll(const string &data);
+    bool repair();
+    void truncateTo(long long size);
+public:
+    enum Durability { None = 0, PerBatch = 1, PerRecord = 2 };
+    LogWriter();
+    ~LogWriter();
+    void setPath(string nPath);
+    void setDurability(int nDurability);
+    void add(string line);
+    bool commit();
+    bool reset();
+    int getPendingCount();
+    long long getSize();
+    LogWriterStats getStats();
+    void resetStats();
+};
@@ -1,12 +1,16 @@
 #include "userwindow.h"
 #include <QApplication>
+#include <QElapsedTimer>
 #include "includes.h"
 //#include "headers.h"
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer; // misst den Start bis zum ersten Bild (siehe Kommando stats)
+    startupTimer.start();
     QApplication a(argc, argv);
     userwindow w;
+    w.setStartupTimer(startupTimer);
     w.show();
 
     return a.exec();
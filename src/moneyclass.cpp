@@ -0,0 +1,146 @@
+#include "includes.h"
+#include "headers.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+/**\brief Wandelt einen double-Betrag in Cent um (kaufmännisch gerundet)
+ * Wird nur noch für Werte aus älteren Snapshots benötigt.
+ * \param value (Betrag in Euro)
+ * \return Money
+ */
+Money Money::fromDouble(double value) {
+    return fromCents(llround(value * 100));
+}
+
+/**\brief Liest einen Betrag aus einem Text, ohne Speicher anzulegen
+ * Erlaubt sind ein Vorzeichen, "." oder "," als Dezimaltrennzeichen und Leerzeichen/Tabs davor und danach.
+ * Mehr als zwei Nachkommastellen werden kaufmännisch auf Cent gerundet (ältere Logs enthalten z.B. "29.199999999999").
+ * Werte in Exponentialschreibweise (z.B. "2.77556e-17" aus älteren Textdatenbanken) werden ebenfalls akzeptiert.
+ * \param text, length (Zeichen, müssen nicht nullterminiert sein), result (bleibt bei einem Fehler unverändert)
+ * \return bool (false, wenn der Text kein gültiger Betrag ist)
+ */
+bool Money::parse(const char *text, size_t length, Money &result) {
+    size_t pos = 0;
+    while (pos < length && (text[pos] == ' ' || text[pos] == '\t')) {
+        pos++;
+    }
+    while (length > pos && (text[length-1] == ' ' || text[length-1] == '\t' || text[length-1] == '\r')) {
+        length--;
+    }
+    size_t start = pos;
+    bool negative = false;
+    if (pos < length && (text[pos] == '-' || text[pos] == '+')) {
+        negative = text[pos] == '-';
+        pos++;
+    }
+    long long value = 0;
+    int digits = 0;
+    while (pos < length && text[pos] >= '0' && text[pos] <= '9') {
+        if (value > 9000000000000000LL) { // würde bei *100 überlaufen
+            return false;
+        }
+        value = value * 10 + (text[pos] - '0');
+        pos++;
+        digits++;
+    }
+    value *= 100;
+    if (pos < length && (text[pos] == '.' || text[pos] == ',')) {
+        pos++;
+        int decimals = 0;
+        while (pos < length && text[pos] >= '0' && text[pos] <= '9') {
+            if (decimals == 0) {
+                value += (text[pos] - '0') * 10;
+            }
+            else if (decimals == 1) {
+                value += text[pos] - '0';
+            }
+            else if (decimals == 2 && text[pos] >= '5') {
+                value += 1;
+            }
+            pos++;
+            decimals++;
+            digits++;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (pos < length && (text[pos] == 'e' || text[pos] == 'E')) { // Exponentialschreibweise über strtod
+        char buffer[64];
+        if (length - start >= sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer, text + start, length - start);
+        buffer[length - start] = '\0';
+        for (size_t i=0; buffer[i] != '\0'; i++) {
+            if (buffer[i] == ',') {
+                buffer[i] = '.';
+            }
+        }
+        char *end;
+        double exponential = strtod(buffer, &end);
+        if (*end != '\0' || !std::isfinite(exponential) || fabs(exponential) > 9e16) {
+            return false;
+        }
+        result = fromDouble(exponential);
+        return true;
+    }
+    if (pos != length) {
+        return false;
+    }
+    result = fromCents(negative ? -value : value);
+    return true;
+}
+
+/**\brief Liest einen Betrag aus einem string (siehe parse(const char*, size_t, Money&))
+ * \return bool (false, wenn der Text kein gültiger Betrag ist)
+ */
+bool Money::parse(const string &text, Money &result) {
+    return parse(text.data(), text.size(), result);
+}
+
+/**\brief Schreibt den Betrag mit zwei Nachkommastellen in einen Puffer, ohne Speicher anzulegen
+ * \param buffer (mindestens Money::bufferSize Zeichen; wird nullterminiert)
+ * \return int (Anzahl der geschriebenen Zeichen ohne Nullterminator)
+ */
+int Money::format(char *buffer) const {
+    unsigned long long magnitude = cents < 0 ? 0ULL - (unsigned long long) cents : (unsigned long long) cents;
+    char reversed[Money::bufferSize];
+    int count = 0;
+    reversed[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+    reversed[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+    reversed[count++] = '.';
+    do {
+        reversed[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    int length = 0;
+    if (cents < 0) {
+        buffer[length++] = '-';
+    }
+    while (count > 0) {
+        buffer[length++] = reversed[--count];
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+/**\brief Gibt den Betrag mit zwei Nachkommastellen als string zurück (z.B. "29.20")
+ * \return string
+ */
+string Money::toString() const {
+    char buffer[Money::bufferSize];
+    int length = format(buffer);
+    return string(buffer, length);
+}
+
+/**\brief Schreibt einen Betrag mit zwei Nachkommastellen in einen Stream (z.B. für die Logs)
+ */
+ostream &operator<<(ostream &out, Money money) {
+    char buffer[Money::bufferSize];
+    int length = money.format(buffer);
+    return out.write(buffer, length);
+}
@@ -0,0 +1,37 @@
+#include "includes.h"
+
+/**\brief Klasse "Moneyclass" für Geldbeträge als Festkommazahl
+ * Ein Betrag wird als ganze Zahl von Cent (int64) gespeichert. Summen über beliebig viele Buchungen sind also exakt; Kassenstand und die Summe der Einzahlungen können nicht durch Rundungsfehler auseinanderlaufen.
+ * Die Rechenoperationen stehen direkt im Header, damit der Compiler Schleifen über viele Beträge wie normale Ganzzahlsummen optimieren (und vektorisieren) kann.
+ * Formatieren und Parsen arbeiten auf einem Zeichenpuffer und legen keinen Speicher an. Geschrieben wird immer mit zwei Nachkommastellen ("29.20", "-0.80");
+ * gelesen werden auch ältere Werte aus den Textdatenbanken und Logs ("29.2", "12,5", "2.77556e-17").
+ */
+class Money {
+private:
+    long long cents;
+public:
+    static const int bufferSize = 24; // reicht für jeden int64-Betrag inkl. Vorzeichen, Punkt und Nullterminator
+    Money() { cents = 0; }
+    static Money fromCents(long long nCents) { Money money; money.cents = nCents; return money; }
+    static Money fromDouble(double value);
+    long long getCents() const { return cents; }
+    double toDouble() const { return cents / 100.0; }
+    Money operator+(Money other) const { return fromCents(cents + other.cents); }
+    Money operator-(Money other) const { return fromCents(cents - other.cents); }
+    Money operator-() const { return fromCents(-cents); }
+    Money operator*(long long factor) const { return fromCents(cents * factor); }
+    Money &operator+=(Money other) { cents += other.cents; return *this; }
+    Money &operator-=(Money other) { cents -= other.cents; return *this; }
+    bool operator==(Money other) const { return cents == other.cents; }
+    bool operator!=(Money other) const { return cents != other.cents; }
+    bool operator<(Money other) const { return cents < other.cents; }
+    bool operator<=(Money other) const { return cents <= other.cents; }
+    bool operator>(Money other) const { return cents > other.cents; }
+    bool operator>=(Money other) const { return cents >= other.cents; }
+    static bool parse(const char *text, size_t length, Money &result);
+    static bool parse(const string &text, Money &result);
+    int format(char *buffer) const;
+    string toString() const;
+};
+
+ostream &operator<<(ostream &out, Money money);
@@ -0,0 +1,697 @@
+#include "includes.h"
+#include "headers.h"
+#include <chrono>
+#include <algorithm>
+#include <ctime>
+
+/**\brief Bestimmt den Zeitpunkt einer Logzeile aus ihrem Zeitstempel (siehe PosEngine::logStamp)
+ * Da die Zeitstempel nie rückwärts laufen, landet eine Zeile so auch nach dem Zurückstellen der Uhr im richtigen Monatssegment und im Spaltenspeicher bei derselben Zeit wie nach einem Neuaufbau.
+ * \param line, userPrefix (true bei depositlog.txt, siehe LogArchive::parseStamp), fallback (Unixzeit, falls die Zeile keinen vollen Zeitstempel hat)
+ * \return long long (Unixzeit)
+ */
+static long long lineTime(const string &line, bool userPrefix, long long fallback) {
+    long long stamp = LogArchive::parseStamp(line, 0, userPrefix);
+    if (stamp < 10000000000000LL) { // kein oder nur ein kurzer Zeitstempel ohne Jahr
+        return fallback;
+    }
+    int day = stamp / 1000000;
+    int clock = stamp % 1000000;
+    return ColumnStore::dayStart(day / 10000, day / 100 % 100, day % 100) + (clock / 10000) * 3600 + (clock / 100 % 100) * 60 + clock % 100;
+}
+
+static const int journalCompactionThreshold = 500; // ab so vielen Journaleinträgen wird ein neuer Snapshot geschrieben
+static const chrono::milliseconds groupCommitWindow(10); // so lange wird nach dem ersten Datensatz einer Gruppe auf weitere gewartet
+static const unsigned long groupCommitMaxRecords = 1000; // größere Gruppen werden vorzeitig geschrieben
+
+/**\brief Liest die NutzerID aus einer Zeile von depositlog.txt
+ * Die TransaktionsID am Zeilenanfang besteht aus der NutzerID und dem Zeitpunkt "JJJJMMTThhmmss" (in älteren Zeilen "MMddhhmm", z.B. "030705122046 | Fritz | +20 | 125.5").
+ * \return int (NutzerID; -1, wenn die Zeile keine Einzahlung ist)
+ */
+static int parseDepositUserID(const string &line) {
+    size_t posFD = line.find(" | ");
+    size_t stampDigits = posFD != string::npos && posFD >= 16 ? 14 : 8; // JJJJMMTThhmmss, in älteren Zeilen MMddhhmm (siehe LogArchive::parseStamp)
+    if (posFD == string::npos || posFD <= stampDigits) {
+        return -1;
+    }
+    int userID = 0;
+    for (size_t i = 0; i < posFD; i++) {
+        if (line[i] < '0' || line[i] > '9') {
+            return -1;
+        }
+        if (i < posFD-stampDigits) {
+            userID = userID * 10 + (line[i] - '0');
+        }
+    }
+    return userID;
+}
+
+/**\brief Konstruktor für Persistence-Objekte
+ * Der Schreib-Thread wird erst mit start() gestartet, nachdem der gespeicherte Stand gelesen wurde.
+ */
+Persistence::Persistence() {
+    transactionLog.setPath("transactionlog.txt");
+    transactionIndex.setPaths("transactionlog.txt", "transactionlog.idx");
+    transactionArchive.setPaths("transactionlog", "transactionlog.txt", "transactionlog.idx", LogIndex::parseUserID);
+    depositArchive.setPaths("depositlog", "depositlog.txt", "", parseDepositUserID);
+    depositLog.setPath("depositlog.txt");
+    deletionLog.setPath("deletionlog.txt");
+    submitted = 0;
+    applied = 0;
+    failures = 0;
+    stopping = false;
+    snapshotPending = false;
+    logsLoaded = false;
+    logLoadTime = 0;
+}
+
+/**\brief Destruktor: schreibt noch alle ausstehenden Änderungen und beendet den Schreib-Thread
+ */
+Persistence::~Persistence() {
+    stop();
+}
+
+/**\brief Prüft, ob bereits ein Snapshot existiert (auch wenn er nicht lesbar ist)
+ * \return bool
+ */
+bool Persistence::hasSnapshot() {
+    return snapshot.exists();
+}
+
+/**\brief Liest den binären Snapshot (siehe Snapshot::read)
+ * \return bool (false, wenn kein gültiger Snapshot vorhanden ist)
+ * \warning Nur vor start() aufrufen!
+ */
+bool Persistence::readSnapshot(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    return snapshot.read(fUsers, fBeverages, fSystem);
+}
+
+/**\brief Wendet das Journal mit allen Änderungen seit dem letzten Snapshot an (siehe Journal::replay)
+ * Ein Journal, das laut Kopfzeile nicht zum gelesenen Snapshot gehört, wird nicht angewendet und beim Start geleert.
+ * \return int (Anzahl der angewendeten Einträge)
+ * \warning Nur vor start() aufrufen!
+ */
+int Persistence::replayJournal(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    return journal.replay(fUsers, fBeverages, fSystem, snapshot.getGeneration());
+}
+
+/**\brief Startet den Schreib-Thread
+ * Der übergebene Stand wird als bereits gesichert übernommen. Existiert noch kein Snapshot (z.B. direkt nach dem Import der Textdatenbanken), wird sofort einer geschrieben.
+ * Die Manifeste der Logs, der Index von transactionlog.txt und der Spaltenspeicher werden erst im Schreib-Thread geladen (siehe loadLogs),
+ * start() kehrt also sofort zurück und die Oberfläche kann schon bedient werden; Verkäufe warten solange in der Warteschlange.
+ */
+void Persistence::start(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    users = fUsers;
+    beverages = fBeverages;
+    system = fSystem;
+    setDurability(system.getDurability());
+    if (!journal.isCurrent() && !journal.clear(snapshot.getGeneration())) { // leeres oder fremdes Journal: neue Einträge brauchen die Kopfzeile dieses Snapshots
+        failures++;
+        snapshotPending = true;
+    }
+    bool snapshotMissing = !snapshot.exists();
+    worker = std::thread(&Persistence::run, this);
+    if (snapshotMissing) {
+        saveSnapshot(fUsers, fBeverages, fSystem);
+    }
+}
+
+/**\brief Arbeitet alle ausstehenden Änderungen ab und beendet danach den Schreib-Thread
+ */
+void Persistence::stop() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+/**\brief Lädt die Manifeste der Logs, den Index von transactionlog.txt und den Spaltenspeicher (und baut sie, falls nötig, neu auf bzw. ergänzt sie)
+ * Läuft als Erstes im Schreib-Thread, bevor die Warteschlange abgearbeitet wird. Bis dahin wartet flush(), damit Historie, Einzahlungsliste und Auswertungen nie auf halb geladene Logs zugreifen.
+ */
+void Persistence::loadLogs() {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int loadFailures = 0;
+    if (!transactionArchive.load()) {
+        loadFailures++;
+    }
+    if (!depositArchive.load()) {
+        loadFailures++;
+    }
+    transactionIndex.load();
+    if (!columns.load() || !catchUpColumns()) {
+        rebuildColumns();
+    }
+    lock_guard<mutex> lock(queueMutex);
+    failures += loadFailures;
+    logsLoaded = true;
+    logLoadTime = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    recordsApplied.notify_all();
+}
+
+/**\brief Hauptschleife des Schreib-Threads
+ * Nimmt die Datensätze in der Reihenfolge aus der Warteschlange, in der sie übergeben wurden. Geschrieben wird ohne gehaltene Sperre, damit der GUI-Thread nie auf die SD-Karte warten muss.
+ * Nach dem ersten Datensatz einer Gruppe wird noch kurz (groupCommitWindow) auf weitere gewartet; danach werden Journal und Logs gemeinsam geschrieben (Group Commit).
+ * Erst dann gelten die Datensätze der Gruppe als abgearbeitet, d.h. flush() kehrt erst zurück, wenn sie mit der eingestellten Durability geschrieben wurden.
+ */
+void Persistence::run() {
+    loadLogs();
+    unique_lock<mutex> lock(queueMutex);
+    while (true) {
+        queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) { // stopping und nichts mehr zu tun
+            break;
+        }
+        chrono::steady_clock::time_point windowEnd = chrono::steady_clock::now() + groupCommitWindow;
+        unsigned long batch = 0;
+        int batchFailures = 0;
+        do {
+            while (!queue.empty() && batch < groupCommitMaxRecords) {
+                ChangeRecord record = queue.front();
+                queue.pop_front();
+                lock.unlock();
+                if (!apply(record)) {
+                    batchFailures++;
+                }
+                lock.lock();
+                batch++;
+            }
+        } while (!stopping && batch < groupCommitMaxRecords && queueChanged.wait_until(lock, windowEnd, [this]() { return stopping || !queue.empty(); }));
+        lock.unlock();
+        if (!commitLogs()) {
+            batchFailures++;
+        }
+        lock.lock();
+        failures += batchFailures;
+        applied += batch;
+        recordsApplied.notify_all();
+    }
+    if (snapshotPending && !writeSnapshot()) { // letzter Versuch, sonst fehlen die zurückgehaltenen Journaleinträge beim nächsten Start
+        failures++;
+    }
+}
+
+/**\brief Schreibt die gesammelten Zeilen von Journal, transactionlog.txt und depositlog.txt (läuft im Schreib-Thread)
+ * Ist noch ein Snapshot ausstehend (siehe apply), wird er vorher erneut versucht; er enthält dann auch alle zurückgehaltenen Journaleinträge.
+ * \return bool (false, wenn mindestens eine Datei nicht geschrieben werden konnte)
+ */
+bool Persistence::commitLogs() {
+    bool snapshotWritten = !snapshotPending || writeSnapshot();
+    bool journalCommitted = journal.commit();
+    bool transactionsCommitted = commitTransactionLog();
+    bool depositsCommitted = depositLog.commit();
+    bool deletionsCommitted = deletionLog.commit();
+    return snapshotWritten && journalCommitted && transactionsCommitted && depositsCommitted && deletionsCommitted;
+}
+
+/**\brief Schreibt die gesammelten Zeilen von transactionlog.txt und trägt sie in Index und Spaltenspeicher ein (läuft im Schreib-Thread)
+ * Die neuen Zeilen landen direkt hintereinander am Dateiende; ihre Positionen ergeben sich also aus der Dateigröße vor dem Schreiben und den Zeilenlängen.
+ * Schlägt das Schreiben fehl, werden nur die Zeilen eingetragen, die tatsächlich in der Datei stehen (siehe LogWriter::commit); die übrigen folgen mit dem nächsten Versuch.
+ * Der Spaltenspeicher vermerkt danach die neue Größe der Logdatei, damit beim nächsten Start genau die Zeilen dahinter nachgetragen werden (siehe catchUpColumns).
+ * \return bool (false, wenn Logdatei, Index oder Spaltenspeicher nicht geschrieben werden konnten)
+ */
+bool Persistence::commitTransactionLog() {
+    long long transactionLogSize = transactionLog.getSize();
+    bool logCommitted = transactionLog.commit();
+    size_t written = pendingTransactions.size() - min(pendingTransactions.size(), (size_t) transactionLog.getPendingCount());
+    if (written == 0) {
+        return logCommitted;
+    }
+    bool indexCommitted = true;
+    if (transactionLogSize >= 0) {
+        unsigned long long offset = transactionLogSize;
+        for (size_t i=0; i < written; i++) {
+            transactionIndex.add(pendingTransactions[i].userID, offset, pendingTransactions[i].line.size() + 1);
+            offset += pendingTransactions[i].line.size() + 1;
+        }
+        indexCommitted = transactionIndex.commit();
+    }
+    for (size_t i=0; i < written; i++) {
+        columns.add(pendingTransactions[i].timestamp, pendingTransactions[i].line);
+    }
+    pendingTransactions.erase(pendingTransactions.begin(), pendingTransactions.begin() + written); // ohne bekannte Position wird der Index beim nächsten Start ergänzt
+    bool columnsCommitted = columns.commit(activeTransactionMonth(), transactionLog.getSize());
+    return logCommitted && columnsCommitted && indexCommitted;
+}
+
+/**\brief Gibt den Monat der aktiven transactionlog.txt zurück
+ * \return int (JJJJMM; wurde noch nichts geschrieben, stammt die Logdatei aus dem aktuellen Monat)
+ */
+int Persistence::activeTransactionMonth() {
+    int activeMonth = transactionArchive.getActiveMonth();
+    if (activeMonth == 0) {
+        activeMonth = LogArchive::monthOf(time(nullptr));
+    }
+    return activeMonth;
+}
+
+/**\brief Trägt die Zeilen von transactionlog.txt nach, die seit dem letzten Schreiben des Spaltenspeichers dazugekommen sind (z.B. nach einem Absturz zwischen Log und Spaltendatei)
+ * Eine letzte Zeile ohne Zeilenumbruch (wird vermutlich gerade geschrieben) wird nicht eingetragen.
+ * \return bool (false, wenn der Spaltenspeicher nicht zur Logdatei passt, z.B. nach einem Monatswechsel oder wenn die Logdatei ersetzt oder gekürzt wurde; dann muss er neu aufgebaut werden)
+ * \warning Nur vor dem Start des Schreib-Threads aufrufen!
+ */
+bool Persistence::catchUpColumns() {
+    int activeMonth = activeTransactionMonth();
+    unsigned long long offset = columns.getCoveredSize();
+    long long logSize = transactionLog.getSize();
+    if (columns.getCoveredMonth() != activeMonth || logSize < 0 || offset > (unsigned long long) logSize) {
+        return false;
+    }
+    if (offset == (unsigned long long) logSize) {
+        return true;
+    }
+    ifstream transactionlog;
+    transactionlog.open("transactionlog.txt", ios::in | ios::binary);
+    if (!transactionlog.is_open()) {
+        return false;
+    }
+    transactionlog.seekg(offset);
+    string transaction;
+    while (getline(transactionlog, transaction)) {
+        if (transactionlog.eof()) { // kein Zeilenumbruch am Ende
+            break;
+        }
+        columns.addLogLine(activeMonth, transaction);
+        offset += transaction.size() + 1;
+    }
+    transactionlog.close();
+    return columns.commit(activeMonth, offset);
+}
+
+/**\brief Baut den Spaltenspeicher aus allen versiegelten Segmenten und der aktiven Logdatei neu auf (z.B. beim ersten Start mit Spaltenspeicher)
+ * \return bool (false, wenn der Spaltenspeicher nicht geschrieben werden konnte)
+ * \warning Nur vor dem Start des Schreib-Threads aufrufen!
+ */
+bool Persistence::rebuildColumns() {
+    if (!columns.clear()) {
+        return false;
+    }
+    vector<LogSegmentInfo> fSegments = transactionArchive.getSegments(0, 999999);
+    for (int i=0; i < fSegments.size(); i++) {
+        Segment segment;
+        vector<unsigned long long> lineOffsets;
+        if (segment.open(fSegments[i].file) && segment.readLineOffsets(lineOffsets)) {
+            for (int j=0; j < lineOffsets.size(); j++) {
+                string transaction;
+                if (segment.readLine(lineOffsets[j], transaction)) {
+                    columns.addLogLine(fSegments[i].month, transaction);
+                }
+            }
+        }
+    }
+    int activeMonth = activeTransactionMonth();
+    ifstream transactionlog;
+    transactionlog.open("transactionlog.txt", ios::in | ios::binary);
+    unsigned long long offset = 0;
+    string transaction;
+    while (getline(transactionlog, transaction)) {
+        if (!transactionlog.eof()) { // kein Zeilenumbruch am Ende: wird vermutlich gerade geschrieben
+            columns.addLogLine(activeMonth, transaction);
+            offset += transaction.size() + 1;
+        }
+    }
+    transactionlog.close();
+    return columns.commit(activeMonth, offset);
+}
+
+/**\brief Versiegelt transactionlog.txt, wenn die nächste Zeile zu einem neuen Monat gehört (läuft im Schreib-Thread)
+ * Die bereits gesammelten Zeilen des alten Monats werden vorher noch geschrieben.
+ * \param time (Zeitpunkt der nächsten Zeile)
+ * \return bool (false, wenn nicht versiegelt werden konnte; die Zeile landet dann trotzdem in der aktiven Logdatei)
+ */
+bool Persistence::rotateTransactionLog(long long time) {
+    int activeMonth = transactionArchive.getActiveMonth();
+    if (activeMonth == LogArchive::monthOf(time)) {
+        return true;
+    }
+    if (!commitTransactionLog() || !transactionArchive.rotate(time)) {
+        return false;
+    }
+    if (activeMonth == 0) { // bisherige Logdatei wird dem neuen Monat zugeschlagen
+        return columns.commit(transactionArchive.getActiveMonth(), transactionLog.getSize());
+    }
+    bool indexCleared = transactionIndex.clear();
+    bool logReset = transactionLog.reset();
+    bool columnsCommitted = columns.commit(transactionArchive.getActiveMonth(), transactionLog.getSize()); // Zeilen des alten Monats stecken jetzt im Segment
+    return logReset && indexCleared && columnsCommitted;
+}
+
+/**\brief Versiegelt depositlog.txt, wenn die nächste Zeile zu einem neuen Monat gehört (läuft im Schreib-Thread)
+ * \param time (Zeitpunkt der nächsten Zeile)
+ * \return bool (false, wenn nicht versiegelt werden konnte; die Zeile landet dann trotzdem in der aktiven Logdatei)
+ */
+bool Persistence::rotateDepositLog(long long time) {
+    int activeMonth = depositArchive.getActiveMonth();
+    if (activeMonth == LogArchive::monthOf(time)) {
+        return true;
+    }
+    if (!depositLog.commit() || !depositArchive.rotate(time)) {
+        return false;
+    }
+    if (activeMonth == 0) {
+        return true;
+    }
+    return depositLog.reset();
+}
+
+/**\brief Setzt die Durability für Journal und Logs (läuft im Schreib-Thread bzw. vor dessen Start)
+ * \param nDurability (0 = kein fsync, 1 = fsync pro Gruppe, 2 = fsync pro Eintrag)
+ */
+void Persistence::setDurability(int nDurability) {
+    journal.setDurability(nDurability);
+    transactionLog.setDurability(nDurability);
+    depositLog.setDurability(nDurability);
+    deletionLog.setDurability(nDurability);
+}
+
+/**\brief Verarbeitet einen einzelnen Datensatz (läuft im Schreib-Thread)
+ * Zeilen für Journal und Logs werden nur gesammelt und erst in commitLogs() gemeinsam geschrieben.
+ * Journaleinträge werden zusätzlich auf die eigene Kopie des Stands angewendet. Ist das Journal lang genug, wird diese Kopie als neuer Snapshot geschrieben und das Journal geleert.
+ * Konnte der letzte Snapshot nicht geschrieben werden, gehört das Journal evtl. nicht mehr zu den IDs der Kopie (z.B. nach delusr). Die Einträge werden dann nur auf die Kopie angewendet
+ * und landen mit dem nächsten erfolgreichen Snapshot in der Datei (siehe commitLogs).
+ * \return bool (false, wenn eine Datei nicht geschrieben werden konnte)
+ */
+bool Persistence::apply(const ChangeRecord &record) {
+    switch (record.kind) {
+    case ChangeRecord::JournalEntry:
+        if (!snapshotPending) {
+            journal.append(record.line);
+        }
+        Journal::apply(record.line, users, beverages, system);
+        if (!snapshotPending && journal.getRecordCount() >= journalCompactionThreshold) {
+            return writeSnapshot();
+        }
+        return true;
+    case ChangeRecord::TransactionLogEntry: {
+        long long time = lineTime(record.line, false, record.timestamp);
+        bool rotated = rotateTransactionLog(time);
+        transactionLog.add(record.line);
+        pendingTransactions.push_back(PendingTransaction{record.userID, time, record.line});
+        return rotated;
+    }
+    case ChangeRecord::DepositLogEntry: {
+        bool rotated = rotateDepositLog(lineTime(record.line, true, record.timestamp));
+        depositLog.add(record.line);
+        return rotated;
+    }
+    case ChangeRecord::DepositLogReset:
+        if (!depositLog.reset() || !depositArchive.clear() || !depositArchive.rotate(lineTime(record.line, true, record.timestamp))) {
+            return false;
+        }
+        depositLog.add(record.line);
+        return true;
+    case ChangeRecord::DeletionLogEntry: { // Position, an der die nächste Zeile in transactionlog.txt landet
+        long long position = transactionLog.getSize();
+        for (size_t i=0; i < pendingTransactions.size() && position >= 0; i++) {
+            position += pendingTransactions[i].line.size() + 1;
+        }
+        deletionLog.add(record.line + " | " + to_string(activeTransactionMonth()) + " | " + to_string(position));
+        return true;
+    }
+    case ChangeRecord::Batch: {
+        if (!snapshotPending) {
+            journal.appendBatch(record.journalLines);
+        }
+        for (int i=0; i < record.journalLines.size(); i++) {
+            Journal::apply(record.journalLines[i], users, beverages, system);
+        }
+        bool rotated = true;
+        for (int i=0; i < record.transactionLines.size(); i++) {
+            long long time = lineTime(record.transactionLines[i].second, false, record.timestamp);
+            rotated = rotateTransactionLog(time) && rotated;
+            transactionLog.add(record.transactionLines[i].second);
+            pendingTransactions.push_back(PendingTransaction{record.transactionLines[i].first, time, record.transactionLines[i].second});
+        }
+        if (!snapshotPending && journal.getRecordCount() >= journalCompactionThreshold) {
+            return writeSnapshot() && rotated;
+        }
+        return rotated;
+    }
+    case ChangeRecord::FullSnapshot:
+        users = record.users;
+        beverages = record.beverages;
+        system = record.system;
+        setDurability(system.getDurability()); // z.B. nach "setdurability"
+        return writeSnapshot();
+    }
+    return false;
+}
+
+/**\brief Schreibt die eigene Kopie des Stands als Snapshot und leert danach das Journal (läuft im Schreib-Thread)
+ * Schlägt das fehl, bleibt der Snapshot ausstehend (snapshotPending) und wird mit dem nächsten Group Commit erneut versucht.
+ * \return bool (false, wenn der Snapshot nicht geschrieben oder das Journal nicht geleert werden konnte; zählt dann als Fehler, siehe getFailureCount)
+ */
+bool Persistence::writeSnapshot() {
+    unsigned int generation = snapshot.getGeneration();
+    bool written = snapshot.write(users, beverages, system);
+    if (snapshot.getGeneration() == generation) {
+        snapshotPending = true; // nicht umbenannt, das Journal gehört weiterhin zum alten Snapshot
+        return false;
+    }
+    snapshotPending = !journal.clear(snapshot.getGeneration());
+    return !snapshotPending && written;
+}
+
+/**\brief Stellt einen Datensatz in die Warteschlange und weckt den Schreib-Thread
+ */
+void Persistence::submit(ChangeRecord record) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        record.timestamp = time(nullptr);
+        queue.push_back(record);
+        submitted++;
+    }
+    queueChanged.notify_one();
+}
+
+/**\brief Übergibt einen Journaleintrag (siehe Journal::saleRecord etc.)
+ */
+void Persistence::journalEntry(string line) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::JournalEntry;
+    record.line = line;
+    submit(record);
+}
+
+/**\brief Übergibt eine Zeile für transactionlog.txt
+ * \param userID (Nutzer, zu dem die Zeile gehört; wird im Index für die Historie vermerkt)
+ */
+void Persistence::transactionLogEntry(int userID, string line) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::TransactionLogEntry;
+    record.line = line;
+    record.userID = userID;
+    submit(record);
+}
+
+/**\brief Übergibt mehrere Änderungen, die nur gemeinsam gelten (z.B. alle Verkäufe eines Warenkorbs)
+ * Der Stapel ist ein einziger Datensatz: er landet immer vollständig in derselben Gruppe, und im Journal als ein Block (siehe Journal::appendBatch).
+ * \param journalLines (Journaleinträge), transactionLines (NutzerID und Zeile für transactionlog.txt)
+ */
+void Persistence::batchEntry(const vector<string> &journalLines, const vector<pair<int, string> > &transactionLines) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::Batch;
+    record.journalLines = journalLines;
+    record.transactionLines = transactionLines;
+    submit(record);
+}
+
+/**\brief Übergibt eine Zeile für depositlog.txt
+ */
+void Persistence::depositLogEntry(string line) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::DepositLogEntry;
+    record.line = line;
+    submit(record);
+}
+
+/**\brief Übergibt das Löschen eines Nutzers für deletionlog.txt ("<Zeitstempel> | <NutzerID> | <Name>")
+ * Der Schreib-Thread hängt den Monat und die Position in transactionlog.txt an, ab der die folgenden Nutzer unter ihrer neuen ID gebucht werden:
+ * "<Zeitstempel> | <NutzerID> | <Name> | <JJJJMM> | <Position>" (-1, wenn die Größe von transactionlog.txt nicht bestimmt werden konnte; siehe LedgerAudit).
+ */
+void Persistence::deletionLogEntry(string line) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::DeletionLogEntry;
+    record.line = line;
+    submit(record);
+}
+
+/**\brief Leert depositlog.txt und schreibt danach die übergebene(n) Zeile(n) hinein (cleardeplog)
+ */
+void Persistence::resetDepositLog(string line) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::DepositLogReset;
+    record.line = line;
+    submit(record);
+}
+
+/**\brief Übergibt eine Kopie aller Objekte, die als vollständiger Snapshot geschrieben wird
+ * Wird für alle Änderungen verwendet, die nicht im Journal abgebildet werden (z.B. neue/gelöschte Nutzer oder Getränke, da sich dabei die IDs verschieben).
+ */
+void Persistence::saveSnapshot(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    ChangeRecord record;
+    record.kind = ChangeRecord::FullSnapshot;
+    record.users = fUsers;
+    record.beverages = fBeverages;
+    record.system = fSystem;
+    submit(record);
+}
+
+/**\brief Barriere: wartet, bis alle bis jetzt übergebenen Datensätze geschrieben wurden
+ */
+void Persistence::flush() {
+    unique_lock<mutex> lock(queueMutex);
+    if (!worker.joinable()) {
+        return;
+    }
+    unsigned long target = submitted;
+    recordsApplied.wait(lock, [this, target]() { return logsLoaded && applied >= target; });
+}
+
+/**\brief Öffnet eine Ansicht aller Zeilen eines Nutzers aus transactionlog.txt und den versiegelten Monaten
+ * Wartet vorher, bis alle übergebenen Zeilen geschrieben sind. Berücksichtigt werden nur die Segmente des Zeitraums, in denen der Nutzer laut Manifest vorkommt;
+ * die Positionen seiner Zeilen stammen aus dem jeweiligen Index. Ist ein Zeitraum angegeben, werden dessen Grenzen per Binärsuche über diese Positionen gefunden (siehe LogView::addSegmentRange).
+ * Gelesen werden die Zeilen erst beim Anzeigen (siehe LogView).
+ * \param userID, fromDay, toDay (JJJJMMTT, jeweils einschließlich; 0 bis 99991231 für alle Zeilen), view (wird geleert und neu gefüllt)
+ */
+void Persistence::openUserTransactions(int userID, int fromDay, int toDay, LogView &view) {
+    flush();
+    view.clear();
+    bool wholeLog = fromDay <= 0 && toDay >= 99991231;
+    long long fromStamp = fromDay * 1000000LL;
+    long long toStamp = toDay * 1000000LL + 235959;
+    vector<LogSegmentInfo> fSegments = transactionArchive.getSegments(fromDay / 100, toDay / 100);
+    for (int i=0; i < fSegments.size(); i++) {
+        if (!fSegments[i].hasUser(userID)) {
+            continue;
+        }
+        vector<unsigned long long> userOffsets;
+        if (!fSegments[i].indexFile.empty()) {
+            userOffsets = LogIndex::readOffsets(fSegments[i].indexFile, userID);
+        }
+        else { // Index fehlt: Zeilen des Segments einzeln prüfen
+            Segment segment;
+            vector<unsigned long long> lineOffsets;
+            if (segment.open(fSegments[i].file) && segment.readLineOffsets(lineOffsets)) {
+                for (int j=0; j < lineOffsets.size(); j++) {
+                    string transaction;
+                    if (segment.readLine(lineOffsets[j], transaction) && LogIndex::parseUserID(transaction) == userID) {
+                        userOffsets.push_back(lineOffsets[j]);
+                    }
+                }
+            }
+        }
+        if (wholeLog) {
+            view.addSegment(fSegments[i].file, userOffsets);
+        }
+        else {
+            view.addSegmentRange(fSegments[i].file, userOffsets, fromStamp, toStamp, fSegments[i].month, false);
+        }
+    }
+    int activeMonth = activeTransactionMonth();
+    if (wholeLog) {
+        view.addLog("transactionlog.txt", transactionIndex.getOffsets(userID));
+    }
+    else {
+        view.addLogRange("transactionlog.txt", transactionIndex.getOffsets(userID), fromStamp, toStamp, activeMonth, false);
+    }
+}
+
+/**\brief Wertet alle Buchungen eines Zeitraums über den Spaltenspeicher aus (siehe ColumnStore::analyze)
+ * Wartet vorher, bis alle übergebenen Zeilen geschrieben sind.
+ * \param from, to (Unixzeit, von einschließlich bis ausschließlich), count (Länge der Ranglisten)
+ * \return ColumnReport
+ */
+ColumnReport Persistence::analyze(long long from, long long to, int count) {
+    flush();
+    return columns.analyze(from, to, count);
+}
+
+/**\brief Bereitet eine Prüfung der Logs gegen den übergebenen Stand vor (siehe LedgerAudit)
+ * Wartet vorher, bis alle übergebenen Zeilen geschrieben sind; geprüft wird danach alles, was bis jetzt in den Segmenten und aktiven Logdateien steht.
+ * \param fUsers, fSystem (aktueller Stand, muss zu den bisher übergebenen Änderungen passen), audit (Ausgabe)
+ */
+void Persistence::prepareAudit(const vector<User> &fUsers, const System &fSystem, LedgerAudit &audit) {
+    flush();
+    audit.prepare(fUsers, fSystem, transactionArchive.getSegments(0, 999999), "transactionlog.txt", activeTransactionMonth(), depositArchive.getSegments(0, 999999), "depositlog.txt", "deletionlog.txt");
+}
+
+/**\brief Öffnet eine Ansicht aller Zeilen von depositlog.txt aus einem Zeitraum
+ * Wartet vorher, bis alle übergebenen Zeilen geschrieben sind. Berücksichtigt werden nur die Segmente der angefragten Monate;
+ * ist ein Zeitraum angegeben, wird in jeder Datei per Binärsuche die erste Zeile gesucht und nur bis zum Ende des Zeitraums gelesen (siehe LogView::addSegmentRange).
+ * \param fromDay, toDay (JJJJMMTT, jeweils einschließlich; 0 bis 99991231 für alle Zeilen), view (wird geleert und neu gefüllt)
+ */
+void Persistence::openDeposits(int fromDay, int toDay, LogView &view) {
+    flush();
+    view.clear();
+    bool wholeLog = fromDay <= 0 && toDay >= 99991231;
+    long long fromStamp = fromDay * 1000000LL;
+    long long toStamp = toDay * 1000000LL + 235959;
+    vector<LogSegmentInfo> fSegments = depositArchive.getSegments(fromDay / 100, toDay / 100);
+    for (int i=0; i < fSegments.size(); i++) {
+        if (!wholeLog) {
+            view.addSegmentRange(fSegments[i].file, fromStamp, toStamp, fSegments[i].month, true);
+            continue;
+        }
+        Segment segment;
+        vector<unsigned long long> lineOffsets;
+        if (segment.open(fSegments[i].file) && segment.readLineOffsets(lineOffsets)) {
+            view.addSegment(fSegments[i].file, lineOffsets);
+        }
+    }
+    int activeMonth = depositArchive.getActiveMonth();
+    if (activeMonth == 0) { // noch nichts geschrieben, die Logdatei stammt dann aus dem aktuellen Monat
+        activeMonth = LogArchive::monthOf(time(nullptr));
+    }
+    if (wholeLog) {
+        view.addLog("depositlog.txt", LogView::scanLog("depositlog.txt"));
+    }
+    else if (activeMonth >= fromDay / 100 && activeMonth <= toDay / 100) {
+        view.addLogRange("depositlog.txt", fromStamp, toStamp, activeMonth, true);
+    }
+}
+
+/**\brief Gibt die Anzahl der noch nicht geschriebenen Datensätze zurück
+ * \return int (Länge der Warteschlange inkl. des gerade geschriebenen Datensatzes)
+ */
+int Persistence::getPendingCount() {
+    lock_guard<mutex> lock(queueMutex);
+    return submitted - applied;
+}
+
+/**\brief Gibt die Schreibstatistik (Gruppengrößen und Dauer) von Journal, transactionlog.txt und depositlog.txt zurück
+ * \return vector<LogWriterStats> (in dieser Reihenfolge)
+ */
+vector<LogWriterStats> Persistence::getLogStats() {
+    vector<LogWriterStats> stats;
+    stats.push_back(journal.getStats());
+    stats.push_back(transactionLog.getStats());
+    stats.push_back(depositLog.getStats());
+    return stats;
+}
+
+/**\brief Setzt die Schreibstatistik von Journal und Logs zurück
+ */
+void Persistence::resetLogStats() {
+    journal.resetStats();
+    transactionLog.resetStats();
+    depositLog.resetStats();
+}
+
+/**\brief Gibt zurück, wie lange das Laden der Logs im Schreib-Thread gedauert hat (siehe loadLogs)
+ * \return long long (ms; -1, solange die Logs noch geladen werden)
+ */
+long long Persistence::getLogLoadTime() {
+    lock_guard<mutex> lock(queueMutex);
+    return logsLoaded ? logLoadTime : -1;
+}
+
+/**\brief Gibt die Anzahl der Datensätze zurück, die nicht geschrieben werden konnten
+ * \return failures (als int)
+ */
+int Persistence::getFailureCount() {
+    lock_guard<mutex> lock(queueMutex);
+    return failures;
+}
@@ -0,0 +1,102 @@
+#include "includes.h"
+
+/**\brief Unveränderlicher Änderungsdatensatz, der vom GUI-Thread an den Schreib-Thread übergeben wird
+ * Je nach Art wird entweder eine fertig formatierte Zeile (Journal, Logs) oder eine vollständige Kopie aller Objekte (Snapshot) übergeben.
+ */
+struct ChangeRecord {
+    enum Kind { JournalEntry, TransactionLogEntry, DepositLogEntry, DepositLogReset, DeletionLogEntry, FullSnapshot, Batch };
+    Kind kind;
+    string line;
+    int userID; // nur bei TransactionLogEntry gültig (für den Index)
+    long long timestamp; // Zeitpunkt der Übergabe (Unixzeit); Monatssegment und Spaltenspeicher richten sich nach dem Zeitstempel der Zeile, dieser nur bei Zeilen ohne vollen Zeitstempel
+    vector<User> users; // nur bei FullSnapshot gefüllt
+    vector<Beverage> beverages; // nur bei FullSnapshot gefüllt
+    System system; // nur bei FullSnapshot gültig
+    vector<string> journalLines; // nur bei Batch: Journaleinträge, die nur gemeinsam gelten
+    vector<pair<int, string> > transactionLines; // nur bei Batch: NutzerID und Zeile für transactionlog.txt
+};
+
+/**\brief Zeile für transactionlog.txt, die noch nicht geschrieben wurde; erst danach wird sie in Index und Spaltenspeicher eingetragen
+ */
+struct PendingTransaction {
+    int userID;
+    long long timestamp;
+    string line;
+};
+
+/**\brief Klasse "Persistenceclass" für das Speichern im Hintergrund
+ * Sämtliche Schreibzugriffe (Journal, Snapshot, transactionlog.txt, depositlog.txt, deletionlog.txt) werden nicht mehr im GUI-Thread ausgeführt,
+ * sondern als ChangeRecord in eine Warteschlange gestellt und von einem eigenen Thread in genau dieser Reihenfolge abgearbeitet.
+ * Eine langsame SD-Karte lässt also nicht mehr den Touchscreen nach jedem Verkauf einfrieren.
+ * Der Schreib-Thread führt eine eigene Kopie des bereits gesicherten Stands mit, damit er das Journal selbstständig in einen neuen Snapshot einfalten kann.
+ * Journal und Logs werden per Group Commit geschrieben: alle Datensätze, die innerhalb eines kurzen Zeitfensters eintreffen, landen mit einem einzigen write() (und je nach Durability einem fsync) in der jeweiligen Datei.
+ * Mit flush() kann gewartet werden, bis alle bisher übergebenen Änderungen geschrieben wurden (z.B. vor restart/shutdown oder vor dem Lesen der Logs).
+ * Die Logs selbst (Manifeste, Index, Spaltenspeicher) lädt der Schreib-Thread erst nach dem Start im Hintergrund; flush() wartet auch darauf.
+ * transactionlog.txt und depositlog.txt enthalten nur den aktuellen Monat; ältere Monate liegen als komprimierte Segmente daneben (siehe LogArchive).
+ */
+class Persistence {
+private:
+    Journal journal;
+    Snapshot snapshot;
+    LogWriter transactionLog;
+    LogWriter depositLog;
+    LogWriter deletionLog; // gelöschte Nutzer mit der Position in transactionlog.txt (für LedgerAudit)
+    LogIndex transactionIndex; // NutzerID -> Zeilen in transactionlog.txt
+    LogArchive transactionArchive; // versiegelte Monate von transactionlog.txt
+    LogArchive depositArchive; // versiegelte Monate von depositlog.txt
+    ColumnStore columns; // alle Buchungen aus transactionlog.txt spaltenweise für Auswertungen (siehe analyze)
+    vector<PendingTransaction> pendingTransactions; // noch nicht geschriebene Zeilen in transactionlog.txt
+    vector<User> users; // Stand, der bereits im Snapshot + Journal steckt
+    vector<Beverage> beverages;
+    System system;
+    deque<ChangeRecord> queue;
+    mutex queueMutex;
+    condition_variable queueChanged; // weckt den Schreib-Thread
+    condition_variable recordsApplied; // weckt Threads, die in flush() warten
+    unsigned long submitted; // Anzahl aller jemals übergebenen Datensätze
+    unsigned long applied; // Anzahl aller bereits abgearbeiteten Datensätze
+    int failures;
+    bool stopping;
+    bool snapshotPending; // das Journal passt nicht zum Stand des Schreib-Threads (z.B. Snapshot nach dem Löschen eines Nutzers fehlgeschlagen); bis zum nächsten Snapshot werden keine Einträge angehängt
+    bool logsLoaded; // Manifeste, Index und Spaltenspeicher sind geladen (siehe loadLogs)
+    long long logLoadTime; // Dauer von loadLogs in ms
+    std::thread worker;
+    void run();
+    void loadLogs();
+    bool apply(const ChangeRecord &record);
+    bool writeSnapshot();
+    bool commitLogs();
+    bool commitTransactionLog();
+    bool rotateTransactionLog(long long time);
+    int activeTransactionMonth();
+    bool catchUpColumns();
+    bool rebuildColumns();
+    bool rotateDepositLog(long long time);
+    void setDurability(int nDurability);
+    void submit(ChangeRecord record);
+public:
+    Persistence();
+    ~Persistence();
+    bool hasSnapshot();
+    bool readSnapshot(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+    int replayJournal(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+    void start(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+    void stop();
+    void journalEntry(string line);
+    void transactionLogEntry(int userID, string line);
+    void batchEntry(const vector<string> &journalLines, const vector<pair<int, string> > &transactionLines);
+    void depositLogEntry(string line);
+    void deletionLogEntry(string line);
+    void resetDepositLog(string line);
+    void saveSnapshot(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+    void flush();
+    void openUserTransactions(int userID, int fromDay, int toDay, LogView &view);
+    void openDeposits(int fromDay, int toDay, LogView &view);
+    ColumnReport analyze(long long from, long long to, int count);
+    void prepareAudit(const vector<User> &fUsers, const System &fSystem, LedgerAudit &audit);
+    int getPendingCount();
+    int getFailureCount();
+    long long getLogLoadTime();
+    vector<LogWriterStats> getLogStats();
+    void resetLogStats();
+};
@@ -0,0 +1,1191 @@
+#include "includes.h"
+#include "headers.h"
+#include <sstream>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+const char *PosEngine::initialPassword = "pm-tnmjc";
+
+/**\brief Liest den größten vollen Zeitstempel ("JJJJMMTThhmmss") aus den letzten Zeilen einer Logdatei (siehe PosEngine::logStamp)
+ * Gelesen werden nur die letzten 4 KiB; ältere Zeilen mit kurzem Zeitstempel ohne Jahr und eine letzte Zeile ohne Zeilenumbruch werden ignoriert.
+ * \param path, userPrefix (true, wenn vor dem Zeitstempel die NutzerID steht, siehe LogArchive::parseStamp)
+ * \return long long (JJJJMMTThhmmss; 0, wenn die Datei fehlt oder keinen vollen Zeitstempel enthält)
+ */
+static long long lastStampIn(const char *path, bool userPrefix) {
+    ifstream log;
+    log.open(path, ios::in | ios::binary);
+    if (!log.is_open()) {
+        return 0;
+    }
+    log.seekg(0, ios::end);
+    long long size = log.tellg();
+    long long start = max(size - 4096, 0LL);
+    string tail(size - start, '\0');
+    log.seekg(start);
+    log.read(&tail[0], tail.size());
+    tail.resize(log.gcount());
+    log.close();
+    long long last = 0;
+    size_t lineStart = start == 0 ? 0 : tail.find('\n'); // die erste Zeile ist evtl. abgeschnitten
+    while (lineStart != string::npos && lineStart < tail.size()) {
+        if (tail[lineStart] == '\n') {
+            lineStart++;
+        }
+        size_t lineEnd = tail.find('\n', lineStart);
+        if (lineEnd == string::npos) {
+            break;
+        }
+        long long stamp = LogArchive::parseStamp(tail.substr(lineStart, lineEnd - lineStart), 0, userPrefix);
+        if (stamp >= 10000000000000LL) { // nur volle Zeitstempel, bei kurzen fehlt das Jahr
+            last = max(last, stamp);
+        }
+        lineStart = lineEnd;
+    }
+    return last;
+}
+
+/**\brief Konstruktor für PosEngine-Objekte
+ * Der gespeicherte Stand wird erst mit load() gelesen.
+ */
+PosEngine::PosEngine() {
+    batchActive = false;
+    batchDepositReset = false;
+    lastLogStamp = 0;
+}
+
+/**\brief Destruktor: schreibt noch alle ausstehenden Änderungen (siehe stop)
+ */
+PosEngine::~PosEngine() {
+    stop();
+}
+
+//
+// Laden und Speichern
+//
+
+/**\brief Liest den gespeicherten Stand und startet den Schreib-Thread
+ * Zuerst wird der binäre Snapshot gelesen (nur wenn es noch keinen gibt, z.B. bei einer älteren Installation, werden die Textdatenbanken importiert),
+ * danach das Journal mit den Änderungen seit dem letzten Snapshot angewendet und der Schreib-Thread gestartet.
+ * Die Logs (Manifeste, Index, Spaltenspeicher) lädt der Schreib-Thread danach im Hintergrund; Nutzer, Getränke und System sind also sofort verwendbar (siehe getLogLoadTime).
+ * Gibt es noch keinen Nutzer, wird ein neues System mit dem Passwort initialPassword angelegt (First-Time-Setup, erkennbar an getUsers().empty()).
+ * Ist snapshot.bin vorhanden, aber nicht lesbar, wird nichts geladen und nichts geschrieben: ein leerer Ersatzstand würde sonst beim nächsten Snapshot alle Guthaben überschreiben.
+ * \param error (Hinweis, wenn der gespeicherte Stand nicht gelesen werden konnte)
+ * \return bool (false, wenn der Snapshot nicht gelesen werden konnte; die Kasse darf dann nicht starten)
+ */
+bool PosEngine::load(string &error) {
+    if (persistence.hasSnapshot()) {
+        if (!persistence.readSnapshot(users, beverages, system)) {
+            error = "snapshot.bin ist beschädigt oder nicht lesbar; bitte aus einer Sicherung wiederherstellen (es wurde nichts verändert)";
+            return false;
+        }
+    }
+    if (!persistence.hasSnapshot() || users.empty()) { // noch kein Snapshot (oder einer aus dem First-Time-Setup ohne Nutzer), also die Textdatenbanken importieren
+        vector<User> importedUsers = readUsersFromDB();
+        if (!persistence.hasSnapshot() || !importedUsers.empty()) {
+            users = importedUsers;
+            beverages = readBeveragesFromDB();
+            system = readSystemFromDB();
+        }
+    }
+    persistence.replayJournal(users, beverages, system);
+    lastLogStamp = max(lastStampIn("transactionlog.txt", false), lastStampIn("depositlog.txt", true)); // die Uhr könnte seit dem letzten Start zurückgestellt worden sein
+    persistence.start(users, beverages, system);
+    rebuildIndexes();
+    if (users.empty()) {
+        system.setvBalance(Money());
+        system.setPassword(initialPassword);
+        saveSnapshot();
+    }
+    return true;
+}
+
+/**\brief Schreibt alle noch ausstehenden Änderungen und beendet den Schreib-Thread
+ */
+void PosEngine::stop() {
+    persistence.stop();
+}
+
+/**\brief Übergibt eine Kopie aller Nutzer, Getränke und des Systems als vollständigen Snapshot an den Schreib-Thread
+ * Wird für alle Änderungen verwendet, die nicht im Journal abgebildet werden (z.B. neue/gelöschte Nutzer oder Getränke, da sich dabei die IDs verschieben).
+ * Der Schreib-Thread leert danach das Journal.
+ */
+void PosEngine::saveSnapshot() {
+    if (!batchActive) { // im Stapelbetrieb schreibt erst commitBatch() einen Snapshot
+        persistence.saveSnapshot(users, beverages, system);
+    }
+}
+
+/**\brief Wartet, bis alle bisher übergebenen Änderungen geschrieben wurden (z.B. vor restart/shutdown)
+ */
+void PosEngine::flush() {
+    persistence.flush();
+}
+
+/**\brief Schreibt den aktuellen Stand in die Textdatenbanken (userDB.txt, beverageDB.txt, systemDB.txt)
+ * \return bool (false, wenn eine der Dateien nicht geschrieben werden konnte)
+ */
+bool PosEngine::exportDB() {
+    persistence.flush();
+    return writeUsersToDB(users) && writeBeveragesToDB(beverages) && writeSystemToDB(system);
+}
+
+/**\brief Ersetzt den kompletten Stand durch die Textdatenbanken und sichert ihn im Snapshot
+ * \return bool (false, wenn userDB.txt keine Nutzer enthält; dann wird nichts verändert)
+ */
+bool PosEngine::importDB() {
+    vector<User> importedUsers = readUsersFromDB();
+    if (importedUsers.empty()) {
+        return false;
+    }
+    vector<Beverage> importedBeverages = readBeveragesFromDB();
+    System importedSystem = readSystemFromDB();
+    // die Summen für die Auswertungen stehen nicht in den Textdatenbanken und werden über den Namen übernommen
+    for (int i=0; i < importedUsers.size(); i++) {
+        int slot = userNames.find(importedUsers[i].getName());
+        if (slot >= 0) {
+            importedUsers[i].setTotals(users[slot].getConsumed(), users[slot].getSpent(), users[slot].getDeposited());
+        }
+    }
+    for (int i=0; i < importedBeverages.size(); i++) {
+        int slot = beverageNames.find(importedBeverages[i].getName());
+        if (slot >= 0) {
+            importedBeverages[i].setSales(beverages[slot].getSold(), beverages[slot].getRevenue());
+        }
+    }
+    for (map<int, DayTotals>::const_iterator it = system.getDays().begin(); it != system.getDays().end(); ++it) {
+        importedSystem.setDayTotals(it->first, it->second);
+    }
+    users = importedUsers;
+    beverages = importedBeverages;
+    system = importedSystem;
+    rebuildIndexes();
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Beginnt den Stapelbetrieb: alle folgenden Änderungen gelten erst mit commitBatch() als gespeichert
+ * Bis dahin wird nichts an den Schreib-Thread übergeben (kein Journal, kein Snapshot, keine Logzeilen); commitBatch() schreibt dann einen einzigen Snapshot
+ * und die zurückgehaltenen Logzeilen. Stürzt das Programm vorher ab, gilt also keine der Änderungen. rollbackBatch() stellt den Stand beim Beginn wieder her.
+ * Gedacht z.B. für das Anlegen vieler Nutzer und Getränke auf einmal (Kommando batch), das sonst pro Änderung einen Snapshot schreiben würde.
+ */
+void PosEngine::beginBatch() {
+    if (batchActive) {
+        return;
+    }
+    batchActive = true;
+    batchUsers = users;
+    batchBeverages = beverages;
+    batchSystem = system;
+    batchTransactionLines.clear();
+    batchDepositLines.clear();
+    batchDepositReset = false;
+}
+
+/**\brief Beendet den Stapelbetrieb und übergibt alle Änderungen auf einmal an den Schreib-Thread (ein Snapshot, danach die Logzeilen)
+ */
+void PosEngine::commitBatch() {
+    if (!batchActive) {
+        return;
+    }
+    batchActive = false;
+    saveSnapshot();
+    if (batchDepositReset) {
+        persistence.resetDepositLog(batchDepositResetLine);
+    }
+    for (int i=0; i < batchDepositLines.size(); i++) {
+        persistence.depositLogEntry(batchDepositLines[i]);
+    }
+    for (int i=0; i < batchTransactionLines.size(); i++) {
+        persistence.transactionLogEntry(batchTransactionLines[i].first, batchTransactionLines[i].second);
+    }
+    batchUsers.clear();
+    batchBeverages.clear();
+    batchTransactionLines.clear();
+    batchDepositLines.clear();
+}
+
+/**\brief Beendet den Stapelbetrieb und verwirft alle Änderungen seit beginBatch()
+ */
+void PosEngine::rollbackBatch() {
+    if (!batchActive) {
+        return;
+    }
+    batchActive = false;
+    users = batchUsers;
+    beverages = batchBeverages;
+    system = batchSystem;
+    rebuildIndexes();
+    batchUsers.clear();
+    batchBeverages.clear();
+    batchTransactionLines.clear();
+    batchDepositLines.clear();
+}
+
+/**\brief Gibt zurück, ob gerade der Stapelbetrieb läuft
+ */
+bool PosEngine::inBatch() const {
+    return batchActive;
+}
+
+/**\brief Übergibt einen Journaleintrag an den Schreib-Thread (im Stapelbetrieb nicht nötig, der Snapshot am Ende enthält die Änderung)
+ */
+void PosEngine::journalEntry(const string &line) {
+    if (!batchActive) {
+        persistence.journalEntry(line);
+    }
+}
+
+/**\brief Übergibt eine Zeile für transactionlog.txt an den Schreib-Thread (im Stapelbetrieb erst bei commitBatch)
+ */
+void PosEngine::transactionLogEntry(int userID, const string &line) {
+    if (batchActive) {
+        batchTransactionLines.push_back(make_pair(userID, line));
+    }
+    else {
+        persistence.transactionLogEntry(userID, line);
+    }
+}
+
+/**\brief Übergibt eine Zeile für depositlog.txt an den Schreib-Thread (im Stapelbetrieb erst bei commitBatch)
+ */
+void PosEngine::depositLogEntry(const string &line) {
+    if (batchActive) {
+        batchDepositLines.push_back(line);
+    }
+    else {
+        persistence.depositLogEntry(line);
+    }
+}
+
+/**\brief Schreibt alle Nutzer mit ihren Attributen in eine Datei
+ * (Serialisierung der Nutzer-Objekte; wird nur noch für den Export der Textdatenbanken verwendet, gespeichert wird im binären Snapshot)
+ * Die Datei wird geöffnet und in jede Zeile wird jeweils ein Nutzer geschrieben.
+ * Der bereits vorhandene Inhalt wird jeweils überschrieben!
+ * Die verschiedenen Attribute eines jeden Nutzers werden durch Semikolons getrennt.
+ * Wenn alle Objekte "abgeschrieben" wurden, wird die Datei geschlossen.
+ * \param fUsers (alle Nutzerobjekte)
+ * \return  true (wenn Methode ohne größere Fehler abgeschlossen)
+ *          false (wenn Datenbank nicht geöffnet werden konnte)
+ */
+bool PosEngine::writeUsersToDB(const vector<User> &fUsers) {
+    ofstream tmpUserDB;
+    tmpUserDB.open("userDB.txt.tmp");
+    if (tmpUserDB.is_open()) {
+        for (int i=0; i < fUsers.size(); i++) { // für jeden Nutzer eine neue Zeile
+            tmpUserDB << fUsers[i].getName() << ";" << fUsers[i].getBalance() << ";" << fUsers[i].getRole() << endl;
+        }
+    }
+    else {
+        return false;
+    }
+    tmpUserDB.close();
+    return rename("userDB.txt.tmp", "userDB.txt") == 0;
+}
+
+/**\brief Schreibt alle Getränke mit ihren Attributen in eine Datei
+ * (Serialisierung der Getränke-Objekte; wird nur noch für den Export der Textdatenbanken verwendet, gespeichert wird im binären Snapshot)
+ * Die Datei wird geöffnet und in jede Zeile wird jeweils ein Getränk geschrieben.
+ * Die verschiedenen Attribute eines jeden Getränks werden durch Semikolons getrennt.
+ * Wenn alle Objekte "abgeschrieben" wurden, wird die Datei geschlossen.
+ * \param fBeverages (alle Getränkeobjekte)
+ */
+bool PosEngine::writeBeveragesToDB(const vector<Beverage> &fBeverages) {
+    ofstream tmpBeverageDB;
+    tmpBeverageDB.open("beverageDB.txt.tmp");
+    if (tmpBeverageDB.is_open()) {
+        for (int i=0; i < fBeverages.size(); i++) {
+            tmpBeverageDB << fBeverages[i].getName() << ";" << fBeverages[i].getPrice() << ";" << fBeverages[i].getBarcode() << ";" << fBeverages[i].getStock() << ";" << fBeverages[i].getLastOrder() << endl;
+        }
+    }
+    else {
+        return false;
+    }
+    tmpBeverageDB.close();
+    return rename("beverageDB.txt.tmp", "beverageDB.txt") == 0;
+}
+
+/**\brief Schreibt die Systemeinstellungen in ein Textdokument
+ * \param fSystem
+ */
+bool PosEngine::writeSystemToDB(const System &fSystem) {
+    ofstream tmpSystemDB;
+    tmpSystemDB.open("systemDB.txt.tmp");
+    if (tmpSystemDB.is_open()) {
+        tmpSystemDB << fSystem.getPassword() << endl;
+        tmpSystemDB << fSystem.getvBalance() << endl;
+        tmpSystemDB << fSystem.getDurability() << endl;
+    }
+    else {
+        return false;
+    }
+    tmpSystemDB.close();
+    return rename("systemDB.txt.tmp", "systemDB.txt") == 0;
+}
+
+/**\brief Liest alle Nutzer mit ihren Attributen aus einer Datei
+ * (Deserialisierung der Nutzer-Objekte; wird nur noch für den Import der Textdatenbanken verwendet, z.B. bei der Migration einer älteren Installation)
+ * Die Datei wird geöffnet und jede Zeile einzeln gelesen.
+ * Die jeweils ausgelesene Zeile wird anhand der Semikolons in kleinere Strings aufgetrennt.
+ * Die jeweiligen Substrings werden je nach Attribut konvertiert und in einen temporären Nutzer geschrieben.
+ * Der temporäre Nutzer wird anschließend in einem Vektor verstaut.
+ * \return vector<User> fUser (gibt den Vektor, der alle Nutzerobjekte enthält, aus)
+ */
+vector<User> PosEngine::readUsersFromDB() {
+    vector<User> fUser;
+    ifstream tmpUserDB;
+    tmpUserDB.open("userDB.txt");
+    if (tmpUserDB.is_open()) {
+        while (tmpUserDB.good()) {
+            User tmpUser;
+            string sUOL; // sUOL = stringUserObjectLine
+            size_t posFD, posSD; // FD=FirstDivider, SD=SecondDivider, a divider is the ";" symbol
+            getline (tmpUserDB,sUOL);
+            if (sUOL.empty()) {
+                break;
+            }
+            else {
+                posFD = sUOL.find(";");
+                posSD = sUOL.find(";", posFD+1);
+                string sName = sUOL.substr (0,posFD);
+                string sBalance = sUOL.substr (posFD+1,posSD-posFD-1);
+                string sRole = sUOL.substr (posSD+1);
+                Money balance;
+                Money::parse(sBalance, balance);
+                tmpUser.editName(sName);
+                tmpUser.setBalance(-balance);
+                tmpUser.editRole(stoi(sRole));
+                fUser.push_back(tmpUser);
+            }
+        }
+    }
+    tmpUserDB.close();
+    return fUser;
+}
+
+/**\brief Liest alle Getränke mit ihren Attributen aus einer Datei
+ * (Deserialisierung der Getränke-Objekte; wird nur noch für den Import der Textdatenbanken verwendet, z.B. bei der Migration einer älteren Installation)
+ * Die Datei wird geöffnet und jede Zeile einzeln gelesen.
+ * Die jeweils ausgelesene Zeile wird anhand der Semikolons in kleinere Strings aufgetrennt.
+ * Die jeweiligen Substrings werden je nach Attribut konvertiert und in ein temporäres Getränk geschrieben.
+ * Das temporäre Getränk wird anschließend in einem Vektor verstaut.
+ * \return vector<Beverage> fBeverage (gibt den Vektor, der alle Getränkeobjekte enthält, aus)
+ */
+vector<Beverage> PosEngine::readBeveragesFromDB() {
+    vector<Beverage> fBeverage;
+    ifstream tmpBeverageDB;
+    tmpBeverageDB.open("beverageDB.txt");
+    if (tmpBeverageDB.is_open()) {
+        while (tmpBeverageDB.good()) {
+            Beverage tmpBeverage;
+            string sBOL; // sUOL = stringBeverageObjectLine
+            size_t pos1D, pos2D, pos3D, pos4D; // pos1D: position of first divider; a divider is the ";" symbol
+            getline (tmpBeverageDB,sBOL);
+            if (sBOL.empty()) {
+                break;
+            }
+            else {
+                pos1D = sBOL.find(";");
+                pos2D = sBOL.find(";", pos1D+1);
+                pos3D = sBOL.find(";", pos2D+1);
+                pos4D = sBOL.find(";", pos3D+1);
+                string sName = sBOL.substr (0,pos1D);
+                string sPrice = sBOL.substr (pos1D+1,pos2D-pos1D-1);
+                string sBarcode = sBOL.substr (pos2D+1,pos3D);
+                string sStock = sBOL.substr (pos3D+1,pos4D);
+                string sLastOrder = sBOL.substr(pos4D+1);
+                tmpBeverage.editName(sName);
+                Money price;
+                Money::parse(sPrice, price);
+                tmpBeverage.editPrice(price);
+                tmpBeverage.editBarcode(stoll(sBarcode));
+                tmpBeverage.setStock(stoi(sStock));
+                tmpBeverage.setLastOrder(stoi(sLastOrder));
+                fBeverage.push_back(tmpBeverage);
+            }
+        }
+    }
+    tmpBeverageDB.close();
+    return fBeverage;
+}
+
+/**\brief Passwort, Guthaben und Durability des Systems werden aus der Datenbank(DB) ausgelesen
+ * Die dritte Zeile (Durability) ist optional, damit auch ältere systemDB.txt-Dateien importiert werden können.
+ * \return Objekt fSystem
+ */
+System PosEngine::readSystemFromDB() {
+    System fSystem;
+    ifstream tmpSystemDB;
+    tmpSystemDB.open("systemDB.txt");
+    if (tmpSystemDB.is_open()) {
+        string sPassword;
+        string svBalance;
+        string sDurability;
+        getline (tmpSystemDB,sPassword);
+        getline (tmpSystemDB,svBalance);
+        getline (tmpSystemDB,sDurability);
+        Money vBalance;
+        if (Money::parse(svBalance, vBalance)) {
+            fSystem.setPassword(sPassword);
+            fSystem.setvBalance(vBalance);
+        }
+        if (sDurability.size() > 0) {
+            fSystem.setDurability(stoi(sDurability));
+        }
+    }
+    tmpSystemDB.close();
+    return fSystem;
+}
+
+/**\brief Baut die Indizes über Nutzernamen (inkl. Suchindex), Getränkenamen und Barcodes komplett neu auf (nach dem Laden bzw. nach importDB)
+ * Doppelte Namen oder Barcodes (z.B. aus alten Textdatenbanken) zeigen auf das erste Objekt mit diesem Schlüssel.
+ */
+void PosEngine::rebuildIndexes() {
+    userNames.clear();
+    userPrefixes.clear();
+    beverageNames.clear();
+    beverageBarcodes.clear();
+    for (int i=0; i < users.size(); i++) {
+        userNames.insert(users[i].getName(), i);
+        userPrefixes.insert(users[i].getName(), i);
+    }
+    for (int i=0; i < beverages.size(); i++) {
+        beverageNames.insert(beverages[i].getName(), i);
+        beverageBarcodes.insert(beverages[i].getBarcode(), i);
+    }
+}
+
+//
+// Zugriff auf den Zustand
+//
+
+/**\brief Gibt alle Nutzer zurück (Position im Vektor = NutzerID)
+ * \return const vector<User>&
+ */
+const vector<User> &PosEngine::getUsers() const {
+    return users;
+}
+
+/**\brief Gibt alle Getränke zurück (Position im Vektor = GetränkeID)
+ * \return const vector<Beverage>&
+ */
+const vector<Beverage> &PosEngine::getBeverages() const {
+    return beverages;
+}
+
+/**\brief Gibt die Systemeinstellungen zurück
+ * \return const System&
+ */
+const System &PosEngine::getSystem() const {
+    return system;
+}
+
+/**\brief Prüft, ob das First-Time-Setup noch abgeschlossen werden muss (noch kein Nutzer angelegt oder Passwort noch nicht geändert)
+ * \return bool
+ */
+bool PosEngine::needsSetup() const {
+    return users.empty() || system.getPassword() == initialPassword;
+}
+
+/**\brief Sucht einen Nutzer über seinen Namen (konstante Zeit, siehe HashIndex)
+ * \return int (NutzerID, -1 wenn es keinen Nutzer mit diesem Namen gibt)
+ */
+int PosEngine::findUser(const string &name) const {
+    return userNames.find(name);
+}
+
+/**\brief Sucht ein Getränk über seinen Namen
+ * \return int (GetränkeID, -1 wenn es kein Getränk mit diesem Namen gibt)
+ */
+int PosEngine::findBeverage(const string &name) const {
+    return beverageNames.find(name);
+}
+
+/**\brief Sucht ein Getränk über seinen Barcode
+ * \return int (GetränkeID, -1 bei unbekanntem Barcode)
+ */
+int PosEngine::findBarcode(long long barcode) const {
+    return beverageBarcodes.find(barcode);
+}
+
+/**\brief Sucht alle Nutzer, deren Name mit prefix beginnt (siehe PrefixIndex::find)
+ * \param prefix, slots (hier landen die passenden NutzerIDs)
+ */
+void PosEngine::searchUsers(const string &prefix, vector<int> &slots) const {
+    userPrefixes.find(prefix, slots);
+}
+
+//
+// Buchungen
+//
+
+/**\brief In dieser Funktion wird der eigentliche Kaufvorgang abgewickelt (eine Flasche, ein Warenkorb oder eine Runde für mehrere Nutzer)
+ * \Zuerst wird geprüft, ob von jedem Getränk noch genug Flaschen da sind (1) und ob jeder Nutzer seinen Anteil bezahlen kann (wie bei User::setBalance darf kein Guthaben unter 0 sinken) (2).
+ * \Scheitert auch nur eine Prüfung, wird gar nichts verändert; die Runde gelingt also ganz oder gar nicht.
+ * \Für jede Flasche wird der Preis vom Konto des jeweiligen Nutzers abgebucht und der Bestand des Getränks um 1 verringert (3).
+ * \Pro Kombination aus Nutzer und Getränk entsteht ein Journaleintrag mit dem neuen Guthaben und dem neuen Bestand (4).
+ * \Zusätzlich wird pro Flasche eine Zeile für die Datei "transactionlog.txt" erzeugt, die die getätigte Buchung mit Angaben zu:
+ * \        * Datum und der Uhrzeit (5),
+ * \        * der NutzerID, des Getränkepreises, des Getränkenamens und des neuen Guthabens des Nutzerkontos enthält (6).
+ * \Journaleinträge und Zeilen werden als ein einziger Stapel an den Schreib-Thread übergeben (7): Sie landen gemeinsam in einer Gruppe, und nach einem Absturz gilt entweder der ganze Kauf oder gar nichts.
+ * \Der aufrufende Thread wartet also nie auf die SD-Karte.
+ * \Die Laufzeit jeder dieser Phasen wird in latency erfasst (Kommando stats).
+ * \param sales (pro Flasche: NutzerID und GetränkeID), error (Hinweis, warum nicht gebucht werden konnte)
+ * \return false (Buchung konnte nicht durchgeführt werden)
+           true (Buchung konnte erfolgreich durchgeführt werden)
+ */
+bool PosEngine::sell(const vector<pair<int, int> > &sales, string &error) {
+    LatencyStats::Clock::time_point phaseStart = LatencyStats::Clock::now();
+    if (sales.empty()) {
+        error = "Keine Getränke ausgewählt!";
+        return false;
+    }
+    map<int, int> fBottles; // GetränkeID -> Anzahl
+    map<int, Money> fCosts; // NutzerID -> Summe
+    for (int i=0; i < sales.size(); i++) {
+        int userID = sales[i].first;
+        int id = sales[i].second;
+        if (userID < 0 || userID >= users.size() || id < 0 || id >= beverages.size()) {
+            error = "Unbekannter Nutzer oder unbekanntes Getränk!";
+            return false;
+        }
+        fBottles[id]++;
+        fCosts[userID] += beverages[id].getPrice();
+    }
+    for (map<int, int>::const_iterator it = fBottles.begin(); it != fBottles.end(); ++it) { //(1)
+        if (beverages[it->first].getStock() < it->second) {
+            error = beverages[it->first].getName() + ": nur noch " + to_string(beverages[it->first].getStock()) + " Flaschen!";
+            return false;
+        }
+    }
+    string poor;
+    for (map<int, Money>::const_iterator it = fCosts.begin(); it != fCosts.end(); ++it) { //(2)
+        if (it->second > users[it->first].getBalance()) {
+            poor += (poor.empty() ? "" : ", ") + users[it->first].getName();
+        }
+    }
+    if (!poor.empty()) {
+        error = fCosts.size() == 1 ? "Nicht mehr genug Geld vorhanden!" : "Nicht genug Geld: " + poor;
+        return false;
+    }
+    phaseStart = latency.record(LatencyStats::SaleValidate, phaseStart);
+    int day = today();
+    DayTotals totals = system.getDayTotals(day);
+    for (int i=0; i < sales.size(); i++) {
+        User &user = users[sales[i].first];
+        Beverage &beverage = beverages[sales[i].second];
+        Money price = beverage.getPrice();
+        user.setBalance(price); //(3)
+        beverage.setStock(beverage.getStock() - 1);
+        user.setTotals(user.getConsumed() + 1, user.getSpent() + price, user.getDeposited()); // Summen für die Auswertungen
+        beverage.setSales(beverage.getSold() + 1, beverage.getRevenue() + price);
+        totals.sales++;
+        totals.revenue += price;
+    }
+    system.setDayTotals(day, totals);
+    phaseStart = latency.record(LatencyStats::SaleApply, phaseStart);
+    string sTimestamp = logStamp(); //(5)
+    vector<pair<int, string> > fTransactionLines;
+    map<pair<int, int>, bool> fPairs; // Kombinationen aus Nutzer und Getränk für das Journal
+    map<int, Money> fBalances; // Guthaben nach der jeweiligen Flasche, damit jede Zeile den Stand direkt nach ihrer Buchung zeigt
+    for (map<int, Money>::const_iterator it = fCosts.begin(); it != fCosts.end(); ++it) {
+        fBalances[it->first] = users[it->first].getBalance() + it->second;
+    }
+    for (int i=0; i < sales.size(); i++) {
+        int userID = sales[i].first;
+        int id = sales[i].second;
+        fBalances[userID] -= beverages[id].getPrice();
+        ostringstream transaction;
+        transaction << sTimestamp << " | " << convertUserID(userID) << " | -" << beverages[id].getPrice() << "\t| " << fBalances[userID] << "\t| " << beverages[id].getName(); //(6)
+        fTransactionLines.push_back(make_pair(userID, transaction.str()));
+        fPairs[sales[i]] = true;
+    }
+    vector<string> fJournalLines;
+    for (map<pair<int, int>, bool>::const_iterator it = fPairs.begin(); it != fPairs.end(); ++it) { //(4)
+        int userID = it->first.first;
+        int id = it->first.second;
+        fJournalLines.push_back(Journal::saleRecord(userID, users[userID], id, beverages[id], day, totals));
+    }
+    phaseStart = latency.record(LatencyStats::SaleFormat, phaseStart);
+    if (batchActive) { // im Stapelbetrieb reicht der Snapshot am Ende, die Zeilen werden bis dahin zurückgehalten
+        batchTransactionLines.insert(batchTransactionLines.end(), fTransactionLines.begin(), fTransactionLines.end());
+    }
+    else {
+        persistence.batchEntry(fJournalLines, fTransactionLines); //(7)
+    }
+    latency.record(LatencyStats::SaleSubmit, phaseStart);
+    return true;
+}
+
+/**\brief Lädt das Konto eines Nutzers mit Bargeld auf
+ * \Der Betrag wird dem Nutzer gutgeschrieben und dem Geld in der Kasse (vBalance) hinzugefügt.
+ * \Anschließend wird die Einzahlung in depositlog.txt und transactionlog.txt niedergeschrieben und die veränderten Objekte werden über das Journal gesichert (alles im Schreib-Thread).
+ * \param userID, amount (muss positiv sein), transactionID (siehe newTransactionID), error
+ * \return bool
+ */
+bool PosEngine::deposit(int userID, Money amount, string transactionID, string &error) {
+    if (userID < 0 || userID >= users.size()) {
+        error = "Unbekannter Nutzer";
+        return false;
+    }
+    if (amount <= Money()) {
+        error = "Ungültiger Betrag!";
+        return false;
+    }
+    LatencyStats::Clock::time_point phaseStart = LatencyStats::Clock::now();
+    users[userID].setBalance(-amount);
+    system.setvBalance(system.getvBalance() + amount);
+    users[userID].setTotals(users[userID].getConsumed(), users[userID].getSpent(), users[userID].getDeposited() + amount);
+    int day = today();
+    DayTotals totals = system.getDayTotals(day);
+    totals.deposits++;
+    totals.deposited += amount;
+    system.setDayTotals(day, totals);
+    phaseStart = latency.record(LatencyStats::DepositApply, phaseStart);
+    ostringstream deposit; //Transaktion in desositlog schreiben
+    deposit << transactionID << " | " << users[userID].getName() << "\t| +" << amount << "\t| " << system.getvBalance();
+    ostringstream transaction; //Transaktion in transactionlog schreiben
+    transaction << logStamp() << " | " << convertUserID(userID) << " | +" << amount << "\t| " << users[userID].getBalance() << "\t| " << "AUFLADUNG";
+    string journalLine = Journal::depositRecord(userID, users[userID], system.getvBalance(), day, totals);
+    phaseStart = latency.record(LatencyStats::DepositFormat, phaseStart);
+    depositLogEntry(deposit.str());
+    transactionLogEntry(userID, transaction.str());
+    journalEntry(journalLine);
+    latency.record(LatencyStats::DepositSubmit, phaseStart);
+    return true;
+}
+
+/**\brief Entnimmt Geld aus der Kasse (Kassensturz)
+ * Die Entnahme wird mit negativem Betrag in depositlog.txt vermerkt, damit der Kassenstand dort lückenlos nachgerechnet werden kann (siehe LedgerAudit).
+ * \param amount (muss positiv und höchstens so groß wie vBalance sein), error
+ * \return bool
+ */
+bool PosEngine::withdraw(Money amount, string &error) {
+    if (amount <= Money() || system.getvBalance() < amount) {
+        error = "Nicht genug Geld in der Kasse...";
+        return false;
+    }
+    system.setvBalance(system.getvBalance() - amount);
+    ostringstream withdrawal;
+    withdrawal << "00" << logStamp() << "-" << "Entnahme durch Admin\t| -" << amount << "\t| " << system.getvBalance();
+    depositLogEntry(withdrawal.str());
+    journalEntry(Journal::vBalanceRecord(system.getvBalance()));
+    return true;
+}
+
+/**\brief Bucht eine Lieferung: der Bestand steigt um bottles, der neue Bestand gilt als Referenz für den Verbrauch (getconsumption)
+ * \param id (GetränkeID), bottles (Anzahl der gelieferten Flaschen, > 0), error
+ * \return bool
+ */
+bool PosEngine::restock(int id, int bottles, string &error) {
+    if (id < 0 || id >= beverages.size() || bottles <= 0) {
+        error = "Unbekanntes Getränk, oder die Anzahl der hinzuzufügenden Getränke ist kleiner/gleich 0";
+        return false;
+    }
+    beverages[id].setLastOrder(beverages[id].getStock() + bottles);
+    beverages[id].setStock(beverages[id].getStock() + bottles);
+    journalEntry(Journal::restockRecord(id, beverages[id].getStock(), beverages[id].getLastOrder()));
+    return true;
+}
+
+/**\brief Setzt einen neuen Getränkepreis (Name und Barcode bleiben gleich, die Indizes also auch)
+ * \param id (GetränkeID), price, error
+ * \return bool
+ */
+bool PosEngine::setPrice(int id, Money price, string &error) {
+    if (id < 0 || id >= beverages.size()) {
+        error = "Unbekanntes Getränk";
+        return false;
+    }
+    beverages[id].editPrice(price);
+    journalEntry(Journal::priceRecord(id, beverages[id].getPrice()));
+    return true;
+}
+
+/**\brief Leert die Einzahlungsliste (nach einem Kassensturz); übrig bleibt nur eine Zeile mit dem aktuellen Geld in der Kasse
+ */
+void PosEngine::clearDepositLog() {
+    ostringstream depositlog;
+    depositlog << "00" << logStamp() << "-" << "Abbuchung durch Admin; neuer Kontostand [€]: " << system.getvBalance() << "\n";
+    depositlog << "---";
+    if (batchActive) { // ältere zurückgehaltene Einzahlungen wären mit dem Zurücksetzen ohnehin verloren
+        batchDepositReset = true;
+        batchDepositResetLine = depositlog.str();
+        batchDepositLines.clear();
+    }
+    else {
+        persistence.resetDepositLog(depositlog.str());
+    }
+}
+
+//
+// Verwaltung
+//
+
+/**\brief Legt einen neuen Nutzer an (ID = bisherige Anzahl der Nutzer)
+ * \param name (muss eindeutig sein), role (0, 1 oder 2), error
+ * \return bool
+ */
+bool PosEngine::addUser(string name, int role, string &error) {
+    if (userNames.find(name) >= 0) {
+        error = "Der eingegebene Name existiert bereits!";
+        return false;
+    }
+    if (role < 0 || role > 2) {
+        error = "Die eingegebene Rolle ist nicht gültig!";
+        return false;
+    }
+    User newuser;
+    newuser.createUser(name,role);
+    users.push_back(newuser);
+    userNames.insert(name, users.size() - 1);
+    userPrefixes.insert(name, users.size() - 1);
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Löscht einen Nutzer; alle folgenden Nutzer rücken eine ID nach vorne (daher Snapshot statt Journal)
+ * In deletionlog.txt wird das Löschen vermerkt, damit die Prüfung der Guthaben die folgenden Nutzer ab hier unter ihrer neuen ID weiterführt (siehe LedgerAudit).
+ * \param id, error
+ * \return bool
+ */
+bool PosEngine::deleteUser(int id, string &error) {
+    if (id < 0 || id >= users.size()) {
+        error = "Unbekannter Nutzer";
+        return false;
+    }
+    ostringstream deletion;
+    deletion << logStamp() << " | " << convertUserID(id) << " | " << users[id].getName();
+    if (userNames.find(users[id].getName()) == id) {
+        userNames.erase(users[id].getName());
+    }
+    userNames.removeSlot(id);
+    userPrefixes.erase(users[id].getName(), id);
+    userPrefixes.removeSlot(id);
+    users.erase(users.begin() + id);
+    persistence.deletionLogEntry(deletion.str());
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Benennt einen Nutzer um
+ * Zu kurze Namen werden von User::editName ignoriert; der tatsächliche Name steht danach in getUsers()[id].getName().
+ * \param id, name (muss eindeutig sein), error
+ * \return bool
+ */
+bool PosEngine::renameUser(int id, string name, string &error) {
+    if (id < 0 || id >= users.size()) {
+        error = "Unbekannter Nutzer";
+        return false;
+    }
+    if (userNames.find(name) >= 0) {
+        error = "Der eingegebene Name existiert bereits!";
+        return false;
+    }
+    if (userNames.find(users[id].getName()) == id) {
+        userNames.erase(users[id].getName());
+    }
+    userPrefixes.erase(users[id].getName(), id);
+    users[id].editName(name);
+    userNames.insert(users[id].getName(), id);
+    userPrefixes.insert(users[id].getName(), id);
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Ändert die Rolle eines Nutzers
+ * \param id, role (>= 0), error
+ * \return bool
+ */
+bool PosEngine::setRole(int id, int role, string &error) {
+    if (id < 0 || id >= users.size() || role < 0) {
+        error = "Falsche Paramter für 'setrole'...";
+        return false;
+    }
+    users[id].editRole(role);
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Legt ein neues Getränk an (ID = bisherige Anzahl der Getränke, Bestand 0)
+ * \param name, price, barcode (Name und Barcode müssen eindeutig sein), error
+ * \return bool
+ */
+bool PosEngine::addBeverage(string name, Money price, long long barcode, string &error) {
+    if (beverageNames.find(name) >= 0 || beverageBarcodes.find(barcode) >= 0) {
+        error = "Getränk mit dem gewünschten Namen oder Barcode existiert bereits!";
+        return false;
+    }
+    Beverage newbeverage;
+    newbeverage.createBeverage(name,price,barcode);
+    beverages.push_back(newbeverage);
+    beverageNames.insert(name, beverages.size() - 1);
+    beverageBarcodes.insert(barcode, beverages.size() - 1);
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Löscht ein Getränk ohne Bestand; alle folgenden Getränke rücken eine ID nach vorne
+ * \param id, error
+ * \return bool
+ */
+bool PosEngine::deleteBeverage(int id, string &error) {
+    if (id < 0 || id >= beverages.size()) {
+        error = "Unbekanntes Getränk";
+        return false;
+    }
+    if (beverages[id].getStock() != 0) {
+        error = "Getränk kann nicht gelöscht werden, es gibt noch Bestand!";
+        return false;
+    }
+    if (beverageNames.find(beverages[id].getName()) == id) {
+        beverageNames.erase(beverages[id].getName());
+    }
+    if (beverageBarcodes.find(beverages[id].getBarcode()) == id) {
+        beverageBarcodes.erase(beverages[id].getBarcode());
+    }
+    beverageNames.removeSlot(id);
+    beverageBarcodes.removeSlot(id);
+    beverages.erase(beverages.begin() + id);
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Benennt ein Getränk um
+ * \param id, name (muss eindeutig sein), error
+ * \return bool
+ */
+bool PosEngine::renameBeverage(int id, string name, string &error) {
+    if (id < 0 || id >= beverages.size()) {
+        error = "Unbekanntes Getränk";
+        return false;
+    }
+    if (beverageNames.find(name) >= 0) {
+        error = "Getränk mit dem gewünschten Namen existiert bereits!";
+        return false;
+    }
+    if (beverageNames.find(beverages[id].getName()) == id) {
+        beverageNames.erase(beverages[id].getName());
+    }
+    beverages[id].editName(name);
+    beverageNames.insert(beverages[id].getName(), id);
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Setzt ein neues globales Passwort (zu kurze Passwörter werden von System::setPassword ignoriert)
+ * \return bool (false, wenn das Passwort nicht geändert wurde)
+ */
+bool PosEngine::setPassword(string password) {
+    string oldpw = system.getPassword();
+    system.setPassword(password);
+    if (system.getPassword() == oldpw) {
+        return false;
+    }
+    saveSnapshot();
+    return true;
+}
+
+/**\brief Setzt die Durability (0, 1 oder 2); der Schreib-Thread übernimmt die neue Stufe mit dem Snapshot
+ * \return bool (false bei ungültiger Stufe)
+ */
+bool PosEngine::setDurability(int durability) {
+    if (durability < 0 || durability > 2) {
+        return false;
+    }
+    system.setDurability(durability);
+    saveSnapshot();
+    return true;
+}
+
+//
+// Historie und Statistik
+//
+
+/**\brief Öffnet eine Ansicht mit allen Buchungen eines Nutzers aus einem Zeitraum, neueste zuerst (siehe Persistence::openUserTransactions)
+ * \param userID, fromDay, toDay (JJJJMMTT, jeweils einschließlich; 0 bis 99991231 für alle Buchungen), view
+ */
+void PosEngine::openUserTransactions(int userID, int fromDay, int toDay, LogView &view) {
+    persistence.openUserTransactions(userID, fromDay, toDay, view);
+}
+
+/**\brief Öffnet eine Ansicht mit allen Einzahlungen aus einem Zeitraum (siehe Persistence::openDeposits)
+ * \param fromDay, toDay (JJJJMMTT, jeweils einschließlich; 0 bis 99991231 für alle Einzahlungen), view
+ */
+void PosEngine::openDeposits(int fromDay, int toDay, LogView &view) {
+    persistence.openDeposits(fromDay, toDay, view);
+}
+
+/**\brief Erstellt die Verbrauchsliste (Kommando getconsumption)
+ * Pro Getränk zeigt ein Balken aus 25 Zeichen, wie viel vom Bestand nach der letzten Bestellung noch übrig ist.
+ * \return vector<string> (eine Zeile pro Getränk, dazu Kopf- und Fußzeile)
+ */
+vector<string> PosEngine::getConsumption() const {
+    vector<string> fLines;
+    fLines.push_back("|=====Verbrauchsliste=====|");
+    for (int i=0; i < beverages.size(); i++) {
+        if (beverages[i].getLastOrder() > 0) {
+            double stock = beverages[i].getStock();
+            double lastOrder = beverages[i].getLastOrder();
+            double reference = 25 * (stock / lastOrder);
+            char cBar[26];
+            for (int i = 1; i <= 25; i++) {
+                if (i < reference) {
+                    if (i+1 < reference || i == 24){
+                        cBar[i-1] = '=';
+                    }
+                    else {
+                        cBar[i-1] = '<';
+                    }
+                }
+                else {
+                    if (reference == 25) {
+                        cBar[i-1] = '=';
+                    }
+                    else {
+                        cBar[i-1] = ' ';
+                    }
+                }
+            }
+            cBar[25] = '\0';
+            string sBar(cBar);
+            fLines.push_back("|" + sBar + "| " + beverages[i].getName() + " (" + to_string(beverages[i].getStock()) + "/" + to_string(beverages[i].getLastOrder()) + ")"
+                             + " - " + to_string(beverages[i].getSold()) + " verkauft, " + beverages[i].getRevenue().toString() + "€");
+        }
+        else {
+            fLines.push_back("Noch keine Bestellung von " + beverages[i].getName() + " vorhanden... (" + to_string(beverages[i].getSold()) + " verkauft, " + beverages[i].getRevenue().toString() + "€)");
+        }
+    }
+    fLines.push_back("|===Ende Verbrauchsliste==|");
+    return fLines;
+}
+
+/**\brief Summiert die Umsätze aller Tage eines Zeitraums (direkt aus den mitgeführten Tagessummen, ohne die Logs zu lesen)
+ * \param fromDay, toDay (JJJJMMTT, jeweils einschließlich)
+ * \return DayTotals
+ */
+DayTotals PosEngine::getSalesTotals(int fromDay, int toDay) const {
+    DayTotals sum;
+    const map<int, DayTotals> &days = system.getDays();
+    for (map<int, DayTotals>::const_iterator it = days.lower_bound(fromDay); it != days.end() && it->first <= toDay; ++it) {
+        sum.sales += it->second.sales;
+        sum.revenue += it->second.revenue;
+        sum.deposits += it->second.deposits;
+        sum.deposited += it->second.deposited;
+    }
+    return sum;
+}
+
+/**\brief Erstellt die Umsatzliste eines Zeitraums: eine Zeile pro Tag mit Buchungen und die Summe
+ * \param fromDay, toDay (JJJJMMTT, jeweils einschließlich)
+ * \return vector<string> (Zeilen der Ausgabe)
+ */
+vector<string> PosEngine::getSalesReport(int fromDay, int toDay) const {
+    vector<string> fLines;
+    char line[128];
+    fLines.push_back("|=====Umsätze " + to_string(fromDay) + " bis " + to_string(toDay) + "=====|");
+    const map<int, DayTotals> &days = system.getDays();
+    for (map<int, DayTotals>::const_iterator it = days.lower_bound(fromDay); it != days.end() && it->first <= toDay; ++it) {
+        snprintf(line, sizeof(line), "%d: %6d Flaschen %10s€ | %4d Einzahlungen %10s€", it->first, it->second.sales, it->second.revenue.toString().c_str(),
+                 it->second.deposits, it->second.deposited.toString().c_str());
+        fLines.push_back(line);
+    }
+    DayTotals sum = getSalesTotals(fromDay, toDay);
+    snprintf(line, sizeof(line), "Summe:    %6d Flaschen %10s€ | %4d Einzahlungen %10s€", sum.sales, sum.revenue.toString().c_str(),
+             sum.deposits, sum.deposited.toString().c_str());
+    fLines.push_back(line);
+    return fLines;
+}
+
+/**\brief Erstellt die Liste der Nutzer mit den meisten gekauften Flaschen (aus den mitgeführten Summen der Nutzer)
+ * \param count (höchstens so viele Nutzer)
+ * \return vector<string> (Zeilen der Ausgabe)
+ */
+vector<string> PosEngine::getUserReport(int count) const {
+    vector<pair<int, int> > fRanking; // gekaufte Flaschen (negativ, damit die meisten vorne stehen) -> NutzerID
+    for (int i=0; i < users.size(); i++) {
+        if (users[i].getConsumed() > 0 || users[i].getDeposited() > Money()) {
+            fRanking.push_back(make_pair(-users[i].getConsumed(), i));
+        }
+    }
+    count = min(max(count, 0), (int) fRanking.size());
+    partial_sort(fRanking.begin(), fRanking.begin() + count, fRanking.end());
+    vector<string> fLines;
+    char line[128];
+    fLines.push_back("|=====Nutzer mit den meisten Flaschen=====|");
+    for (int i=0; i < count; i++) {
+        const User &user = users[fRanking[i].second];
+        snprintf(line, sizeof(line), "%3d | %-20s %6d Flaschen %10s€ | eingezahlt %10s€", fRanking[i].second, user.getName().c_str(), user.getConsumed(),
+                 user.getSpent().toString().c_str(), user.getDeposited().toString().c_str());
+        fLines.push_back(line);
+    }
+    return fLines;
+}
+
+/**\brief Wertet transactionlog.txt (inklusive der versiegelten Monate) für einen Zeitraum über den Spaltenspeicher aus
+ * Anders als die mitgeführten Summen (getSalesReport) kann so jeder Zeitraum nach Getränken und Nutzern aufgeschlüsselt werden.
+ * \param fromDay, toDay (JJJJMMTT, jeweils einschließlich), count (Länge der Ranglisten)
+ * \return vector<string> (Zeilen der Ausgabe)
+ */
+vector<string> PosEngine::getAnalysis(int fromDay, int toDay, int count) {
+    long long from = ColumnStore::dayStart(fromDay / 10000, fromDay / 100 % 100, fromDay % 100);
+    long long to = ColumnStore::dayStart(toDay / 10000, toDay / 100 % 100, toDay % 100 + 1);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ColumnReport report = persistence.analyze(from, to, count);
+    long long elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    vector<string> fLines;
+    char line[128];
+    fLines.push_back("|=====Auswertung " + to_string(fromDay) + " bis " + to_string(toDay) + "=====|");
+    for (int i=0; i < report.revenuePerDay.size(); i++) {
+        snprintf(line, sizeof(line), "%d: %10s€", report.revenuePerDay[i].first, report.revenuePerDay[i].second.toString().c_str());
+        fLines.push_back(line);
+    }
+    snprintf(line, sizeof(line), "Umsatz: %s€, Einzahlungen: %s€, %llu Buchungen", report.revenue.toString().c_str(), report.deposited.toString().c_str(), report.rows);
+    fLines.push_back(line);
+    fLines.push_back("Meistverkaufte Getränke:");
+    for (int i=0; i < report.bottlesPerBeverage.size(); i++) {
+        snprintf(line, sizeof(line), "  %-20s %8lld Flaschen", report.bottlesPerBeverage[i].first.c_str(), report.bottlesPerBeverage[i].second);
+        fLines.push_back(line);
+    }
+    fLines.push_back("Nutzer mit den höchsten Käufen:");
+    for (int i=0; i < report.spendPerUser.size(); i++) {
+        int userID = report.spendPerUser[i].first;
+        snprintf(line, sizeof(line), "  %3d %-20s %10s€", userID, userID < users.size() ? users[userID].getName().c_str() : "?", report.spendPerUser[i].second.toString().c_str());
+        fLines.push_back(line);
+    }
+    snprintf(line, sizeof(line), "(%d Blöcke durchsucht, %d übersprungen, %.2f ms)", report.scannedChunks, report.skippedChunks, elapsed / 1000.0);
+    fLines.push_back(line);
+    return fLines;
+}
+
+/**\brief Bereitet eine Prüfung von transactionlog.txt und depositlog.txt gegen die aktuellen Guthaben und den Kassenstand vor
+ * Das Ergebnis kann mit LedgerAudit::run auch in einem anderen Thread geprüft werden (z.B. im Hintergrund beim Start der GUI).
+ * \return LedgerAudit
+ */
+LedgerAudit PosEngine::prepareAudit() {
+    LedgerAudit fAudit;
+    persistence.prepareAudit(users, system, fAudit);
+    return fAudit;
+}
+
+/**\brief Prüft transactionlog.txt und depositlog.txt gegen die aktuellen Guthaben und den Kassenstand (siehe LedgerAudit)
+ * \param threads (0: so viele wie Prozessorkerne)
+ * \return vector<string> (Ergebnis mit den abweichenden Zeilen)
+ */
+vector<string> PosEngine::audit(int threads) {
+    if (threads <= 0) {
+        threads = max(1u, std::thread::hardware_concurrency());
+    }
+    return prepareAudit().run(threads).toLines(100);
+}
+
+/**\brief Gibt die Laufzeitstatistik zurück, damit auch die Oberflächen ihre Phasen (Buttons, Ausloggen) eintragen können
+ * \return LatencyStats&
+ */
+LatencyStats &PosEngine::getLatencyStats() {
+    return latency;
+}
+
+/**\brief Gibt die Anzahl der noch nicht geschriebenen Änderungen zurück
+ */
+int PosEngine::getPendingCount() {
+    return persistence.getPendingCount();
+}
+
+/**\brief Gibt die Anzahl der Änderungen zurück, die nicht geschrieben werden konnten
+ */
+int PosEngine::getFailureCount() {
+    return persistence.getFailureCount();
+}
+
+/**\brief Gibt zurück, wie lange die Logs nach load() im Hintergrund geladen wurden
+ * \return long long (ms; -1, solange sie noch geladen werden)
+ */
+long long PosEngine::getLogLoadTime() {
+    return persistence.getLogLoadTime();
+}
+
+/**\brief Wartet, bis alles geschrieben ist, und gibt die Schreibstatistik von Journal, transactionlog.txt und depositlog.txt zurück
+ */
+vector<LogWriterStats> PosEngine::getLogStats() {
+    persistence.flush();
+    return persistence.getLogStats();
+}
+
+/**\brief Setzt die Schreibstatistik zurück
+ */
+void PosEngine::resetLogStats() {
+    persistence.resetLogStats();
+}
+
+/**\brief Erzeugt die TransaktionsID einer Einzahlung aus NutzerID und Zeitpunkt "JJJJMMTThhmmss" (siehe logStamp)
+ * \return string
+ */
+string PosEngine::newTransactionID(int userID) {
+    return convertUserID(userID) + logStamp();
+}
+
+/**\brief Wandelt die User-ID in einen immer gleich langen String um
+ * \param id (ID des aktiven Users als int)
+ * \return sID (ID als "normalisierter" string)
+ * \warning Diese Methode geht davon aus, dass es nicht mehr als 100 Nutzer gibt!!
+ */
+string PosEngine::convertUserID(int id) {
+    string sID;
+    if (id < 10) { //Um die immer gleiche Länge von TransaktionsIDs zu gewährleisten wird die UserID notfalls um eine Null verlängert
+        sID = "0" + to_string(id);
+    }
+    else {
+        sID = to_string(id);
+    }
+    return sID;
+}
+
+/**\brief Formatiert die aktuelle Ortszeit (z.B. "%Y%m%d" für den Schlüssel der Tagessummen)
+ * \param format (siehe strftime)
+ * \return string
+ */
+string PosEngine::timestamp(const char *format) {
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), format, &local);
+    return buffer;
+}
+
+/**\brief Gibt den Zeitstempel für eine neue Logzeile zurück ("JJJJMMTThhmmss", Ortszeit; siehe LogArchive::parseStamp)
+ * Die Zeitstempel laufen nie rückwärts: wird die Uhr zurückgestellt (oder endet die Sommerzeit), bekommen neue Zeilen solange den Zeitstempel der letzten Zeile.
+ * Das gilt auch über einen Neustart hinweg, da load() den letzten Zeitstempel aus transactionlog.txt und depositlog.txt übernimmt.
+ * Da die Zeilen in derselben Reihenfolge in die Logs geschrieben werden, bleiben die Logs damit nach der Zeit sortiert und Zeiträume können per Binärsuche gefunden werden.
+ * \return string
+ */
+string PosEngine::logStamp() {
+    long long stamp = atoll(timestamp("%Y%m%d%H%M%S").c_str());
+    if (stamp < lastLogStamp) {
+        stamp = lastLogStamp;
+    }
+    lastLogStamp = stamp;
+    return to_string(stamp);
+}
+
+/**\brief Macht aus den Parametern von history bzw. depositlog einen Zeitraum aus Tagen
+ * Monate (JJJJMM) werden auf den ganzen Monat erweitert, Tage (JJJJMMTT) bleiben unverändert.
+ * \param fromDay, toDay (JJJJMM oder JJJJMMTT; werden durch JJJJMMTT ersetzt)
+ */
+void PosEngine::expandDayRange(int &fromDay, int &toDay) {
+    if (fromDay > 0 && fromDay <= 999999) {
+        fromDay = fromDay * 100 + 1;
+    }
+    if (toDay > 0 && toDay <= 999999) {
+        toDay = toDay * 100 + 31;
+    }
+}
+
+/**\brief Gibt das heutige Datum als Zahl zurück (Schlüssel der Tagessummen)
+ * \return int (JJJJMMTT)
+ */
+int PosEngine::today() {
+    return atoi(timestamp("%Y%m%d").c_str());
+}
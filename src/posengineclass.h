@@ -0,0 +1,108 @@
+#include "includes.h"
+
+/**\brief Klasse "PosEngineclass": die eigentliche Getränkekasse ohne Oberfläche
+ * Besitzt alle Nutzer, Getränke und das System samt Persistenz (Snapshot, Journal, Logs) und die Indizes über Namen und Barcodes.
+ * Jede Änderung (Verkauf, Einzahlung, Abbuchung, Bestellung, Verwaltung) läuft über genau eine Methode dieser Klasse,
+ * die zuerst alles prüft, dann die Objekte ändert und die Änderung an den Schreib-Thread übergibt.
+ * Kann eine Änderung nicht durchgeführt werden, wird false zurückgegeben und in error steht ein Hinweis für den Nutzer; es wurde dann nichts verändert.
+ * Die GUI (userwindow) und das Kommandozeilenprogramm (poscli) sind nur noch Oberflächen über dieser Klasse und lesen den Zustand über die const-Zugriffe.
+ * Verwendet kein Qt und wird als eigene Bibliothek (poscore) gebaut.
+ */
+class PosEngine {
+private:
+    // Verwendung eines Vektors um die user/beverage-Objekte abzuspeichern, da ein Array einen gravierenden Nachteil mit sich bringt: Die Größe geht bei der Übergabe an eine Funktion verloren. Es wären also noch weitere Attribute nötig.
+    // Zudem bringt der Vektor einige weitere Vorteile beim Umgang mit den Objekten (dynamische Größe, mehr Funktionen um mit den Objekten zu interagieren...)
+    vector<User> users;
+    vector<Beverage> beverages;
+    System system;
+    Persistence persistence; // schreibt Journal, Snapshot und Logs in einem eigenen Thread; die Textdatenbanken dienen nur noch zum Import/Export
+    // Indizes über Name bzw. Barcode -> Position im Vektor; werden bei jeder Änderung von users/beverages mitgepflegt (siehe rebuildIndexes)
+    HashIndex<string> userNames;
+    HashIndex<string> beverageNames;
+    HashIndex<long long> beverageBarcodes;
+    PrefixIndex userPrefixes; // für die Suche in der Nutzerauswahl
+    LatencyStats latency; // Laufzeiten der Phasen von Verkauf und Einzahlung (Kommando stats)
+    // Stapelbetrieb (siehe beginBatch): Stand beim Beginn für rollbackBatch und die bis commitBatch zurückgehaltenen Logzeilen
+    bool batchActive;
+    vector<User> batchUsers;
+    vector<Beverage> batchBeverages;
+    System batchSystem;
+    vector<pair<int, string> > batchTransactionLines;
+    vector<string> batchDepositLines;
+    bool batchDepositReset;
+    string batchDepositResetLine;
+    long long lastLogStamp; // letzter Zeitstempel in den Logs (JJJJMMTThhmmss), siehe logStamp
+    string logStamp();
+    void rebuildIndexes();
+    void journalEntry(const string &line);
+    void transactionLogEntry(int userID, const string &line);
+    void depositLogEntry(const string &line);
+    bool writeUsersToDB(const vector<User> &fUsers);
+    bool writeBeveragesToDB(const vector<Beverage> &fBeverages);
+    bool writeSystemToDB(const System &fSystem);
+    vector<User> readUsersFromDB();
+    vector<Beverage> readBeveragesFromDB();
+    System readSystemFromDB();
+public:
+    static const char *initialPassword; // Passwort nach dem First-Time-Setup, muss sofort geändert werden
+    PosEngine();
+    ~PosEngine();
+    // Laden und Speichern
+    bool load(string &error);
+    void stop();
+    void saveSnapshot();
+    void flush();
+    bool exportDB();
+    bool importDB();
+    void beginBatch();
+    void commitBatch();
+    void rollbackBatch();
+    bool inBatch() const;
+    // Zugriff auf den Zustand
+    const vector<User> &getUsers() const;
+    const vector<Beverage> &getBeverages() const;
+    const System &getSystem() const;
+    bool needsSetup() const;
+    int findUser(const string &name) const;
+    int findBeverage(const string &name) const;
+    int findBarcode(long long barcode) const;
+    void searchUsers(const string &prefix, vector<int> &slots) const;
+    // Buchungen
+    bool sell(const vector<pair<int, int> > &sales, string &error);
+    bool deposit(int userID, Money amount, string transactionID, string &error);
+    bool withdraw(Money amount, string &error);
+    bool restock(int id, int bottles, string &error);
+    bool setPrice(int id, Money price, string &error);
+    void clearDepositLog();
+    // Verwaltung
+    bool addUser(string name, int role, string &error);
+    bool deleteUser(int id, string &error);
+    bool renameUser(int id, string name, string &error);
+    bool setRole(int id, int role, string &error);
+    bool addBeverage(string name, Money price, long long barcode, string &error);
+    bool deleteBeverage(int id, string &error);
+    bool renameBeverage(int id, string name, string &error);
+    bool setPassword(string password);
+    bool setDurability(int durability);
+    // Historie und Statistik
+    void openUserTransactions(int userID, int fromDay, int toDay, LogView &view);
+    void openDeposits(int fromDay, int toDay, LogView &view);
+    int getPendingCount();
+    int getFailureCount();
+    long long getLogLoadTime();
+    vector<string> getConsumption() const;
+    DayTotals getSalesTotals(int fromDay, int toDay) const;
+    vector<string> getSalesReport(int fromDay, int toDay) const;
+    vector<string> getUserReport(int count) const;
+    vector<string> getAnalysis(int fromDay, int toDay, int count);
+    LedgerAudit prepareAudit();
+    vector<string> audit(int threads);
+    LatencyStats &getLatencyStats();
+    vector<LogWriterStats> getLogStats();
+    void resetLogStats();
+    string newTransactionID(int userID);
+    static string convertUserID(int id);
+    static string timestamp(const char *format);
+    static void expandDayRange(int &fromDay, int &toDay);
+    static int today();
+};
@@ -0,0 +1,77 @@
+#include "includes.h"
+#include "headers.h"
+#include <algorithm>
+
+/**\brief Wandelt einen Namen für den Vergleich in Kleinbuchstaben um
+ * Nur A-Z wird umgewandelt; Umlaute usw. werden byteweise verglichen.
+ * \return string
+ */
+string PrefixIndex::normalize(const string &text) {
+    string result = text;
+    for (size_t i=0; i < result.size(); i++) {
+        if (result[i] >= 'A' && result[i] <= 'Z') {
+            result[i] = result[i] - 'A' + 'a';
+        }
+    }
+    return result;
+}
+
+/**\brief Leert den Index
+ */
+void PrefixIndex::clear() {
+    entries.clear();
+}
+
+/**\brief Trägt einen Namen ein (z.B. nach addusr)
+ * \param name, slot (Position des Nutzers im Vektor)
+ */
+void PrefixIndex::insert(const string &name, int slot) {
+    pair<string, int> entry(normalize(name), slot);
+    entries.insert(lower_bound(entries.begin(), entries.end(), entry), entry);
+}
+
+/**\brief Entfernt einen Namen (z.B. vor delusr oder renusr)
+ * \param name, slot (Position des Nutzers im Vektor)
+ * \return bool (false, wenn der Eintrag fehlt)
+ */
+bool PrefixIndex::erase(const string &name, int slot) {
+    pair<string, int> entry(normalize(name), slot);
+    vector<pair<string, int> >::iterator it = lower_bound(entries.begin(), entries.end(), entry);
+    if (it == entries.end() || *it != entry) {
+        return false;
+    }
+    entries.erase(it);
+    return true;
+}
+
+/**\brief Passt die Positionen an, nachdem ein Nutzer aus dem Vektor gelöscht wurde (alle folgenden rücken eins nach vorne)
+ * Die Sortierung bleibt dabei erhalten, weil sich die Reihenfolge der Positionen untereinander nicht ändert.
+ * \param slot (Position des gelöschten Nutzers; sein Eintrag muss vorher mit erase() entfernt worden sein)
+ */
+void PrefixIndex::removeSlot(int slot) {
+    for (size_t i=0; i < entries.size(); i++) {
+        if (entries[i].second > slot) {
+            entries[i].second--;
+        }
+    }
+}
+
+/**\brief Sucht alle Nutzer, deren Name mit prefix beginnt (Groß-/Kleinschreibung egal)
+ * \param prefix, slots (wird mit den Positionen der Treffer gefüllt, alphabetisch sortiert)
+ */
+void PrefixIndex::find(const string &prefix, vector<int> &slots) const {
+    slots.clear();
+    string key = normalize(prefix);
+    vector<pair<string, int> >::const_iterator it = lower_bound(entries.begin(), entries.end(), pair<string, int>(key, -1));
+    while (it != entries.end() && it->first.compare(0, key.size(), key) == 0) {
+        slots.push_back(it->second);
+        ++it;
+    }
+}
+
+/**\brief Gibt die Anzahl der eingetragenen Namen zurück
+ * \return int
+ */
+int PrefixIndex::size() const {
+    return entries.size();
+}
@@ -0,0 +1,19 @@
+#include "includes.h"
+
+/**\brief Klasse "PrefixIndexclass" für die Suche nach Nutzern über den Anfang ihres Namens
+ * Alle Namen werden in Kleinbuchstaben (nur A-Z) zusammen mit der Position im Vektor users in einem nach Namen sortierten Array gehalten.
+ * Alle Namen mit demselben Anfang stehen darin direkt hintereinander; eine Suche sind also zwei binäre Suchen plus das Kopieren der Treffer.
+ * Einfügen und Löschen verschieben nur den Rest des Arrays, der Index muss also bei addusr, delusr oder renusr nicht neu aufgebaut werden.
+ */
+class PrefixIndex {
+private:
+    vector<pair<string, int> > entries; // (Name in Kleinbuchstaben, Position im Vektor), sortiert
+    static string normalize(const string &text);
+public:
+    void clear();
+    void insert(const string &name, int slot);
+    bool erase(const string &name, int slot);
+    void removeSlot(int slot);
+    void find(const string &prefix, vector<int> &slots) const;
+    int size() const;
+};
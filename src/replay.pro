@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Lastgenerator posreplay: spielt eine transactionlog.txt über die PosEngine nach und prüft danach die Guthaben
+#
+#-------------------------------------------------
+
+TARGET = posreplay
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+OBJECTS_DIR = .obj/replay
+
+LIBS += -L$$OUT_PWD -lposcore -lz
+PRE_TARGETDEPS += $$OUT_PWD/libposcore.a
+
+SOURCES += \
+        replaymain.cpp
@@ -0,0 +1,270 @@
+#include "includes.h"
+#include "headers.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+/**\brief Lastgenerator "posreplay": spielt eine transactionlog.txt über die echte Verkaufs- und Einzahlungslogik (PosEngine) nach
+ * Aus dem Log werden zuerst Textdatenbanken für ein frisches System abgeleitet (ein Nutzer pro NutzerID mit dem Guthaben vor seiner ersten Zeile,
+ * ein Getränk pro Getränkename mit genug Bestand), die PosEngine lädt sie in einem eigenen Arbeitsverzeichnis.
+ * Danach wird jede Zeile in der Reihenfolge des Logs als Verkauf (PosEngine::sell) bzw. AUFLADUNG (PosEngine::deposit) ausgeführt,
+ * entweder so schnell wie möglich oder mit einer festen Rate. Ausgegeben werden Durchsatz und Latenzen (p50/p99/p99.9/max);
+ * bei fester Rate wird ab dem geplanten Startzeitpunkt gemessen, sodass auch Rückstau mitgezählt wird.
+ * Am Ende wird das Guthaben jedes Nutzers mit dem zuletzt geloggten Guthaben verglichen (Rückgabewert 1 bei Abweichungen).
+ * Aufruf: posreplay [--log <transactionlog.txt> | --generate <Zeilen>] [--rate <Buchungen/s>] [--durability <0-2>] [--dir <Verzeichnis>]
+ * Das Verzeichnis muss neu oder leer sein (siehe ScratchDirectory); es wird nach dem Lauf wieder geleert.
+ */
+
+const int replayGeneratedUsers = 100; // Nutzer im generierten Log
+const int replayGeneratedBeverages = 20; // Getränke im generierten Log
+
+/**\brief Eine Zeile aus transactionlog.txt
+ */
+struct ReplayEntry {
+    int userID;
+    Money amount; // Betrag mit Vorzeichen (Verkauf negativ, AUFLADUNG positiv)
+    Money balance; // geloggtes Guthaben nach der Buchung
+    string name; // Getränkename bzw. "AUFLADUNG"
+};
+
+/**\brief Entfernt Leerzeichen und Tabulatoren an Anfang und Ende
+ */
+static string trim(const string &text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    size_t last = text.find_last_not_of(" \t\r");
+    return first == string::npos ? "" : text.substr(first, last - first + 1);
+}
+
+/**\brief Zerlegt eine Zeile "Zeitpunkt | NutzerID | Betrag | Guthaben | Getränk" (auch im alten Format mit Datum und ohne führende Nullen)
+ * \return bool (false bei Zeilen, die keine Buchung sind, z.B. Trennlinien)
+ */
+static bool parseEntry(const string &line, ReplayEntry &entry) {
+    vector<string> fFields;
+    size_t start = 0;
+    for (size_t pos = line.find('|'); fFields.size() < 4; pos = line.find('|', start)) {
+        if (pos == string::npos) {
+            return false;
+        }
+        fFields.push_back(trim(line.substr(start, pos - start)));
+        start = pos + 1;
+    }
+    fFields.push_back(trim(line.substr(start)));
+    char *end;
+    entry.userID = strtol(fFields[1].c_str(), &end, 10);
+    if (fFields[1].empty() || *end != '\0' || entry.userID < 0) {
+        return false;
+    }
+    string sAmount = fFields[2];
+    bool negative = !sAmount.empty() && sAmount[0] == '-';
+    if (!sAmount.empty() && (sAmount[0] == '-' || sAmount[0] == '+')) {
+        sAmount = sAmount.substr(1);
+    }
+    if (!Money::parse(sAmount, entry.amount) || !Money::parse(fFields[3], entry.balance) || fFields[4].empty()) {
+        return false;
+    }
+    if (negative) {
+        entry.amount = -entry.amount;
+    }
+    entry.name = fFields[4];
+    return true;
+}
+
+/**\brief Liest alle Buchungen aus einer Logdatei
+ * \return bool (false, wenn die Datei nicht geöffnet werden konnte)
+ */
+static bool readLog(const string &path, vector<ReplayEntry> &entries, long long &skipped) {
+    ifstream log(path.c_str());
+    if (!log.is_open()) {
+        return false;
+    }
+    string line;
+    while (getline(log, line)) {
+        ReplayEntry entry;
+        if (parseEntry(line, entry)) {
+            entries.push_back(entry);
+        }
+        else if (!trim(line).empty()) {
+            skipped++;
+        }
+    }
+    return true;
+}
+
+/**\brief Erzeugt ein in sich stimmiges Log: wer weniger als 5€ hat, lädt 20€ auf, sonst wird ein zufälliges Getränk gekauft
+ * \param lines, entries
+ */
+static void generateLog(long long lines, vector<ReplayEntry> &entries) {
+    vector<Money> fBalances(replayGeneratedUsers);
+    srand(42);
+    for (long long i=0; i < lines; i++) {
+        ReplayEntry entry;
+        entry.userID = rand() % replayGeneratedUsers;
+        if (fBalances[entry.userID] < Money::fromCents(500)) {
+            entry.amount = Money::fromCents(2000);
+            entry.name = "AUFLADUNG";
+        }
+        else {
+            int id = rand() % replayGeneratedBeverages;
+            entry.amount = -Money::fromCents(80 + 10 * id);
+            entry.name = "drink" + to_string(id);
+        }
+        fBalances[entry.userID] += entry.amount;
+        entry.balance = fBalances[entry.userID];
+        entries.push_back(entry);
+    }
+}
+
+/**\brief Schreibt die Textdatenbanken für den Ausgangszustand des Logs ins aktuelle Verzeichnis
+ * Jeder Nutzer beginnt mit dem Guthaben vor seiner ersten Zeile, jedes Getränk mit dem Preis seines ersten Verkaufs und so viel Bestand, wie verkauft wird.
+ * \param entries, durability, beverageIDs (hier landet Getränkename -> GetränkeID)
+ * \return int (Anzahl der Nutzer)
+ */
+static int writeStartState(const vector<ReplayEntry> &entries, int durability, map<string, int> &beverageIDs) {
+    map<int, Money> fStart;
+    vector<string> fNames;
+    vector<Money> fPrices;
+    vector<int> fStock;
+    int users = 0;
+    for (int i=0; i < entries.size(); i++) {
+        const ReplayEntry &entry = entries[i];
+        users = max(users, entry.userID + 1);
+        if (fStart.find(entry.userID) == fStart.end()) {
+            fStart[entry.userID] = entry.balance - entry.amount;
+        }
+        if (entry.name != "AUFLADUNG") {
+            if (beverageIDs.find(entry.name) == beverageIDs.end()) {
+                beverageIDs[entry.name] = fNames.size();
+                fNames.push_back(entry.name);
+                fPrices.push_back(-entry.amount);
+                fStock.push_back(0);
+            }
+            fStock[beverageIDs[entry.name]]++;
+        }
+    }
+    ofstream userDB("userDB.txt");
+    for (int i=0; i < users; i++) {
+        userDB << "user" << i << ";" << (fStart.count(i) ? fStart[i] : Money()) << ";" << (i == 0 ? 2 : 0) << "\n";
+    }
+    ofstream beverageDB("beverageDB.txt");
+    for (int i=0; i < fNames.size(); i++) {
+        beverageDB << fNames[i] << ";" << fPrices[i] << ";" << 1000 + i << ";" << fStock[i] << ";" << fStock[i] << "\n";
+    }
+    ofstream systemDB("systemDB.txt");
+    systemDB << "1234\n0\n" << durability << "\n";
+    return users;
+}
+
+int main(int argc, char *argv[])
+{
+    string logPath = "transactionlog.txt";
+    long long generate = 0;
+    double rate = 0;
+    int durability = 1;
+    string directory = "posreplay.tmp";
+    for (int i=1; i < argc; i++) {
+        if (strcmp(argv[i], "--log") == 0 && i+1 < argc) {
+            logPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--generate") == 0 && i+1 < argc) {
+            generate = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--rate") == 0 && i+1 < argc) {
+            rate = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--durability") == 0 && i+1 < argc) {
+            durability = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && i+1 < argc) {
+            directory = argv[++i];
+        }
+        else {
+            cerr << "Aufruf: posreplay [--log <transactionlog.txt> | --generate <Zeilen>] [--rate <Buchungen/s>] [--durability <0-2>] [--dir <Verzeichnis>]" << endl;
+            return 2;
+        }
+    }
+
+    vector<ReplayEntry> entries;
+    long long skipped = 0;
+    if (generate > 0) {
+        generateLog(generate, entries);
+    }
+    else if (!readLog(logPath, entries, skipped)) {
+        cerr << logPath << " kann nicht gelesen werden" << endl;
+        return 2;
+    }
+    ScratchDirectory scratch;
+    string error;
+    if (!scratch.enter(directory, "posreplay", error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    map<string, int> beverageIDs;
+    int users = writeStartState(entries, durability, beverageIDs);
+    cout << "Buchungen: " << entries.size() << " (" << skipped << " Zeilen übersprungen), Nutzer: " << users << ", Getränke: " << beverageIDs.size() << endl;
+
+    PosEngine engine;
+    if (!engine.load(error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    engine.flush();
+    LatencyHistogram histogram;
+    long long failed = 0;
+    typedef chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < entries.size(); i++) {
+        const ReplayEntry &entry = entries[i];
+        Clock::time_point opStart = Clock::now();
+        if (rate > 0) { // feste Rate: Latenz ab dem geplanten Zeitpunkt, damit Rückstau nicht verschwiegen wird
+            opStart = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(i / rate));
+            this_thread::sleep_until(opStart);
+        }
+        bool success;
+        if (entry.name == "AUFLADUNG") {
+            success = engine.deposit(entry.userID, entry.amount, engine.newTransactionID(entry.userID), error);
+        }
+        else {
+            int id = beverageIDs[entry.name];
+            if (engine.getBeverages()[id].getPrice() != -entry.amount) { // Preis wurde zwischendurch geändert
+                engine.setPrice(id, -entry.amount, error);
+            }
+            success = engine.sell(vector<pair<int, int> >(1, make_pair(entry.userID, id)), error);
+        }
+        histogram.record(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - opStart).count());
+        if (!success) {
+            failed++;
+        }
+    }
+    double submitSeconds = chrono::duration<double>(Clock::now() - start).count();
+    int backlog = engine.getPendingCount();
+    engine.flush();
+    double totalSeconds = chrono::duration<double>(Clock::now() - start).count();
+
+    printf("Durchsatz: %.0f Buchungen/s übergeben (%.3f s), %.0f Buchungen/s geschrieben (%.3f s, Rückstau am Ende %d)\n",
+           entries.size() / max(submitSeconds, 1e-9), submitSeconds, entries.size() / max(totalSeconds, 1e-9), totalSeconds, backlog);
+    printf("Latenz: p50 %.1f µs | p99 %.1f µs | p99.9 %.1f µs | max %.1f µs\n", histogram.getPercentile(50) / 1000.0,
+           histogram.getPercentile(99) / 1000.0, histogram.getPercentile(99.9) / 1000.0, histogram.getMax() / 1000.0);
+    if (failed > 0 || engine.getFailureCount() > 0) {
+        printf("Fehlgeschlagen: %lld Buchungen, %d Schreibfehler (letzter Hinweis: %s)\n", failed, engine.getFailureCount(), error.c_str());
+    }
+
+    map<int, Money> fExpected; // zuletzt geloggtes Guthaben pro Nutzer
+    for (int i=0; i < entries.size(); i++) {
+        fExpected[entries[i].userID] = entries[i].balance;
+    }
+    int mismatches = 0;
+    for (map<int, Money>::const_iterator it = fExpected.begin(); it != fExpected.end(); ++it) {
+        Money actual = engine.getUsers()[it->first].getBalance();
+        if (actual != it->second) {
+            if (mismatches < 10) {
+                cout << "Abweichung bei Nutzer " << it->first << ": geloggt " << it->second << ", nachgespielt " << actual << endl;
+            }
+            mismatches++;
+        }
+    }
+    cout << "Guthaben geprüft: " << fExpected.size() - mismatches << " von " << fExpected.size() << " Nutzern stimmen" << endl;
+    engine.stop();
+    scratch.leave();
+    return mismatches > 0 || failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include "includes.h"
+#include "headers.h"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**\brief Konstruktor für ScratchDirectory-Objekte
+ */
+ScratchDirectory::ScratchDirectory() {
+    created = false;
+    entered = false;
+}
+
+/**\brief Destruktor: verlässt das Verzeichnis wieder (siehe leave)
+ */
+ScratchDirectory::~ScratchDirectory() {
+    leave();
+}
+
+/**\brief Legt das Arbeitsverzeichnis bei Bedarf an, markiert es und wechselt hinein
+ * Ein vorhandenes Verzeichnis wird nur verwendet, wenn es leer ist oder bereits die Markierung dieses Werkzeugs trägt.
+ * \param nPath (Verzeichnis), owner (Name des Werkzeugs, ergibt die Markierung "."+owner), error (Grund, wenn das Verzeichnis nicht verwendet werden kann)
+ * \return bool (false, wenn das Verzeichnis nicht angelegt, nicht betreten oder wegen fremder Dateien nicht verwendet werden darf)
+ */
+bool ScratchDirectory::enter(const string &nPath, const string &owner, string &error) {
+    leave();
+    path = nPath;
+    marker = "." + owner;
+    created = mkdir(path.c_str(), 0755) == 0;
+    if (!created && errno != EEXIST) {
+        error = "Verzeichnis " + path + " kann nicht angelegt werden: " + strerror(errno);
+        return false;
+    }
+    if (!created) {
+        DIR *dir = opendir(path.c_str());
+        if (!dir) {
+            error = "Verzeichnis " + path + " kann nicht gelesen werden: " + strerror(errno);
+            return false;
+        }
+        bool empty = true;
+        bool marked = false;
+        while (struct dirent *entry = readdir(dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            if (marker == entry->d_name) {
+                marked = true;
+            }
+            empty = false;
+        }
+        closedir(dir);
+        if (!empty && !marked) {
+            error = "Verzeichnis " + path + " ist nicht leer und wurde nicht von " + owner + " angelegt; bitte ein neues oder leeres Verzeichnis angeben";
+            return false;
+        }
+    }
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        error = "Aktuelles Verzeichnis kann nicht bestimmt werden";
+        return false;
+    }
+    previous = cwd;
+    if (chdir(path.c_str()) != 0) {
+        error = "Verzeichnis " + path + " kann nicht verwendet werden: " + strerror(errno);
+        return false;
+    }
+    ofstream markerFile(marker);
+    if (!markerFile.is_open()) {
+        error = "Verzeichnis " + path + " kann nicht beschrieben werden";
+        if (chdir(previous.c_str()) != 0) {
+            error += " (und das vorherige Verzeichnis nicht wieder betreten werden)";
+        }
+        return false;
+    }
+    markerFile.close();
+    entered = true;
+    return true;
+}
+
+/**\brief Löscht alle Dateien im Arbeitsverzeichnis außer der Markierung (Unterverzeichnisse bleiben unberührt)
+ */
+void ScratchDirectory::clear() {
+    if (!entered) {
+        return;
+    }
+    DIR *dir = opendir(".");
+    if (!dir) {
+        return;
+    }
+    while (struct dirent *entry = readdir(dir)) {
+        struct stat info;
+        if (marker != entry->d_name && lstat(entry->d_name, &info) == 0 && !S_ISDIR(info.st_mode)) {
+            unlink(entry->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+/**\brief Löscht alle Dateien samt Markierung, wechselt zurück in das vorherige Verzeichnis und entfernt ein selbst angelegtes Arbeitsverzeichnis
+ */
+void ScratchDirectory::leave() {
+    if (!entered) {
+        return;
+    }
+    clear();
+    unlink(marker.c_str());
+    entered = false;
+    if (chdir(previous.c_str()) == 0 && created) {
+        rmdir(path.c_str());
+    }
+}
@@ -0,0 +1,22 @@
+#include "includes.h"
+
+/**\brief Klasse "ScratchDirectory" für das Arbeitsverzeichnis der Werkzeuge posbench und posreplay
+ * Die Werkzeuge legen dort synthetische Datenbanken und Logs an und löschen sie zwischen den Messungen wieder.
+ * Damit dabei nie fremde Dateien gelöscht werden, wird nur ein neues oder leeres Verzeichnis verwendet und darin eine Markierungsdatei (z.B. ".posbench") angelegt.
+ * Ein Verzeichnis mit dieser Markierung stammt von einem früheren (z.B. abgebrochenen) Lauf desselben Werkzeugs und darf wiederverwendet werden.
+ * Gelöscht werden nur Dateien in einem markierten Verzeichnis; beim Verlassen werden Markierung und ein selbst angelegtes Verzeichnis wieder entfernt.
+ */
+class ScratchDirectory {
+private:
+    string path;
+    string marker;
+    string previous; // Arbeitsverzeichnis vor enter()
+    bool created;
+    bool entered;
+public:
+    ScratchDirectory();
+    ~ScratchDirectory();
+    bool enter(const string &nPath, const string &owner, string &error);
+    void clear();
+    void leave();
+};
@@ -0,0 +1,225 @@
+#include "includes.h"
+#include "headers.h"
+#include <cstring>
+#include <cstdio>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// Aktuelle Version des Segment-Formats
+static const uint32_t segmentVersion = 1;
+// Angestrebte Größe eines Blocks vor der Kompression
+static const size_t segmentBlockSize = 64 * 1024;
+
+struct SegmentHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t blockCount;
+    uint32_t reserved;
+    uint64_t rawSize;
+};
+
+/**\brief Konstruktor für Segment-Objekte
+ */
+Segment::Segment() {
+    fd = -1;
+    rawSize = 0;
+    cachedBlock = -1;
+}
+
+/**\brief Destruktor: schließt ein geöffnetes Segment
+ */
+Segment::~Segment() {
+    close();
+}
+
+/**\brief Komprimiert eine komplette Logdatei in eine Segmentdatei
+ * Die Segmentdatei wird zuerst unter "<Pfad>.tmp" geschrieben und erst danach umbenannt, ein Absturz hinterlässt also nie ein halbes Segment.
+ * \param rawPath (Pfad der Logdatei), segmentPath (Pfad der neuen Segmentdatei)
+ * \return bool (false, wenn die Logdatei nicht gelesen oder das Segment nicht geschrieben werden konnte)
+ */
+bool Segment::compress(string rawPath, string segmentPath) {
+    ifstream rawFile;
+    rawFile.open(rawPath, ios::in | ios::binary);
+    if (!rawFile.is_open()) {
+        return false;
+    }
+    string raw((istreambuf_iterator<char>(rawFile)), istreambuf_iterator<char>());
+    rawFile.close();
+
+    vector<SegmentBlock> fBlocks;
+    string data;
+    size_t start = 0;
+    while (start < raw.size()) {
+        size_t end = min(start + segmentBlockSize, raw.size());
+        if (end < raw.size()) { // Block am letzten Zeilenende davor beenden, überlange Zeilen bleiben ganz
+            size_t newline = raw.rfind('\n', end-1);
+            if (newline == string::npos || newline < start) {
+                newline = raw.find('\n', end);
+            }
+            end = (newline == string::npos) ? raw.size() : newline+1;
+        }
+        uLongf compressedLength = compressBound(end - start);
+        string compressed(compressedLength, '\0');
+        if (compress2((Bytef*) &compressed[0], &compressedLength, (const Bytef*) raw.data() + start, end - start, Z_DEFAULT_COMPRESSION) != Z_OK) {
+            return false;
+        }
+        SegmentBlock block;
+        block.rawOffset = start;
+        block.rawLength = end - start;
+        block.dataOffset = data.size(); // wird unten um Kopf und Blocktabelle verschoben
+        block.dataLength = compressedLength;
+        fBlocks.push_back(block);
+        data.append(compressed, 0, compressedLength);
+        start = end;
+    }
+    SegmentHeader header;
+    memcpy(header.magic, "BSEG", 4);
+    header.version = segmentVersion;
+    header.blockCount = fBlocks.size();
+    header.reserved = 0;
+    header.rawSize = raw.size();
+    uint64_t dataStart = sizeof(SegmentHeader) + fBlocks.size() * sizeof(SegmentBlock);
+    for (int i=0; i < fBlocks.size(); i++) {
+        fBlocks[i].dataOffset += dataStart;
+    }
+
+    string tmpPath = segmentPath + ".tmp";
+    ofstream tmpSegment;
+    tmpSegment.open(tmpPath, ios::out | ios::binary | ios::trunc);
+    if (tmpSegment.is_open()) {
+        tmpSegment.write((const char*) &header, sizeof(header));
+        tmpSegment.write((const char*) fBlocks.data(), fBlocks.size() * sizeof(SegmentBlock));
+        tmpSegment.write(data.data(), data.size());
+    }
+    else {
+        return false;
+    }
+    tmpSegment.close();
+    if (tmpSegment.fail()) {
+        return false;
+    }
+    return rename(tmpPath.c_str(), segmentPath.c_str()) == 0;
+}
+
+/**\brief Öffnet eine Segmentdatei und liest Kopf und Blocktabelle
+ * \return bool (false, wenn die Datei fehlt oder kein gültiges Segment ist)
+ */
+bool Segment::open(string path) {
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    SegmentHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header) || memcmp(header.magic, "BSEG", 4) != 0 || header.version != segmentVersion) {
+        close();
+        return false;
+    }
+    blocks.resize(header.blockCount);
+    size_t tableSize = blocks.size() * sizeof(SegmentBlock);
+    if (pread(fd, blocks.data(), tableSize, sizeof(header)) != (ssize_t) tableSize) {
+        close();
+        return false;
+    }
+    rawSize = header.rawSize;
+    return true;
+}
+
+/**\brief Schließt das Segment und verwirft den entpackten Block
+ */
+void Segment::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    blocks.clear();
+    rawSize = 0;
+    cachedBlock = -1;
+    cache.clear();
+}
+
+/**\brief Gibt die Größe der ursprünglichen Logdatei zurück
+ * \return unsigned long long (Größe in Byte)
+ */
+unsigned long long Segment::getRawSize() {
+    return rawSize;
+}
+
+/**\brief Entpackt einen Block in den Zwischenspeicher, falls er nicht schon darin liegt
+ * \return bool (false, wenn der Block nicht gelesen oder entpackt werden konnte)
+ */
+bool Segment::loadBlock(int index) {
+    if (index == cachedBlock) {
+        return true;
+    }
+    cachedBlock = -1;
+    string compressed(blocks[index].dataLength, '\0');
+    if (pread(fd, &compressed[0], compressed.size(), blocks[index].dataOffset) != (ssize_t) compressed.size()) {
+        return false;
+    }
+    uLongf rawLength = blocks[index].rawLength;
+    cache.resize(rawLength);
+    if (uncompress((Bytef*) &cache[0], &rawLength, (const Bytef*) compressed.data(), compressed.size()) != Z_OK || rawLength != blocks[index].rawLength) {
+        return false;
+    }
+    cachedBlock = index;
+    return true;
+}
+
+/**\brief Liest die Zeile, die in der ursprünglichen Logdatei an einer bestimmten Position begann
+ * Der passende Block wird per binärer Suche in der Blocktabelle gefunden. Aufeinanderfolgende Zeilen aus demselben Block werden nur einmal entpackt.
+ * \param offset (Position der Zeile in der ursprünglichen Logdatei), line (Zeile ohne Zeilenumbruch)
+ * \return bool (false, wenn die Position außerhalb des Segments liegt oder der Block nicht gelesen werden konnte)
+ */
+bool Segment::readLine(unsigned long long offset, string &line) {
+    if (fd < 0 || offset >= rawSize) {
+        return false;
+    }
+    int low = 0;
+    int high = blocks.size() - 1;
+    while (low < high) { // letzter Block mit rawOffset <= offset
+        int mid = (low + high + 1) / 2;
+        if (blocks[mid].rawOffset <= offset) {
+            low = mid;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    if (!loadBlock(low)) {
+        return false;
+    }
+    size_t start = offset - blocks[low].rawOffset;
+    size_t end = cache.find('\n', start);
+    line = cache.substr(start, (end == string::npos) ? string::npos : end - start);
+    return true;
+}
+
+/**\brief Ermittelt die Positionen aller nicht leeren Zeilen des Segments (bezogen auf die ursprüngliche Logdatei)
+ * \param lineOffsets (die Positionen werden angehängt)
+ * \return bool (false, wenn ein Block nicht gelesen werden konnte)
+ */
+bool Segment::readLineOffsets(vector<unsigned long long> &lineOffsets) {
+    if (fd < 0) {
+        return false;
+    }
+    for (int i=0; i < blocks.size(); i++) {
+        if (!loadBlock(i)) {
+            return false;
+        }
+        size_t start = 0;
+        while (start < cache.size()) {
+            size_t end = cache.find('\n', start);
+            if (end == string::npos) {
+                end = cache.size();
+            }
+            if (end > start) {
+                lineOffsets.push_back(blocks[i].rawOffset + start);
+            }
+            start = end + 1;
+        }
+    }
+    return true;
+}
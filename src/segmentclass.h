@@ -0,0 +1,36 @@
+#include "includes.h"
+#include <cstdint>
+
+/**\brief Eintrag der Blocktabelle einer Segmentdatei
+ */
+struct SegmentBlock {
+    uint64_t rawOffset; // Position des Blocks in der ursprünglichen Logdatei
+    uint64_t dataOffset; // Position der komprimierten Daten in der Segmentdatei
+    uint32_t rawLength; // Länge des Blocks vor der Kompression
+    uint32_t dataLength; // Länge der komprimierten Daten
+};
+
+/**\brief Klasse "Segmentclass" für abgeschlossene (versiegelte) Abschnitte einer Logdatei
+ * Ein Segment enthält den kompletten Inhalt der Logdatei eines Zeitraums (z.B. eines Monats), aufgeteilt in Blöcke von ca. 64 KiB, die einzeln mit zlib komprimiert werden.
+ * Blöcke enden immer an einem Zeilenende. Über die Blocktabelle am Anfang der Datei kann eine Zeile an einer bekannten Position der ursprünglichen Logdatei gelesen werden,
+ * ohne das ganze Segment zu entpacken (es wird nur der Block entpackt, in dem die Zeile liegt).
+ * Aufbau der Datei: Kopf (Magic "BSEG", Version, Anzahl der Blöcke, Größe der ursprünglichen Datei), Blocktabelle, komprimierte Blöcke
+ */
+class Segment {
+private:
+    int fd; // -1, solange kein Segment geöffnet ist
+    uint64_t rawSize;
+    vector<SegmentBlock> blocks;
+    int cachedBlock; // Index des zuletzt entpackten Blocks, -1 wenn keiner
+    string cache; // Inhalt des zuletzt entpackten Blocks
+    bool loadBlock(int index);
+public:
+    Segment();
+    ~Segment();
+    static bool compress(string rawPath, string segmentPath);
+    bool open(string path);
+    void close();
+    unsigned long long getRawSize();
+    bool readLine(unsigned long long offset, string &line);
+    bool readLineOffsets(vector<unsigned long long> &lineOffsets);
+};
@@ -0,0 +1,351 @@
+#include "includes.h"
+#include "headers.h"
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Aktuelle Version des Snapshot-Formats
+static const uint32_t snapshotVersion = 6;
+
+// Datensätze mit fester Breite, so wie sie in der Datei liegen
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t userCount;
+    uint32_t beverageCount;
+    uint32_t stringTableSize;
+    uint32_t dayCount; // ab Version 4, davor immer 0
+};
+
+struct SnapshotSystem {
+    uint32_t passwordOffset;
+    uint32_t passwordLength;
+    int64_t vBalance; // ab Version 3 in Cent, davor als double in Euro
+    int32_t durability; // erst ab Version 2 vorhanden
+    uint32_t generation; // ab Version 5, davor immer 0 (siehe Journal::clear)
+};
+
+/**\brief Gibt die Größe des System-Datensatzes einer bestimmten Version zurück
+ * \return size_t (0, wenn die Version unbekannt ist)
+ */
+static size_t systemRecordSize(uint32_t version) {
+    if (version == 1) {
+        return 16;
+    }
+    if (version >= 2 && version <= 6) {
+        return sizeof(SnapshotSystem);
+    }
+    return 0;
+}
+
+struct SnapshotUser {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int64_t balance; // ab Version 3 in Cent, davor als double in Euro
+    int32_t role;
+    int32_t consumed; // ab Version 4, davor immer 0
+    int64_t spent; // ab Version 4 (Cent)
+    int64_t deposited; // ab Version 4 (Cent)
+};
+
+struct SnapshotBeverage {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int64_t price; // ab Version 3 in Cent, davor als double in Euro
+    int32_t shortBarcode; // bis Version 5, ab Version 6 immer 0
+    int32_t stock;
+    int32_t lastOrder;
+    int32_t sold; // ab Version 4, davor immer 0
+    int64_t revenue; // ab Version 4 (Cent)
+    int64_t barcode; // ab Version 6 (EAN-13 passt nicht in int32)
+};
+
+struct SnapshotDay {
+    int32_t day; // JJJJMMTT
+    int32_t sales;
+    int32_t deposits;
+    int32_t reserved;
+    int64_t revenue; // Cent
+    int64_t deposited; // Cent
+};
+
+/**\brief Gibt die Größe eines Nutzer-Datensatzes einer bestimmten Version zurück (bis Version 3 ohne die Summen)
+ */
+static size_t userRecordSize(uint32_t version) {
+    return version < 4 ? 24 : sizeof(SnapshotUser);
+}
+
+/**\brief Gibt die Größe eines Getränke-Datensatzes einer bestimmten Version zurück (bis Version 3 ohne den Umsatz, bis Version 5 ohne den 64-Bit-Barcode)
+ */
+static size_t beverageRecordSize(uint32_t version) {
+    return version < 4 ? 32 : version < 6 ? 40 : sizeof(SnapshotBeverage);
+}
+
+/**\brief Liest einen Betrag aus einem Datensatz
+ * Bis Version 2 wurden Beträge als double (Euro) gespeichert, ab Version 3 als int64 (Cent); beide sind 8 Byte groß.
+ * \return Money
+ */
+static Money readAmount(int64_t stored, uint32_t version) {
+    if (version < 3) {
+        double euros;
+        memcpy(&euros, &stored, sizeof(euros));
+        return Money::fromDouble(euros);
+    }
+    return Money::fromCents(stored);
+}
+
+/**\brief Hängt einen String an die Stringtabelle an
+ * \return uint32_t (Offset des Strings in der Stringtabelle)
+ */
+static uint32_t addString(string &table, string value) {
+    uint32_t offset = table.size();
+    table += value;
+    return offset;
+}
+
+/**\brief Schreibt den kompletten Inhalt, auch wenn write() nur einen Teil auf einmal annimmt
+ * \return bool (false bei einem Schreibfehler)
+ */
+static bool writeAll(int fd, const string &data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t result = ::write(fd, data.data() + written, data.size() - written);
+        if (result < 0) {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+/**\brief Sichert das Verzeichnis einer Datei mit fsync, damit ein rename() auch nach einem Stromausfall gilt
+ * \return bool (false, wenn das Verzeichnis nicht gesichert werden konnte)
+ */
+static bool syncDirectory(const string &file) {
+    size_t slash = file.rfind('/');
+    string directory = slash == string::npos ? "." : (slash == 0 ? "/" : file.substr(0, slash));
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+/**\brief Konstruktor für Snapshot-Objekte
+ * Standardmäßig liegt der Snapshot neben den Datenbanken in "snapshot.bin".
+ */
+Snapshot::Snapshot() {
+    path = "snapshot.bin";
+    generation = 0;
+}
+
+/**\brief Setzt den Pfad des Snapshots
+ * \param nPath (Pfad der Snapshot-Datei)
+ */
+void Snapshot::setPath(string nPath) {
+    path = nPath;
+}
+
+/**\brief Prüft, ob bereits ein Snapshot existiert
+ * \return bool (true, wenn die Datei vorhanden ist)
+ */
+bool Snapshot::exists() {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+}
+
+/**\brief Gibt die Generation des zuletzt gelesenen bzw. geschriebenen Snapshots zurück (0, solange es keinen gibt)
+ * \return unsigned int
+ */
+unsigned int Snapshot::getGeneration() {
+    return generation;
+}
+
+/**\brief Schreibt alle Nutzer, Getränke und die Systemeinstellungen in den binären Snapshot
+ * Der Snapshot wird zuerst komplett im Speicher aufgebaut, dann in eine temporäre Datei geschrieben und erst danach über den alten Snapshot umbenannt.
+ * Ein Absturz während des Schreibens hinterlässt also nie einen halben Snapshot.
+ * Ab Durability 1 wird die temporäre Datei vor dem Umbenennen und danach das Verzeichnis mit fsync gesichert; erst dann darf das Journal geleert werden (siehe Persistence::writeSnapshot).
+ * Der neue Snapshot bekommt die nächste Generation; sie gilt, sobald er umbenannt wurde (auch wenn danach das Sichern des Verzeichnisses fehlschlägt).
+ * \return bool (false, wenn die Datei nicht geschrieben werden konnte)
+ */
+bool Snapshot::write(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    string strings;
+    SnapshotHeader header;
+    memcpy(header.magic, "BPOS", 4);
+    header.version = snapshotVersion;
+    header.userCount = fUsers.size();
+    header.beverageCount = fBeverages.size();
+    header.dayCount = fSystem.getDays().size();
+
+    SnapshotSystem sys;
+    string password = fSystem.getPassword();
+    sys.passwordOffset = addString(strings, password);
+    sys.passwordLength = password.size();
+    sys.vBalance = fSystem.getvBalance().getCents();
+    sys.durability = fSystem.getDurability();
+    sys.generation = generation + 1;
+
+    vector<SnapshotUser> userRecords(fUsers.size());
+    for (int i=0; i < fUsers.size(); i++) {
+        string name = fUsers[i].getName();
+        userRecords[i].nameOffset = addString(strings, name);
+        userRecords[i].nameLength = name.size();
+        userRecords[i].balance = fUsers[i].getBalance().getCents();
+        userRecords[i].role = fUsers[i].getRole();
+        userRecords[i].consumed = fUsers[i].getConsumed();
+        userRecords[i].spent = fUsers[i].getSpent().getCents();
+        userRecords[i].deposited = fUsers[i].getDeposited().getCents();
+    }
+    vector<SnapshotBeverage> beverageRecords(fBeverages.size());
+    for (int i=0; i < fBeverages.size(); i++) {
+        string name = fBeverages[i].getName();
+        beverageRecords[i].nameOffset = addString(strings, name);
+        beverageRecords[i].nameLength = name.size();
+        beverageRecords[i].price = fBeverages[i].getPrice().getCents();
+        beverageRecords[i].shortBarcode = 0;
+        beverageRecords[i].barcode = fBeverages[i].getBarcode();
+        beverageRecords[i].stock = fBeverages[i].getStock();
+        beverageRecords[i].lastOrder = fBeverages[i].getLastOrder();
+        beverageRecords[i].sold = fBeverages[i].getSold();
+        beverageRecords[i].revenue = fBeverages[i].getRevenue().getCents();
+    }
+    vector<SnapshotDay> dayRecords;
+    dayRecords.reserve(header.dayCount);
+    for (map<int, DayTotals>::const_iterator it = fSystem.getDays().begin(); it != fSystem.getDays().end(); ++it) {
+        SnapshotDay record;
+        record.day = it->first;
+        record.sales = it->second.sales;
+        record.deposits = it->second.deposits;
+        record.reserved = 0;
+        record.revenue = it->second.revenue.getCents();
+        record.deposited = it->second.deposited.getCents();
+        dayRecords.push_back(record);
+    }
+    header.stringTableSize = strings.size();
+
+    string data;
+    data.append((const char*) &header, sizeof(header));
+    data.append((const char*) &sys, sizeof(sys));
+    data.append((const char*) userRecords.data(), userRecords.size() * sizeof(SnapshotUser));
+    data.append((const char*) beverageRecords.data(), beverageRecords.size() * sizeof(SnapshotBeverage));
+    data.append((const char*) dayRecords.data(), dayRecords.size() * sizeof(SnapshotDay));
+    data.append(strings);
+
+    bool durable = fSystem.getDurability() >= LogWriter::PerBatch;
+    string tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = writeAll(fd, data) && (!durable || fsync(fd) == 0);
+    written = close(fd) == 0 && written;
+    if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+    generation = sys.generation;
+    return !durable || syncDirectory(path);
+}
+
+/**\brief Liest den binären Snapshot und baut daraus die Nutzer- und Getränkevektoren sowie das System auf
+ * Die Datei wird per mmap eingeblendet; die Datensätze werden direkt aus dem eingeblendeten Speicher kopiert.
+ * Kopf, Version und alle Offsets werden geprüft, bevor etwas übernommen wird. Snapshots älterer Versionen werden ebenfalls gelesen. Bei einem Fehler bleiben die übergebenen Objekte unverändert.
+ * \return bool (false, wenn kein gültiger Snapshot vorhanden ist)
+ */
+bool Snapshot::read(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(SnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = info.st_size;
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    const char *data = (const char*) mapped;
+
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    size_t sysSize = systemRecordSize(header.version);
+    size_t usersStart = sizeof(SnapshotHeader) + sysSize;
+    size_t userSize = userRecordSize(header.version);
+    size_t beverageSize = beverageRecordSize(header.version);
+    if (header.version < 4) {
+        header.dayCount = 0;
+    }
+    size_t beveragesStart = usersStart + (size_t) header.userCount * userSize;
+    size_t daysStart = beveragesStart + (size_t) header.beverageCount * beverageSize;
+    size_t stringsStart = daysStart + (size_t) header.dayCount * sizeof(SnapshotDay);
+    if (memcmp(header.magic, "BPOS", 4) != 0 || sysSize == 0 || stringsStart + header.stringTableSize != size) {
+        munmap(mapped, size);
+        return false;
+    }
+    const char *strings = data + stringsStart;
+    bool valid = true;
+
+    SnapshotSystem sys;
+    sys.durability = System().getDurability(); // Standardwert für Version 1
+    sys.generation = 0;
+    memcpy(&sys, data + sizeof(SnapshotHeader), sysSize);
+    valid = valid && (size_t) sys.passwordOffset + sys.passwordLength <= header.stringTableSize;
+
+    vector<User> tmpUsers(header.userCount);
+    for (uint32_t i=0; valid && i < header.userCount; i++) {
+        SnapshotUser record = SnapshotUser(); // Summen älterer Versionen bleiben 0
+        memcpy(&record, data + usersStart + i * userSize, userSize);
+        valid = (size_t) record.nameOffset + record.nameLength <= header.stringTableSize;
+        if (valid) {
+            tmpUsers[i].editName(string(strings + record.nameOffset, record.nameLength));
+            tmpUsers[i].setBalance(-readAmount(record.balance, header.version));
+            tmpUsers[i].editRole(record.role);
+            tmpUsers[i].setTotals(record.consumed, Money::fromCents(record.spent), Money::fromCents(record.deposited));
+        }
+    }
+    vector<Beverage> tmpBeverages(header.beverageCount);
+    for (uint32_t i=0; valid && i < header.beverageCount; i++) {
+        SnapshotBeverage record = SnapshotBeverage(); // Umsatz älterer Versionen bleibt 0
+        memcpy(&record, data + beveragesStart + i * beverageSize, beverageSize);
+        valid = (size_t) record.nameOffset + record.nameLength <= header.stringTableSize;
+        if (valid) {
+            tmpBeverages[i].editName(string(strings + record.nameOffset, record.nameLength));
+            tmpBeverages[i].editPrice(readAmount(record.price, header.version));
+            tmpBeverages[i].editBarcode(header.version < 6 ? record.shortBarcode : record.barcode);
+            tmpBeverages[i].setStock(record.stock);
+            tmpBeverages[i].setLastOrder(record.lastOrder);
+            tmpBeverages[i].setSales(record.sold, Money::fromCents(record.revenue));
+        }
+    }
+    System tmpSystem;
+    for (uint32_t i=0; valid && i < header.dayCount; i++) {
+        SnapshotDay record;
+        memcpy(&record, data + daysStart + i * sizeof(SnapshotDay), sizeof(record));
+        DayTotals totals;
+        totals.sales = record.sales;
+        totals.revenue = Money::fromCents(record.revenue);
+        totals.deposits = record.deposits;
+        totals.deposited = Money::fromCents(record.deposited);
+        tmpSystem.setDayTotals(record.day, totals);
+    }
+    if (valid) {
+        tmpSystem.setPassword(string(strings + sys.passwordOffset, sys.passwordLength));
+        tmpSystem.setvBalance(readAmount(sys.vBalance, header.version));
+        tmpSystem.setDurability(sys.durability);
+        generation = sys.generation;
+        fSystem = tmpSystem;
+        fUsers.swap(tmpUsers);
+        fBeverages.swap(tmpBeverages);
+    }
+    munmap(mapped, size);
+    return valid;
+}
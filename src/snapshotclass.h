@@ -0,0 +1,28 @@
+#include "includes.h"
+
+/**\brief Klasse "Snapshotclass" für das binäre Speichern aller Nutzer, Getränke und Systemeinstellungen
+ * Der Snapshot ersetzt die drei Textdatenbanken als eigentlichen Speicherort. Die Textdateien werden nur noch für Import/Export verwendet (z.B. bei der Migration einer bestehenden Installation).
+ * Beim Programmstart wird die Datei per mmap eingeblendet, sodass die Vektoren fast ohne Parsen aufgebaut werden können.
+ * Aufbau der Datei (alle Zahlen in fester Breite, Byte-Reihenfolge der Maschine):
+ *      Kopf           Magic "BPOS", Version, Anzahl Nutzer, Anzahl Getränke, Größe der Stringtabelle, Anzahl Tage (ab Version 4)
+ *      System         Offset/Länge des Passworts, Kassenstand, Durability (ab Version 2), Generation (ab Version 5)
+ *      Nutzer[]       Offset/Länge des Namens, Guthaben, Rolle, gekaufte Flaschen, Summe der Käufe und Einzahlungen (ab Version 4)
+ *      Getränke[]     Offset/Länge des Namens, Preis, Barcode (int32, bis Version 5), Bestand, letzte Bestellung, verkaufte Flaschen und Umsatz (ab Version 4), Barcode (int64, ab Version 6)
+ *      Tage[]         Datum (JJJJMMTT), verkaufte Flaschen, Einzahlungen, Umsatz, Summe der Einzahlungen (ab Version 4)
+ *      Stringtabelle  alle Namen und das Passwort direkt hintereinander (ohne Nullterminierung)
+ * Beträge (Kassenstand, Guthaben, Preis) sind ab Version 3 ganze Cent (int64), davor double in Euro.
+ * Die Generation wird bei jedem Schreiben um eins erhöht und steht auch in der Kopfzeile des Journals (siehe Journal::clear); ein Journal, das nicht zum Snapshot gehört, wird nicht angewendet.
+ * Wird das Format geändert, muss die Version erhöht werden; ältere Versionen sollten weiterhin gelesen werden können (ihre Generation ist 0).
+ */
+class Snapshot {
+private:
+    string path;
+    unsigned int generation; // Generation des zuletzt gelesenen bzw. geschriebenen Snapshots
+public:
+    Snapshot();
+    void setPath(string nPath);
+    bool exists();
+    unsigned int getGeneration();
+    bool write(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+    bool read(vector<User> &fUsers, vector<Beverage> &fBeverages, System &fSystem);
+};
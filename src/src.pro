@@ -2,52 +2,24 @@
 #
 # Project created by QtCreator 2019-06-02T20:05:58
 #
+# core: Bibliothek poscore ohne Qt (PosEngine und Persistenz)
+# gui:  die Touch-Oberfläche (userwindow), ein Client von poscore
+# cli:  Kommandozeilenprogramm poscli, ebenfalls ein Client von poscore
+# bench: Benchmark posbench über poscore (wird nicht ausgeliefert)
+# replay: Lastgenerator posreplay über poscore (wird nicht ausgeliefert)
+#
 #-------------------------------------------------
 
-QT       += core gui
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = src
-TEMPLATE = app
-
-# The following define makes your compiler emit warnings if you use
-# any feature of Qt which has been marked as deprecated (the exact warnings
-# depend on your compiler). Please consult the documentation of the
-# deprecated API in order to know how to port your code away from it.
-DEFINES += QT_DEPRECATED_WARNINGS
-
-# You can also make your code fail to compile if you use deprecated APIs.
-# In order to do so, uncomment the following line.
-# You can also select to disable deprecated APIs only up to a certain version of Qt.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-CONFIG += c++11
-
-SOURCES += \
-        beverageclass.cpp \
-        main.cpp \
-        userclass.cpp \
-        userwindow.cpp \
-        systemclass.cpp
-
-HEADERS += \
-        beverageclass.h \
-        headers.h \
-        includes.h \
-        userclass.h \
-        userwindow.h \
-        systemclass.h
-
-FORMS += \
-        userwindow.ui
-
-DESTDIR = ../currentrelease
+TEMPLATE = subdirs
 
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
+SUBDIRS = core gui cli bench replay
 
-RESOURCES += \
-        res.qrc
+core.file = core.pro
+gui.file = gui.pro
+gui.depends = core
+cli.file = cli.pro
+cli.depends = core
+bench.file = bench.pro
+bench.depends = core
+replay.file = replay.pro
+replay.depends = core
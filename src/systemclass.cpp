@@ -1,6 +1,14 @@
 #include "includes.h"
 #include "headers.h"
 
+/**\brief Konstruktor fuer System Objekte
+ * Initialisiert eine leere Kasse; Journal und Logs werden standardmäßig mit einem fsync pro Gruppe gesichert.
+ */
+System::System() {
+    vBalance = Money();
+    durability = 1;
+}
+
 /**\brief Setzt ein neues Passwort
  * \param Es wird der String eines neuen Passwords übergeben
  */
@@ -13,22 +21,61 @@ void System::setPassword(string nPassword) {
 /**\brief Setzt den Kontostand des Systems und stellt sicher, dass es eine Positivkasse bleibt
  * \param Es wird die Zahl des neuen Kontostands übergeben
  */
-void System::setvBalance(double nvBalance) {
-    if (nvBalance >= 0) {
+void System::setvBalance(Money nvBalance) {
+    if (nvBalance >= Money()) {
         vBalance = nvBalance;
     }
 }
 
+/**\brief Setzt die Durability für Journal und Logs
+ * \param Es wird 0 (kein fsync), 1 (fsync pro Gruppe) oder 2 (fsync pro Eintrag) übergeben; andere Werte werden ignoriert
+ */
+void System::setDurability(int nDurability) {
+    if (nDurability >= 0 && nDurability <= 2) {
+        durability = nDurability;
+    }
+}
+
+/**\brief Setzt die Umsätze eines Tages
+ * \param day (JJJJMMTT), totals (neue Summen des Tages)
+ */
+void System::setDayTotals(int day, const DayTotals &totals) {
+    days[day] = totals;
+}
+
 /**\brief Gibt das aktuelle Passwort zurück
  * \return Es wird der String des Passworts zurückgegeben
  */
-string System::getPassword() {
+string System::getPassword() const {
     return password;
 }
 
 /**\brief Gibt den aktuellen Kontostand zurück
  * \return Es wird die Zahl des neuen Kontostands zurückgegeben
  */
-double System::getvBalance() {
+Money System::getvBalance() const {
     return vBalance;
 }
+
+/**\brief Gibt die aktuelle Durability zurück
+ * \return 0 (kein fsync), 1 (fsync pro Gruppe) oder 2 (fsync pro Eintrag)
+ */
+int System::getDurability() const {
+    return durability;
+}
+
+/**\brief Gibt die Umsätze eines Tages zurück
+ * \param day (JJJJMMTT)
+ * \return DayTotals (leer, wenn an dem Tag nichts gebucht wurde)
+ */
+DayTotals System::getDayTotals(int day) const {
+    map<int, DayTotals>::const_iterator it = days.find(day);
+    return it != days.end() ? it->second : DayTotals();
+}
+
+/**\brief Gibt die Umsätze aller Tage mit Buchungen zurück (aufsteigend nach Datum)
+ * \return map<int, DayTotals>& (JJJJMMTT -> Umsätze)
+ */
+const map<int, DayTotals> &System::getDays() const {
+    return days;
+}
@@ -1,5 +1,15 @@
 #include "includes.h"
 
+/**\brief Umsätze eines Tages (laufend mitgeführt, siehe PosEngine::sell und PosEngine::deposit)
+ */
+struct DayTotals {
+    int sales; // verkaufte Flaschen
+    Money revenue; // Umsatz der verkauften Flaschen
+    int deposits; // Anzahl der Einzahlungen
+    Money deposited; // Summe der Einzahlungen
+    DayTotals() { sales = 0; deposits = 0; }
+};
+
 /**\brief Klasse "Systemclass" für das Speichern von Systemweiten Attributen.
  * Die GUI erstellt genau ein Objekt dieser Klasse beim Programmstart.
  * Die Inhalte der Attribute werden in einer Textdatei gesichert und dementsprechend beim Programmstart aus dieser auch gelesen.
@@ -7,11 +17,19 @@
 class System {
 private:
     string password;
-    double vBalance;  //entspricht dem Geld, dass durch das Einzahlen von Nutzergeld bar in der Kasse liegen sollte
+    Money vBalance;  //(in Cent) entspricht dem Geld, dass durch das Einzahlen von Nutzergeld bar in der Kasse liegen sollte
+    int durability; // wie sicher Journal und Logs geschrieben werden (0 = kein fsync, 1 = fsync pro Gruppe, 2 = fsync pro Eintrag)
+    map<int, DayTotals> days; // JJJJMMTT -> Umsätze dieses Tages (nur Tage mit Buchungen)
 public:
+    System();
     void setPassword(string);
-    void setvBalance(double);
-    string getPassword();
-    double getvBalance();
+    void setvBalance(Money);
+    void setDurability(int);
+    void setDayTotals(int day, const DayTotals &totals);
+    string getPassword() const;
+    Money getvBalance() const;
+    int getDurability() const;
+    DayTotals getDayTotals(int day) const;
+    const map<int, DayTotals> &getDays() const;
 };
 
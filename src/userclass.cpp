@@ -7,27 +7,28 @@
  * Initialisiert einen Nutzer ohne Guthaben. Das Geld muss immer manuell hinzugefuegt werden!
  */
 User::User() {
-    balance = 0;
+    balance = Money();
+    consumed = 0;
 }
 
 /**\brief Gibt den Namen eines Nutzers zurueck
  * \return Name als string
  */
-string User::getName() {
+string User::getName() const {
     return name;
 }
 
 /**\brief Gibt den Kontostand eines Nutzers zurueck
- * \return Kontostand als double
+ * \return Kontostand als Money
  */
-double User::getBalance() {
+Money User::getBalance() const {
     return balance;
 }
 
 /**\brief Gibt die Rolle eines Nutzers zurueck
  * \return Rolle als int
  */
-int User::getRole() {
+int User::getRole() const {
     return role;
 }
 
@@ -36,7 +37,7 @@ int User::getRole() {
  * \return bool (quittiert den (Nicht) Erfolg)
  * \warning Damit Einzahlungen und Auszahlungen moeglich sind und trotzdem die Kasse immer positiv bleibt, muss Geld, das hinzugefgt werden soll, als negativer Wert der Funktion bergene werden
  */
-bool User::setBalance(double money) {
+bool User::setBalance(Money money) {
     if (money <= balance) {
         balance -= money;
         return true;
@@ -46,6 +47,38 @@ bool User::setBalance(double money) {
     }
 }
 
+/**\brief Gibt die Anzahl der bisher gekauften Flaschen zurueck
+ * \return Anzahl als int
+ */
+int User::getConsumed() const {
+    return consumed;
+}
+
+/**\brief Gibt die Summe aller Kaeufe zurueck
+ * \return Summe als Money
+ */
+Money User::getSpent() const {
+    return spent;
+}
+
+/**\brief Gibt die Summe aller Einzahlungen zurueck
+ * \return Summe als Money
+ */
+Money User::getDeposited() const {
+    return deposited;
+}
+
+/**\brief Setzt die laufend mitgefuehrten Summen (Verkauf, Einzahlung, Journal und Snapshot)
+ * \param nConsumed gekaufte Flaschen
+ * \param nSpent Summe aller Kaeufe
+ * \param nDeposited Summe aller Einzahlungen
+ */
+void User::setTotals(int nConsumed, Money nSpent, Money nDeposited) {
+    consumed = nConsumed;
+    spent = nSpent;
+    deposited = nDeposited;
+}
+
 /**\brief Setzt den Namen und die Rolle eines neuen Nutzers
  * \param nName Name des neuen Nutzers
  * \param nRole Rolle des neuen Nutzers
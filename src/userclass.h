@@ -11,18 +11,26 @@
 class User {
 private:
     string name; // Name des Nutzers. Sollte einzigartig sein!
-    double balance; // Kontostand des Nutzers. Darf nicht unter 0 sinken!
+    Money balance; // Kontostand des Nutzers (in Cent). Darf nicht unter 0 sinken!
     int role; /**< Rolle soll nur die Werte 0(deaktiviert), 1(Nutzer) & 2(Admin) annehmen können!
                 *  Deaktivierte Nutzer haben den Vorteil, dass sie weiterhin existieren, Notfalls wieder reaktivert werden können und somit der Kontostand immer noch da ist.
                 *  Ein Nutzer besitzt die grundlegenden "Rechte" um mit der Software zu interagieren.
                 *  Ein Admin besitzt höhere "Rechte" und kann die Kasse, Nutzer und die Software verwalten.
                 */
+    // laufend mitgeführte Summen für die Auswertungen (werden bei jedem Verkauf bzw. jeder Einzahlung aktualisiert und im Snapshot gesichert)
+    int consumed; // gekaufte Flaschen
+    Money spent; // Summe aller Käufe
+    Money deposited; // Summe aller Einzahlungen
 public:
     User();
-    string getName();
-    double getBalance();
-    int getRole();
-    bool setBalance(double money);
+    string getName() const;
+    Money getBalance() const;
+    int getRole() const;
+    bool setBalance(Money money);
+    int getConsumed() const;
+    Money getSpent() const;
+    Money getDeposited() const;
+    void setTotals(int nConsumed, Money nSpent, Money nDeposited);
     // the following methods should only be accessible to users with a role value > 1! (~admin)
     void createUser(string nName, int nRole);
     void editName(string nName);
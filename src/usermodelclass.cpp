@@ -0,0 +1,129 @@
+#include "includes.h"
+#include "headers.h"
+#include "usermodelclass.h"
+
+/**\brief Konstruktor für UserModel-Objekte
+ * \param nUsers (Vektor mit allen Nutzern, bleibt im Besitz des Fensters), parent (Qt-Elternobjekt)
+ */
+UserModel::UserModel(const vector<User> *nUsers, QObject *parent) :
+    QAbstractListModel(parent),
+    users(nUsers),
+    userIcon(":/png-user")
+{
+    filtered = false;
+}
+
+/**\brief Liest alle Nutzer neu ein (nach addusr, delusr oder importdb)
+ * Die QListView fragt danach nur die sichtbaren Kacheln ab.
+ */
+void UserModel::reload() {
+    beginResetModel();
+    endResetModel();
+}
+
+/**\brief Zeichnet nur die Kachel eines Nutzers neu (z.B. nach renusr)
+ * \param id (Position des Nutzers im Vektor)
+ */
+void UserModel::updateUser(int id) {
+    if (filtered) {
+        for (int row=0; row < visible.size(); row++) {
+            if (visible[row] == id) {
+                emit dataChanged(index(row), index(row));
+            }
+        }
+    }
+    else if (id >= 0 && id < users->size()) {
+        emit dataChanged(index(id), index(id));
+    }
+}
+
+/**\brief Zeigt nur noch die angegebenen Nutzer an (Treffer einer Suche)
+ * \param slots (Positionen im Vektor, in der Reihenfolge der Anzeige)
+ */
+void UserModel::setFilter(const vector<int> &slots) {
+    beginResetModel();
+    filtered = true;
+    visible = slots;
+    endResetModel();
+}
+
+/**\brief Zeigt wieder alle Nutzer an
+ */
+void UserModel::clearFilter() {
+    beginResetModel();
+    filtered = false;
+    visible.clear();
+    endResetModel();
+}
+
+/**\brief Rechnet eine Zeile der Ansicht in die Position des Nutzers im Vektor um
+ * \return int (-1 bei einer ungültigen Zeile)
+ */
+int UserModel::getUserID(int row) const {
+    if (row < 0 || row >= rowCount()) {
+        return -1;
+    }
+    return filtered ? visible[row] : row;
+}
+
+/**\brief Markiert einen Nutzer für eine Runde bzw. hebt die Markierung auf
+ * \param id (Position des Nutzers im Vektor)
+ */
+void UserModel::toggleMarked(int id) {
+    if (marked.count(id)) {
+        marked.erase(id);
+    }
+    else {
+        marked[id] = true;
+    }
+    updateUser(id);
+}
+
+/**\brief Hebt alle Markierungen auf (z.B. nach addusr/delusr, da sich die Positionen verschieben)
+ */
+void UserModel::clearMarked() {
+    beginResetModel();
+    marked.clear();
+    endResetModel();
+}
+
+/**\brief Gibt alle markierten Nutzer zurück
+ * \return vector<int> (Positionen im Vektor, aufsteigend)
+ */
+vector<int> UserModel::getMarked() const {
+    vector<int> fMarked;
+    for (map<int, bool>::const_iterator it = marked.begin(); it != marked.end(); ++it) {
+        fMarked.push_back(it->first);
+    }
+    return fMarked;
+}
+
+/**\brief Gibt die Anzahl der Nutzer zurück
+ * \return int
+ */
+int UserModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return filtered ? visible.size() : users->size();
+}
+
+/**\brief Gibt Name (DisplayRole), Icon (DecorationRole) bzw. die Markierung für eine Runde (CheckStateRole) einer Kachel zurück
+ * \return QVariant (leer für andere Rollen)
+ */
+QVariant UserModel::data(const QModelIndex &index, int role) const {
+    int id = index.isValid() ? getUserID(index.row()) : -1;
+    if (id < 0 || id >= users->size()) {
+        return QVariant();
+    }
+    if (role == Qt::DisplayRole) {
+        return QString::fromStdString((*users)[id].getName());
+    }
+    if (role == Qt::DecorationRole) {
+        return userIcon;
+    }
+    if (role == Qt::CheckStateRole && !marked.empty()) {
+        return marked.count(id) ? Qt::Checked : Qt::Unchecked;
+    }
+    return QVariant();
+}
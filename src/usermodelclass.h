@@ -0,0 +1,35 @@
+#include <QAbstractListModel>
+#include <QIcon>
+#include "includes.h"
+
+/**\brief Klasse "UserModelclass" als Qt-Model für die Nutzerauswahl
+ * Liest Namen direkt aus dem Vektor users des Fensters; es werden keine Widgets pro Nutzer angelegt.
+ * Eine QListView im IconMode zeichnet davon nur die gerade sichtbaren Kacheln. Icon und Schrift werden einmal geladen und für alle Kacheln verwendet.
+ * Nach jeder Änderung am Vektor muss reload() (Nutzer hinzugefügt/gelöscht) oder updateUser() (Nutzer umbenannt) aufgerufen werden.
+ * Mit setFilter() werden nur die Treffer einer Suche angezeigt; getUserID() rechnet dann die Zeile in die Position im Vektor um.
+ * Für eine Runde können Nutzer markiert werden (Häkchen auf der Kachel); die Markierung bleibt auch beim Filtern erhalten.
+ */
+class UserModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit UserModel(const vector<User> *nUsers, QObject *parent = nullptr);
+    void reload();
+    void updateUser(int id);
+    void setFilter(const vector<int> &slots);
+    void clearFilter();
+    int getUserID(int row) const;
+    void toggleMarked(int id);
+    void clearMarked();
+    vector<int> getMarked() const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    const vector<User> *users;
+    QIcon userIcon; // gemeinsames Icon aller Kacheln
+    bool filtered;
+    vector<int> visible; // Positionen der angezeigten Nutzer, wenn gefiltert wird
+    map<int, bool> marked; // markierte Nutzer (Runde)
+};
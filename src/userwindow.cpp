@@ -5,21 +5,40 @@
 #include <QDateTime>
 #include <QTimer>
 #include <QFont>
+#include <QApplication>
+#include <QKeyEvent>
+
+const int persistenceBacklogWarning = 10; // ab so vielen noch nicht geschriebenen Änderungen wird unten links ein Hinweis angezeigt
+const int barcodeKeyTimeout = 500; // liegen mehr ms zwischen zwei Ziffern, beginnt ein neuer Barcode (Reste einer abgebrochenen Eingabe werden verworfen)
 
 /**\brief Konstruktor der UI
  * Erstellt die UI mit bestimmten Einstllungen.
  * Es wird zum Beispiel die Startseite, Schriftarten, der Text in Textfeldern und der Status von Buttons festgelegt.
- * Anschließend werden die Datenbanken gelesen und aus den daraus gewonnen Informationen noch die Buttons für die Nutzer- und Getränkeauswahl erzeugt.
+ * Anschließend lädt die Engine den gespeicherten Stand (siehe PosEngine::load) und daraus wird die Nutzerauswahl erzeugt; die Logs lädt die Engine danach im Hintergrund.
+ * Die Getränkeauswahl wird erst nach dem ersten angezeigten Bild aufgebaut (siehe finishStartup), die Startseite ist also so früh wie möglich bedienbar.
  * \param QWidget (Widget-Zeug von Qt)
  */
 userwindow::userwindow(QWidget *parent) :
     QMainWindow(parent),
+    system(engine.getSystem()),
+    users(engine.getUsers()),
+    beverages(engine.getBeverages()),
     ui(new Ui::userwindow)
 {
     // globale GUI-Einstellungen
     adminLoggedIn = false;
+    batchRunning = false;
+    auditProblems = 0;
+    auditPending = false;
+    beverageGridPending = false;
+    firstFrameTime = -1;
+    startupTimer.start(); // wird von main() durch den Zeitpunkt vor QApplication ersetzt (siehe setStartupTimer)
     activeUserID = -1; //stellt sicher, dass kein tatsächlich existierender Nutzer aktiv gesetzt ist
+    lowStockCount = 0;
     ui->setupUi(this);
+    beverageMapper = new QSignalMapper(this); // ein Mapper für alle Getränkebuttons, auch über Neuaufbauten des Grids hinweg
+    connect(beverageMapper,SIGNAL(mapped(int)),this,SLOT(beverageButtonPressed(int)));
+    qApp->installEventFilter(this); // Barcodescanner (Tastatur-Emulation) unabhängig davon abfangen, welches Widget den Fokus hat
     QFont latoFont("Lato", 12, QFont::Medium, false); // font for most ui text fields
     QFont courierFont("Courier", 10, QFont::Medium, false); // font for settings- and (transaction)history-window
     ui->label_topNotificationBar->setFont(latoFont);
@@ -27,12 +46,23 @@ userwindow::userwindow(QWidget *parent) :
     ui->label_infobox->setFont(latoFont);
     ui->label_error->setFont(latoFont);
     ui->textBrowser_clOutput->setFont(courierFont);
-    ui->textBrowser_history->setFont(courierFont);
+    ui->listView_history->setFont(courierFont);
+    historyModel = new LogModel(this); // Historie und Einzahlungsliste werden seitenweise aus den Logs nachgeladen
+    ui->listView_history->setModel(historyModel);
+    ui->listView_userselect->setFont(latoFont);
+    ui->lineEdit_usersearch->setFont(latoFont);
+    ui->listView_userselect->setIconSize(QSize(30, 30));
+    ui->listView_userselect->setGridSize(QSize(112, 68)); // Kacheln wie die früheren Buttons (100x60) mit Abstand, 4 pro Zeile
+    userModel = new UserModel(&users, this); // Nutzerkacheln werden direkt aus dem Vektor users gezeichnet
+    ui->listView_userselect->setModel(userModel);
     ui->stackedWidget->setCurrentIndex(0);
     ui->label_topNotificationBar->setText("ags Getränkekasse");
     ui->label_balance->setText("");
     updateMenuButtons(false);
     ui->lineEdit_cl->setEchoMode(QLineEdit::Password);
+    for (int i=0; i < commandCount; i++) { // Kommandozeile: Name -> Eintrag in commandTable
+        commandIndex.insert(commandTable[i].name, i);
+    }
 
     // Digitaluhr
     QTimer *timer = new QTimer(this);
@@ -41,11 +71,16 @@ userwindow::userwindow(QWidget *parent) :
     showTime();
 
     // Datenbanken lesen und daraus Buttons erstellen
-    users = readUsersFromDB();
-    if (users.empty()) { // when no user exists, the first-time-setup routine gets put into effect
-        system.setvBalance(0); // setting up a new system
-        system.setPassword("pm-tnmjc");
-        writeSystemToDB(system);
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+    string loadError;
+    if (!engine.load(loadError)) { // gespeicherter Stand nicht lesbar: nichts anzeigen und nichts schreiben, bis der Snapshot wiederhergestellt ist
+        ui->label_topNotificationBar->setText("Fehler beim Laden");
+        ui->label_error->setText(QString::fromStdString(loadError));
+        ui->stackedWidget->setEnabled(false);
+        updateMenuButtons(false);
+    }
+    else if (users.empty()) { // when no user exists, the first-time-setup routine gets put into effect (the engine has already set up a new system)
         adminLoggedIn = true;
         activeUserID = 0;
         ui->lineEdit_cl->setEchoMode(QLineEdit::Normal);
@@ -64,22 +99,43 @@ userwindow::userwindow(QWidget *parent) :
         ui->textBrowser_clOutput->append("Fröhliches Getränkekaufen!");
     }
     else { // otherwise the program continues to load the other databases and finishes setting up the ui
-        beverages = readBeveragesFromDB();
-        system = readSystemFromDB();
-        updateUserGrid(users);
-        updateBeverageGrid(beverages);
+        updateUserGrid();
+        beverageGridPending = true; // Getränkebuttons erst nach dem ersten Bild (siehe finishStartup)
+        auditPending = qApp->arguments().contains("--audit"); // Logs im Hintergrund gegen die Guthaben prüfen, sobald sie geladen sind (siehe showTime)
     }
+    loadTime = loadTimer.elapsed();
 }
 
 userwindow::~userwindow()
 {
+    if (auditThread.joinable()) { // ein laufendes Audit liest noch die Logs
+        auditThread.join();
+    }
+    engine.stop(); // alle noch ausstehenden Änderungen schreiben
     delete ui;
 }
 
 //
 // GUI Methoden
 //
+/**\brief Übernimmt den Zeitpunkt, ab dem der Start gemessen wird (in main() noch vor QApplication gestartet)
+ * \param timer
+ */
+void userwindow::setStartupTimer(const QElapsedTimer &timer) {
+    startupTimer = timer;
+}
+
+/**\brief Wird nach dem ersten Bild der Nutzerauswahl aufgerufen und baut den Rest der Oberfläche auf (zurzeit die Getränkeauswahl)
+ */
+void userwindow::finishStartup() {
+    if (beverageGridPending) {
+        updateBeverageGrid(beverages);
+    }
+}
+
 /**\brief Wandelt aktuelle Uhrzeit in String und lässt den Doppelpunkt blinken
+ * Zusätzlich wird unten links angezeigt, wenn sich im Schreib-Thread Änderungen stauen oder nicht geschrieben werden konnten.
+ * Wurde mit "--audit" gestartet, beginnt hier das Audit, sobald die Engine die Logs im Hintergrund geladen hat.
  * \https://doc.qt.io/qt-5/qtwidgets-widgets-digitalclock-example.html
  */
 void userwindow::showTime() {
@@ -89,65 +145,136 @@ void userwindow::showTime() {
         sTime[2] = ' ';
     }
     ui->lcd_clock->display(sTime);
+    if (auditPending && engine.getLogLoadTime() >= 0) {
+        auditPending = false;
+        startBackgroundAudit();
+    }
+    int pending = engine.getPendingCount();
+    if (engine.getFailureCount() > 0) {
+        ui->label_persistence->setText("Fehler beim Speichern!");
+    }
+    else if (pending >= persistenceBacklogWarning) {
+        ui->label_persistence->setText("speichert... (" + QString::number(pending) + ")");
+    }
+    else if (auditProblems > 0) {
+        ui->label_persistence->setText("Audit: " + QString::number(auditProblems) + " Abweichungen");
+    }
+    else {
+        ui->label_persistence->setText("");
+    }
 }
 
-/**\brief User-Oberflaeche wird dynamisch erstellt.
- * Für jeden Nutzer im vector wird ein Button erstellt.
- * Zum Layout gehören z.b. folgende Eigenschaften: Textfeldgroesse, Schriftart- und -groesse, Icon, etc.
- * Zusätzlich wird jeder Button mit einem Signal-Mapper verbunden.
+/**\brief Startet beim Programmstart (Parameter "--audit") eine Prüfung der Logs in einem eigenen Thread
+ * Der Stand, gegen den geprüft wird, wird hier im GUI-Thread festgehalten (siehe PosEngine::prepareAudit); danach kann ganz normal verkauft werden.
+ * Das Ergebnis landet über showAuditReport in der Kommandozeile; bei Abweichungen wird unten links ein Hinweis angezeigt.
  */
-bool userwindow::updateUserGrid(vector<User> fUsers) {
-    QFont latoFont("Lato", 12, QFont::Medium, false);
-    QSignalMapper* usrmapper = new QSignalMapper();
-    for (int i=0; i < fUsers.size(); i++) {
-        int row=i/4;
-        int column=i%4;
-        QPushButton *usrbtn = new QPushButton();
-        usrbtn->setFixedSize(100,60);
-        usrbtn->setFont(latoFont);
-        usrbtn->setIcon(QIcon("../res/icons/man-user.png"));
-        usrbtn->setIconSize(QSize(30, 30));
-        usrbtn->setText(QString::fromStdString(fUsers[i].getName()));
-        connect(usrbtn,SIGNAL(clicked(bool)),usrmapper,SLOT(map()));
-        usrmapper->setMapping(usrbtn,i);
-        ui->gridLayout_userselect->addWidget(usrbtn,row,column);
-    }
-    connect(usrmapper,SIGNAL(mapped(int)),this,SLOT(userButtonPressed(int)));
+void userwindow::startBackgroundAudit() {
+    LedgerAudit fAudit = engine.prepareAudit();
+    int threads = max(1u, std::thread::hardware_concurrency());
+    auditThread = std::thread([this, fAudit, threads]() {
+        AuditReport report = fAudit.run(threads);
+        vector<string> fLines = report.toLines(100);
+        QStringList lines;
+        for (int i=0; i < fLines.size(); i++) {
+            lines.append(QString::fromStdString(fLines[i]));
+        }
+        QMetaObject::invokeMethod(this, "showAuditReport", Qt::QueuedConnection, Q_ARG(QStringList, lines), Q_ARG(int, (int)report.problemCount));
+    });
+}
+
+/**\brief Zeigt das Ergebnis des Audits aus startBackgroundAudit an (läuft wieder im GUI-Thread)
+ * \param lines (Ergebnis), problems (Anzahl der Abweichungen)
+ */
+void userwindow::showAuditReport(QStringList lines, int problems) {
+    for (int i=0; i < lines.size(); i++) {
+        ui->textBrowser_clOutput->append(lines[i]);
+    }
+    auditProblems = problems;
+    showTime();
+}
+
+/**\brief User-Oberflaeche wird neu angezeigt (nach dem Laden, addusr, delusr, renusr oder importdb)
+ * Die Nutzerauswahl ist eine QListView im IconMode über dem Vektor users (siehe UserModel); es wird kein Widget pro Nutzer erstellt.
+ * Schriftart, Icongröße und Kachelraster werden einmal im Konstruktor festgelegt, gezeichnet werden nur die sichtbaren Kacheln.
+ * Steht etwas im Suchfeld, werden nur die passenden Nutzer angezeigt.
+ */
+bool userwindow::updateUserGrid() {
+    if (batchRunning) { // wird nach dem Stapel einmal aufgerufen
+        return true;
+    }
+    QString search = ui->lineEdit_usersearch->text().trimmed();
+    if (search.isEmpty()) {
+        userModel->clearFilter();
+    }
+    else {
+        vector<int> fSlots;
+        engine.searchUsers(search.toStdString(), fSlots);
+        userModel->setFilter(fSlots);
+    }
     return true;
 }
 
 /**\brief Getraenke-Oberflaeche wird dynamisch erstellt.
- * Für jedes Getränkeobjekt wird ein Button erstellt.
+ * Die bisherigen Buttons werden gelöscht und für jedes Getränkeobjekt wird ein neuer Button erstellt.
  * Zum Layout gehören z.b. folgende Eigenschaften: Textfeldgroesse, Schriftart- und -groesse, Icon, etc.
- * Bei niedrigem Getraenkestand (stock <= 5) wird Warnung ausgegeben; bei stock == 0 wird Button "deaktiviert".
- * Zusätzlich wird jeder Button mit einem Signal-Mapper verbunden.
+ * Zusätzlich wird jeder Button mit dem (einzigen) Signal-Mapper beverageMapper verbunden.
+ * Nur nötig, wenn Getränke hinzukommen oder wegfallen (addbvr, delbvr, importdb); ändert sich nur Bestand, Preis oder Name eines Getränks, reicht updateBeverageButton().
  * \param vector<Beverage> (alle Getränkeobjekte im Vector)
  * \return true (standardmäßig; in Version 2 könnten mit der false-Rückgabe auch Fehler ausgegeben werden)
  */
-bool userwindow::updateBeverageGrid(vector<Beverage> fBeverages) {
+bool userwindow::updateBeverageGrid(const vector<Beverage> &fBeverages) {
+    if (batchRunning) { // wird nach dem Stapel einmal aufgerufen
+        return true;
+    }
+    beverageGridPending = false;
+    clearGrid(ui->gridLayout_beverageselect); // die Zuordnungen im Mapper verschwinden mit den Buttons
+    clearCart(); // GetränkeIDs im Warenkorb wären nach addbvr/delbvr nicht mehr gültig
+    beverageButtons.clear();
+    beverageLowStock.clear();
+    lowStockCount = 0;
     QFont latoFont("Lato", 12, QFont::Medium, false);
-    QSignalMapper* bvrmapper = new QSignalMapper();
     for (int i=0; i < fBeverages.size(); i++) {
         int row=i/3;
         int column=i%3;
         QPushButton *bvrbtn = new QPushButton();
         bvrbtn->setFixedSize(150,70);
         bvrbtn->setFont(latoFont);
-        bvrbtn->setText(QString::fromStdString(fBeverages[i].getName()) + " [" + QString::number(fBeverages[i].getStock()) + "]");
-        if (fBeverages[i].getStock() <= 5) {
-            ui->label_infobox->setText("Es gibt niedrige Getränkestände!");
-            if (fBeverages[i].getStock() == 0) {
-                bvrbtn->setEnabled(false);
-            }
-        }
-        connect(bvrbtn,SIGNAL(clicked(bool)),bvrmapper,SLOT(map()));
-        bvrmapper->setMapping(bvrbtn,i);
+        connect(bvrbtn,SIGNAL(clicked(bool)),beverageMapper,SLOT(map()));
+        beverageMapper->setMapping(bvrbtn,i);
         ui->gridLayout_beverageselect->addWidget(bvrbtn,row,column);
+        beverageButtons.push_back(bvrbtn);
+        beverageLowStock.push_back(false);
+        updateBeverageButton(i);
     }
-    connect(bvrmapper,SIGNAL(mapped(int)),this,SLOT(beverageButtonPressed(int)));
     return true;
 }
 
+/**\brief Passt nur den Button eines Getränks an (nach einem Kauf, einer Bestellung oder einer Preis-/Namensänderung)
+ * Bei niedrigem Getraenkestand (stock <= 5) wird Warnung ausgegeben; bei stock == 0 wird Button "deaktiviert".
+ * Die Anzahl der Getränke mit niedrigem Bestand wird mitgezählt, damit dafür nicht jedes Mal alle Getränke durchsucht werden müssen.
+ * \param id (Position des Getränks im Vektor)
+ */
+void userwindow::updateBeverageButton(int id)
+{
+    if (batchRunning || id < 0 || id >= beverageButtons.size()) {
+        return;
+    }
+    QPushButton *bvrbtn = beverageButtons[id];
+    bvrbtn->setText(QString::fromStdString(beverages[id].getName()) + " [" + QString::number(beverages[id].getStock()) + "]");
+    bvrbtn->setEnabled(beverages[id].getStock() > 0);
+    bool low = beverages[id].getStock() <= 5;
+    if (low != beverageLowStock[id]) {
+        lowStockCount += low ? 1 : -1;
+        beverageLowStock[id] = low;
+    }
+    if (lowStockCount > 0) {
+        ui->label_infobox->setText("Es gibt niedrige Getränkestände!");
+    }
+    else if (ui->label_infobox->text() == "Es gibt niedrige Getränkestände!") {
+        ui->label_infobox->setText("");
+    }
+}
+
 /**\brief rekursiv aufgerufenes Layout Setup, kann von Nutzerauswahl und von Getränkeauswahl aufgerufen werden
  * \return Widgets (Pushbutton)
  */
@@ -159,7 +286,9 @@ bool userwindow::clearGrid(QLayout *layout)
     while (auto item = layout->takeAt(0)) {
         delete item->widget();
         clearGrid(item->layout());
+        delete item;
     }
+    return true;
 }
 
 /**\brief Schaltet den Zustand der Navigationsbuttons um
@@ -183,261 +312,332 @@ bool userwindow::updateMenuButtons(bool status)
 
 
 //
-// Backend Methoden
+// Slots
 //
 
-/**\brief Schreibt alle Nutzer mit ihren Attributen in eine Datei
- * (Serialisierung der Nutzer-Objekte)
- * Die Datei wird geöffnet und in jede Zeile wird jeweils ein Nutzer geschrieben.
- * Der bereits vorhandene Inhalt wird jeweils überschrieben!
- * Die verschiedenen Attribute eines jeden Nutzers werden durch Semikolons getrennt.
- * Wenn alle Objekte "abgeschrieben" wurden, wird die Datei geschlossen.
- * \param vector<User> fUser (der Methode wird der Vektor, der aus allen Nutzerobjekten besteht, übergeben)
- * \return  true (wenn Methode ohne größere Fehler abgeschlossen)
- *          false (wenn Datenbank nicht geöffnet werden konnte)
- */
-bool userwindow::writeUsersToDB(vector<User> fUser) {
-    ofstream tmpUserDB;
-    tmpUserDB.open("userDB.txt");
-    if (tmpUserDB.is_open()) {
-        for (int i=0; i < fUser.size(); i++) { // für jeden Nutzer eine neue Zeile
-            tmpUserDB << fUser[i].getName() << ";" << fUser[i].getBalance() << ";" << fUser[i].getRole() << endl;
+/**\brief avtiveUserID wird die ID des ausgewählten Benutzers übergeben. Um nach der Ausgabe den Name des eingeloggten Nutzers anzuzeigen, wird mit der Methode "getName()" der Name der ausgewählten Person abgefragt. Um dem Nutzer nun sein aktuelles Guthaben anzuzeigen, wird dieses mit der Methode "getBalance()" aus der Datenbank anhand der UserID angefragt. Der Name und das Guthaben werden in der Kopfleiste der GUI ausgegeben. Um weitere Aktionen durchzuführen wird zusätzlich eine neue GUI-Seite angezeigt, auf der nun Getränke gewählt, die Buchungshistorie eingesehen, Geldaufgeladen, sich als Admin in die Einstellungen einzuloggen oder sich wieder auszuloggen.
+ * \param id (ID des aktiven Users)
+ * \return wenn die Funktion komplett durchlaufen wurde, gibt sie den Wert "true" zurück
+ */
+bool userwindow::userButtonPressed(int id)
+{
+    activeUserID = id; //set the active user
+    if (beverageGridPending) { // Nutzer wurde noch vor dem ersten Bild angetippt
+        updateBeverageGrid(beverages);
+    }
+    ui->pushButton_cart->setEnabled(true);
+    QString usrname = QString::fromStdString(users[id].getName());
+    QString usrbalance = QString::fromStdString(users[id].getBalance().toString());
+    ui->label_topNotificationBar->setText(usrname);
+    ui->label_balance->setText(usrbalance + " €");
+    updateMenuButtons(true);
+    ui->stackedWidget->setCurrentIndex(1);
+    return true;
+}
+
+/**\brief Wird bei einem Klick auf einen Getränkebutton (oder einem gescannten Barcode) aufgerufen
+ * Während einer Runde wird das Getränk für alle gewählten Nutzer gebucht, im Warenkorb-Modus nur in den Warenkorb gelegt.
+ * Sonst wird genau diese eine Flasche sofort gebucht (sellBeverages) und der Nutzer danach ausgeloggt.
+ * Die Laufzeiten von Ausloggen und des ganzen Verkaufs werden für das Kommando stats erfasst (die übrigen Phasen in bookSales bzw. PosEngine::sell).
+ * \param Getränke id
+ * \return false (Buchung konnte nicht durchgeführt werden)
+           true (Buchung konnte erfolgreich durchgeführt werden bzw. Getränk liegt im Warenkorb)
+ */
+bool userwindow::beverageButtonPressed(int id)
+{
+    LatencyStats &latency = engine.getLatencyStats();
+    LatencyStats::Clock::time_point saleStart = LatencyStats::Clock::now();
+    if (!roundUsers.empty() && id >= 0 && id < beverages.size()) { // Runde: dieses Getränk für alle gewählten Nutzer in einem Stapel buchen
+        vector<pair<int, int> > fSales;
+        for (int i=0; i < roundUsers.size(); i++) {
+            fSales.push_back(make_pair(roundUsers[i], id));
         }
+        QString error;
+        if (!bookSales(fSales, error)) {
+            ui->label_infobox->setText(error);
+            return false;
+        }
+        LatencyStats::Clock::time_point logoutStart = LatencyStats::Clock::now();
+        logoutAfterSale();
+        latency.record(LatencyStats::SaleLogout, logoutStart);
+        latency.record(LatencyStats::SaleTotal, saleStart);
+        return true;
     }
-    else {
+    if (activeUserID < 0 || id < 0 || id >= beverages.size()) {
+        return false;
+    }
+    if (ui->pushButton_cart->isChecked()) {
+        addToCart(id);
+        return true;
+    }
+    map<int, int> items;
+    items[id] = 1;
+    if (!sellBeverages(items)) {
         return false;
     }
-    tmpUserDB.close();
+    LatencyStats::Clock::time_point logoutStart = LatencyStats::Clock::now();
+    logoutAfterSale();
+    latency.record(LatencyStats::SaleLogout, logoutStart);
+    latency.record(LatencyStats::SaleTotal, saleStart);
     return true;
 }
 
-/**\brief Schreibt alle Getränke mit ihren Attributen in eine Datei
- * (Serialisierung der Getränke-Objekte)
- * Die Datei wird geöffnet und in jede Zeile wird jeweils ein Getränk geschrieben.
- * Die verschiedenen Attribute eines jeden Getränks werden durch Semikolons getrennt.
- * Wenn alle Objekte "abgeschrieben" wurden, wird die Datei geschlossen.
- * \param vector<Beverage> fBeverage (der Methode wird der Vektor, der aus allen Getränkeobjekten besteht, übergeben)
+/**\brief Bucht den Warenkorb (oder eine einzelne Flasche) des aktiven Nutzers (siehe bookSales)
+ * \param items (GetränkeID -> Anzahl)
+ * \return false (Buchung konnte nicht durchgeführt werden, Hinweis steht in label_infobox)
+           true (Buchung konnte erfolgreich durchgeführt werden)
  */
-bool userwindow::writeBeveragesToDB(vector<Beverage> fBeverage) {
-    ofstream tmpBeverageDB;
-    tmpBeverageDB.open("beverageDB.txt");
-    if (tmpBeverageDB.is_open()) {
-        for (int i=0; i < fBeverage.size(); i++) {
-            tmpBeverageDB << fBeverage[i].getName() << ";" << fBeverage[i].getPrice() << ";" << fBeverage[i].getBarcode() << ";" << fBeverage[i].getStock() << ";" << fBeverage[i].getLastOrder() << endl;
+bool userwindow::sellBeverages(const map<int, int> &items)
+{
+    if (activeUserID < 0) {
+        return false;
+    }
+    vector<pair<int, int> > fSales;
+    for (map<int, int>::const_iterator it = items.begin(); it != items.end(); ++it) {
+        for (int i=0; i < it->second; i++) {
+            fSales.push_back(make_pair(activeUserID, it->first));
         }
     }
-    else {
+    QString error;
+    if (!bookSales(fSales, error)) {
+        ui->label_infobox->setText(error);
         return false;
     }
-    tmpBeverageDB.close();
     return true;
 }
 
-/**\brief Schreibt die Systemeinstellungen in ein Textdokument
- * \param System
+/**\brief Bucht Verkäufe über die Engine (siehe PosEngine::sell) und passt danach nur die Buttons der gekauften Getränke an
+ * \param sales (pro Flasche: NutzerID und GetränkeID), error (Hinweis, warum nicht gebucht werden konnte)
+ * \return false (Buchung konnte nicht durchgeführt werden, es wurde nichts verändert)
+           true (Buchung konnte erfolgreich durchgeführt werden)
  */
-bool userwindow::writeSystemToDB(System) {
-    ofstream tmpSystemDB;
-    tmpSystemDB.open("systemDB.txt");
-    if (tmpSystemDB.is_open()) {
-        tmpSystemDB << system.getPassword() << endl;
-        tmpSystemDB << system.getvBalance() << endl;
+bool userwindow::bookSales(const vector<pair<int, int> > &sales, QString &error)
+{
+    string sError;
+    if (!engine.sell(sales, sError)) {
+        error = QString::fromStdString(sError);
+        return false;
     }
-    else {
-        exit(-1);
+    LatencyStats::Clock::time_point buttonStart = LatencyStats::Clock::now();
+    map<int, bool> fBeverages;
+    for (int i=0; i < sales.size(); i++) {
+        fBeverages[sales[i].second] = true;
     }
-    tmpSystemDB.close();
+    for (map<int, bool>::const_iterator it = fBeverages.begin(); it != fBeverages.end(); ++it) {
+        updateBeverageButton(it->first);
+    }
+    engine.getLatencyStats().record(LatencyStats::SaleButtons, buttonStart);
     return true;
 }
 
-/**\brief Liest alle Nutzer mit ihren Attributen aus einer Datei
- * (Deserialisierung der Nutzer-Objekte)
- * Die Datei wird geöffnet und jede Zeile einzeln gelesen.
- * Die jeweils ausgelesene Zeile wird anhand der Semikolons in kleinere Strings aufgetrennt.
- * Die jeweiligen Substrings werden je nach Attribut konvertiert und in einen temporären Nutzer geschrieben.
- * Der temporäre Nutzer wird anschließend in einem Vektor verstaut.
- * \return vector<User> fUser (gibt den Vektor, der alle Nutzerobjekte enthält, aus)
- */
-vector<User> userwindow::readUsersFromDB() {
-    vector<User> fUser;
-    ifstream tmpUserDB;
-    tmpUserDB.open("userDB.txt");
-    if (tmpUserDB.is_open()) {
-        while (tmpUserDB.good()) {
-            User tmpUser;
-            string sUOL; // sUOL = stringUserObjectLine
-            size_t posFD, posSD; // FD=FirstDivider, SD=SecondDivider, a divider is the ";" symbol
-            getline (tmpUserDB,sUOL);
-            if (sUOL.empty()) {
-                break;
-            }
-            else {
-                posFD = sUOL.find(";");
-                posSD = sUOL.find(";", posFD+1);
-                string sName = sUOL.substr (0,posFD);
-                string sBalance = sUOL.substr (posFD+1,posSD-1);
-                string sRole = sUOL.substr (posSD+1);
-                tmpUser.editName(sName);
-                tmpUser.setBalance(-stod(sBalance));
-                tmpUser.editRole(stoi(sRole));
-                fUser.push_back(tmpUser);
-            }
+/**\brief Nach einem erfolgreichen Kauf wird wieder die Startseite aufgerufen und der Nutzer ausgeloggt
+ * Durch das Setzen der UserID auf -1 wird sichergestellt, dass kein Nutzer aktiv gesetzt ist.
+ */
+void userwindow::logoutAfterSale()
+{
+    clearCart();
+    roundUsers.clear();
+    ui->pushButton_round->setChecked(false);
+    ui->label_topNotificationBar->setText("ags Getränkekasse");
+    ui->label_balance->setText("");
+    updateMenuButtons(false);
+    ui->stackedWidget->setCurrentIndex(0);
+    activeUserID = -1;
+}
+
+/**\brief Legt eine Flasche in den Warenkorb (mehr als der aktuelle Bestand ist nicht möglich)
+ * \param id (GetränkeID)
+ */
+void userwindow::addToCart(int id)
+{
+    if (cart[id] >= beverages[id].getStock()) {
+        if (cart[id] == 0) {
+            cart.erase(id);
         }
+        ui->label_infobox->setText(QString::fromStdString(beverages[id].getName()) + ": nur noch " + QString::number(beverages[id].getStock()) + " Flaschen!");
+        return;
     }
-    tmpUserDB.close();
-    return fUser;
-}
-
-/**\brief Liest alle Getränke mit ihren Attributen aus einer Datei
- * (Deserialisierung der Getränke-Objekte)
- * Die Datei wird geöffnet und jede Zeile einzeln gelesen.
- * Die jeweils ausgelesene Zeile wird anhand der Semikolons in kleinere Strings aufgetrennt.
- * Die jeweiligen Substrings werden je nach Attribut konvertiert und in ein temporäres Getränk geschrieben.
- * Das temporäre Getränk wird anschließend in einem Vektor verstaut.
- * \return vector<Beverage> fBeverage (gibt den Vektor, der alle Getränkeobjekte enthält, aus)
- */
-vector<Beverage> userwindow::readBeveragesFromDB() {
-    vector<Beverage> fBeverage;
-    ifstream tmpBeverageDB;
-    tmpBeverageDB.open("beverageDB.txt");
-    if (tmpBeverageDB.is_open()) {
-        while (tmpBeverageDB.good()) {
-            Beverage tmpBeverage;
-            string sBOL; // sUOL = stringBeverageObjectLine
-            size_t pos1D, pos2D, pos3D, pos4D; // pos1D: position of first divider; a divider is the ";" symbol
-            getline (tmpBeverageDB,sBOL);
-            if (sBOL.empty()) {
-                break;
-            }
-            else {
-                pos1D = sBOL.find(";");
-                pos2D = sBOL.find(";", pos1D+1);
-                pos3D = sBOL.find(";", pos2D+1);
-                pos4D = sBOL.find(";", pos3D+1);
-                string sName = sBOL.substr (0,pos1D);
-                string sPrice = sBOL.substr (pos1D+1,pos2D);
-                string sBarcode = sBOL.substr (pos2D+1,pos3D);
-                string sStock = sBOL.substr (pos3D+1,pos4D);
-                string sLastOrder = sBOL.substr(pos4D+1);
-                tmpBeverage.editName(sName);
-                tmpBeverage.editPrice(stod(sPrice));
-                tmpBeverage.editBarcode(stoi(sBarcode));
-                tmpBeverage.setStock(stoi(sStock));
-                tmpBeverage.setLastOrder(stoi(sLastOrder));
-                fBeverage.push_back(tmpBeverage);
-            }
-        }
+    cart[id]++;
+    showCart();
+}
+
+/**\brief Leert den Warenkorb und beendet den Warenkorb-Modus
+ */
+void userwindow::clearCart()
+{
+    cart.clear();
+    ui->pushButton_cart->setChecked(false);
+    showCart();
+}
+
+/**\brief Zeigt Inhalt und Summe des Warenkorbs in label_infobox an und passt die Warenkorb-Buttons an
+ */
+void userwindow::showCart()
+{
+    bool cartMode = ui->pushButton_cart->isChecked();
+    ui->pushButton_checkout->setEnabled(cartMode && !cart.empty());
+    ui->pushButton_clearCart->setEnabled(cartMode && !cart.empty());
+    if (!cartMode) {
+        ui->pushButton_checkout->setText("Bezahlen");
+        return;
     }
-    tmpBeverageDB.close();
-    return fBeverage;
-}
-
-/**\brief Passwort und Guthaben des Systems werden aus der Datenbank(DB) ausgelesen
- * \return Objekt fSystem
- */
-System userwindow::readSystemFromDB() {
-    System fSystem;
-    ifstream tmpSystemDB;
-    tmpSystemDB.open("systemDB.txt");
-    if (tmpSystemDB.is_open()) {
-        string sPassword;
-        string svBalance;
-        getline (tmpSystemDB,sPassword);
-        getline (tmpSystemDB,svBalance);
-        if (svBalance.size() > 0) {
-            fSystem.setPassword(sPassword);
-            fSystem.setvBalance(stod(svBalance));
+    Money total;
+    QString content;
+    for (map<int, int>::const_iterator it = cart.begin(); it != cart.end(); ++it) {
+        if (!content.isEmpty()) {
+            content += ", ";
         }
+        content += QString::number(it->second) + "x " + QString::fromStdString(beverages[it->first].getName());
+        total += beverages[it->first].getPrice() * it->second;
     }
-    tmpSystemDB.close();
-    return fSystem;
+    ui->pushButton_checkout->setText("Bezahlen (" + QString::fromStdString(total.toString()) + " €)");
+    ui->label_infobox->setText(cart.empty() ? "Warenkorb ist leer" : "Warenkorb: " + content);
 }
 
-/**\brief Wandelt die User-ID in einen immer gleich langen String um
- * \param id (ID des aktiven Users als int)
- * \return sID (ID als "normalisierter" string)
- * \warning Diese Methode geht davon aus, dass es nicht mehr als 100 Nutzer gibt!!
+/**\brief Schaltet den Warenkorb-Modus ein oder aus; beim Ausschalten wird der Warenkorb verworfen
+ * \param checked (true = Getränke werden gesammelt statt sofort gebucht)
  */
-string userwindow::convertUserID(int id)
+void userwindow::on_pushButton_cart_toggled(bool checked)
 {
-    string sID;
-    if (id < 10) { //Um die immer gleiche Länge von TransaktionsIDs zu gewährleisten wird die UserID notfalls um eine Null verlängert
-        sID = "0" + to_string(id);
+    if (!checked) {
+        cart.clear();
+        ui->label_infobox->setText("");
     }
-    else {
-        sID = to_string(id);
+    showCart();
+}
+
+/**\brief Bucht den kompletten Warenkorb mit einem einzigen Stapel (siehe sellBeverages) und loggt den Nutzer danach aus
+ */
+void userwindow::on_pushButton_checkout_clicked()
+{
+    if (sellBeverages(cart)) {
+        logoutAfterSale();
     }
-    return sID;
 }
 
+/**\brief Leert den Warenkorb, der Warenkorb-Modus bleibt aktiv
+ */
+void userwindow::on_pushButton_clearCart_clicked()
+{
+    cart.clear();
+    showCart();
+}
 
-//
-// Slots
-//
+/**\brief Ein Klick auf eine Kachel der Nutzerauswahl wählt den Nutzer aus (siehe userButtonPressed)
+ * \param index (Kachel; bei einer Suche wird die Zeile über das Model in die Position im Vektor users umgerechnet)
+ */
+void userwindow::on_listView_userselect_clicked(const QModelIndex &index)
+{
+    int id = userModel->getUserID(index.row());
+    if (index.isValid() && id >= 0) {
+        ui->lineEdit_usersearch->clear(); // der nächste Nutzer sieht wieder alle Kacheln
+        if (ui->pushButton_round->isChecked()) { // Runde: Nutzer nur markieren
+            userModel->toggleMarked(id);
+            updateRoundButton();
+        }
+        else {
+            userButtonPressed(id);
+        }
+    }
+}
 
-/**\brief avtiveUserID wird die ID des ausgewählten Benutzers übergeben. Um nach der Ausgabe den Name des eingeloggten Nutzers anzuzeigen, wird mit der Methode "getName()" der Name der ausgewählten Person abgefragt. Um dem Nutzer nun sein aktuelles Guthaben anzuzeigen, wird dieses mit der Methode "getBalance()" aus der Datenbank anhand der UserID angefragt. Der Name und das Guthaben werden in der Kopfleiste der GUI ausgegeben. Um weitere Aktionen durchzuführen wird zusätzlich eine neue GUI-Seite angezeigt, auf der nun Getränke gewählt, die Buchungshistorie eingesehen, Geldaufgeladen, sich als Admin in die Einstellungen einzuloggen oder sich wieder auszuloggen.
- * \param id (ID des aktiven Users)
- * \return wenn die Funktion komplett durchlaufen wurde, gibt sie den Wert "true" zurück
+/**\brief Schaltet den Runden-Modus der Nutzerauswahl ein oder aus
+ * Im Runden-Modus markiert ein Klick auf eine Kachel den Nutzer, anstatt ihn einzuloggen.
+ * \param checked (true = Runden-Modus)
  */
-bool userwindow::userButtonPressed(int id)
+void userwindow::on_pushButton_round_toggled(bool checked)
 {
-    activeUserID = id; //set the active user
-    QString usrname = QString::fromStdString(users[id].getName());
-    QString usrbalance = QString::number(users[id].getBalance());
-    ui->label_topNotificationBar->setText(usrname);
-    ui->label_balance->setText(usrbalance + " €");
-    updateMenuButtons(true);
+    Q_UNUSED(checked);
+    userModel->clearMarked();
+    updateRoundButton();
+}
+
+/**\brief Zeigt die Anzahl der markierten Nutzer auf dem Button zur Getränkewahl an
+ */
+void userwindow::updateRoundButton()
+{
+    int count = userModel->getMarked().size();
+    ui->pushButton_roundBeverage->setEnabled(ui->pushButton_round->isChecked() && count > 0);
+    ui->pushButton_roundBeverage->setText(count > 0 ? "Getränk wählen (" + QString::number(count) + ")" : QString("Getränk wählen"));
+}
+
+/**\brief Wechselt mit den markierten Nutzern auf die Getränkeseite; das dort gewählte Getränk wird für alle gebucht (siehe beverageButtonPressed)
+ */
+void userwindow::on_pushButton_roundBeverage_clicked()
+{
+    roundUsers = userModel->getMarked();
+    if (roundUsers.empty()) {
+        return;
+    }
+    activeUserID = -1;
+    ui->pushButton_cart->setEnabled(false); // eine Runde wird sofort gebucht
+    ui->label_topNotificationBar->setText("Runde für " + QString::number(roundUsers.size()) + " Personen");
+    ui->label_balance->setText("");
+    ui->label_infobox->setText("Bitte ein Getränk für alle wählen");
+    updateMenuButtons(false);
+    ui->pushButton_pageBack->setEnabled(true);
     ui->stackedWidget->setCurrentIndex(1);
-    return true;
 }
 
-/**\brief In dieser Funktion wird der eigentliche Kaufvorgang abgewickelt
- * \Dazu versucht die Funktion den Preis des Getränks vom Konto des Nutzers abzubuchen. (1)
- * \Wenn dies erfolgreich war und das Getränk noch verfügbar ist (2), wird der Bestand des ausgewählten Getränks um 1 verringert (3).
- * \Das durch den Kauf geänderte Guthaben wird in die Nutzerdatenbank geschrieben (4), der geänderte Bestand wird in die Getränkedatenbak geschrieben (5).
- * \Zusätzlich wird die Datei "transactionlog.txt" geöffnet (6). Wenn die Datei erfolgreich geöffnet werden konnte, wird die getätigte Buchung mit Angaben zu:
- * \        * Datum und der Uhrzeit (7),
- * \        * der NutzerID, des Getränkepreises, des Getränkenamens und des neuen Guthabens des Nutzerkontos in diese Datei geschrieben (8).
- * \Falls die Datei nicht geöffnet werden kann, wird eine false returned (9).
- * \Nachdem die Datenbank geschlossen wurde (10), wird das UI an den geänderten Getränkebestand angepasst (11).
- * \Es wird wieder die Startseite aufgerufen (14) und die Topbar entsprechend ausgefüllt (12).
- * \Die möglichen Menubuttons in der Fußzeile werden angepasst (13).
- * \Am Ende wird der Nutzer ausgeloggt und durch das setzten der UserID auf -1 wird sichergestellt, dass kein Nutzer aktiv gesetzt ist (15).
- * \Wenn der Nutzter nicht genügend Geld auf seinem Konto hat, wird ihm angezeigt, dass er nichtmehr genügend Geld auf seinem Konto hat (16) und es wird false zurückgegeben.
- * \param Getränke id
- * \return false (Buchung konnte nicht durchgeführt werden (17), oder Log konnte nicht geöffnet werden (9))
-           true (Buchung konnte erfolgreich durchgeführt werden)
+/**\brief Filtert die Nutzerauswahl bei jedem Tastendruck im Suchfeld
+ * Die Treffer kommen aus dem Präfix-Index der Engine (zwei binäre Suchen), die Kacheln werden nur für die sichtbaren Treffer gezeichnet.
+ * \param text (aktueller Inhalt des Suchfelds)
  */
-bool userwindow::beverageButtonPressed(int id)
+void userwindow::on_lineEdit_usersearch_textChanged(const QString &text)
+{
+    Q_UNUSED(text);
+    updateUserGrid();
+}
+
+/**\brief Bucht das Getränk mit dem gescannten Barcode für den aktiven Nutzer
+ * Das Getränk wird über den Barcode-Index der Engine gefunden (konstante Zeit), gebucht wird genau wie beim Drücken des Buttons (beverageButtonPressed).
+ * \param code (empfangene Ziffern)
+ * \return bool (false bei unbekanntem Barcode oder wenn die Buchung nicht möglich war)
+ */
+bool userwindow::barcodeScanned(string code)
 {
-    bool transactionSuccess = users[activeUserID].setBalance(beverages[id].getPrice()); //(1)
-    if (transactionSuccess && beverages[id].getStock() > 0) { //(2)
-        beverages[id].setStock(beverages[id].getStock()-1); //(3)
-        writeUsersToDB(users); //(4)
-        writeBeveragesToDB(beverages); //(5)
-        ofstream transactionlog;
-               transactionlog.open("transactionlog.txt", ios::out | ios::app); //(6)
-               if (transactionlog.is_open()) {
-                   QString timestamp = QDateTime::currentDateTime().toString("MMddhhmmss"); //(7)
-                   transactionlog << timestamp.toStdString() << " | " << convertUserID(activeUserID) << " | -" << beverages[id].getPrice() << "\t| " << users[activeUserID].getBalance() << "\t| " << beverages[id].getName() << endl; //(8)
-               }
-               else {
-                   return false; //(9)
-               }
-        transactionlog.close(); //(10)
-        clearGrid(ui->gridLayout_beverageselect);
-        updateBeverageGrid(beverages); //11)
-        ui->label_topNotificationBar->setText("ags Getränkekasse");
-        ui->label_balance->setText(""); //(12)
-        updateMenuButtons(false); //(13)
-        ui->stackedWidget->setCurrentIndex(0); //(14)
-        activeUserID = -1; // (15)
+    int id = -1;
+    if (code.size() <= 18) { // Barcodes werden als long long gespeichert (siehe Beverage), EAN-13 hat 13 Stellen
+        id = engine.findBarcode(stoll(code));
     }
-    else {
-        ui->label_infobox->setText("Nicht mehr genug Geld vorhanden!"); //(16)
-        return false; //(17)
+    if (id < 0) {
+        ui->label_infobox->setText("Unbekannter Barcode: " + QString::fromStdString(code));
+        QApplication::beep();
+        return false;
     }
-    return true;
+    return beverageButtonPressed(id);
+}
+
+/**\brief Fängt die Eingaben eines Barcodescanners auf der Getränkeseite ab
+ * Scanner als Tastatur-Emulation "tippen" die Ziffern des Barcodes und danach Enter. Der Filter ist auf der ganzen Anwendung installiert,
+ * sodass es egal ist, welches Widget gerade den Fokus hat. Auf allen anderen Seiten (z.B. Aufladen, Einstellungen) werden Tasten normal weitergereicht.
+ * \return bool (true, wenn die Taste als Teil eines Barcodes verbraucht wurde)
+ */
+bool userwindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (firstFrameTime < 0 && event->type() == QEvent::Paint && watched == ui->listView_userselect->viewport()) { // erstes Bild der Nutzerauswahl: ab jetzt bedienbar
+        firstFrameTime = startupTimer.elapsed();
+        QTimer::singleShot(0, this, &userwindow::finishStartup);
+    }
+    if (event->type() == QEvent::KeyPress && ui->stackedWidget->currentIndex() == 1 && (activeUserID >= 0 || !roundUsers.empty())) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        int key = keyEvent->key();
+        if (key >= Qt::Key_0 && key <= Qt::Key_9) {
+            if (scanTimer.isValid() && scanTimer.elapsed() > barcodeKeyTimeout) {
+                scanBuffer.clear();
+            }
+            scanBuffer += (char) ('0' + key - Qt::Key_0);
+            scanTimer.start();
+            return true;
+        }
+        if ((key == Qt::Key_Return || key == Qt::Key_Enter) && !scanBuffer.empty()) {
+            string code = scanBuffer;
+            scanBuffer.clear();
+            barcodeScanned(code);
+            return true;
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
 }
 
 /**\brief Mit einem Klick auf diesen Button wird zur vorherigen Seite navigiert
@@ -445,7 +645,7 @@ bool userwindow::beverageButtonPressed(int id)
  */
 void userwindow::on_pushButton_pageBack_clicked()
 {
-    if (users.empty() || system.getPassword() == "pm-tnmjc") { // checking for completed first time setup
+    if (engine.needsSetup()) { // checking for completed first time setup
         ui->textBrowser_clOutput->append("Bitte zuerst einen Nutzer anlegen und das Passwort ändern!");
         ui->stackedWidget->setCurrentIndex(4);
         ui->lineEdit_cl->setEchoMode(QLineEdit::Normal);
@@ -453,16 +653,23 @@ void userwindow::on_pushButton_pageBack_clicked()
     }
     else {
         if (ui->stackedWidget->currentIndex() == 1) {
+            clearCart();
+            roundUsers.clear();
+            ui->pushButton_round->setChecked(false);
             ui->label_topNotificationBar->setText("ags Getränkekasse");
             ui->label_balance->setText("");
             ui->label_infobox->setText("");
             updateMenuButtons(false);
             ui->stackedWidget->setCurrentIndex(0);
         }
+        else if (ui->stackedWidget->currentIndex() == 2 && adminLoggedIn) { // Einzahlungsliste (depositlog) zurück zu den Einstellungen
+            historyModel->clear();
+            ui->stackedWidget->setCurrentIndex(4);
+        }
         else {
             ui->label_display->setText("");
             ui->label_error->setText("");
-            ui->textBrowser_history->setText("");
+            historyModel->clear();
             updateMenuButtons(true);
             ui->lineEdit_cl->setEchoMode(QLineEdit::Password);
             adminLoggedIn = false;
@@ -472,32 +679,17 @@ void userwindow::on_pushButton_pageBack_clicked()
 }
 
 /**\brief Zeigt die Historie der Buchungen (gekauften Getränke)
- * Es wird in der Logdatei nach allen Buchungen des jeweils aktiven Nutzers gesucht und die jeweilige Buchung ausgegeben.
+ * Über den Index von transactionlog.txt (und der archivierten Monate) wird eine Ansicht mit allen Buchungen des jeweils aktiven Nutzers geöffnet, neueste zuerst.
+ * Die Zeilen selbst werden erst beim Scrollen seitenweise aus den Logs gelesen (siehe LogModel).
  */
 void userwindow::on_pushButton_history_clicked()
 {
     updateMenuButtons(false);
     ui->pushButton_pageBack->setEnabled(true);
     ui->stackedWidget->setCurrentIndex(2);
-    string usrID = convertUserID(activeUserID);
-    size_t posUsrID = 13;
-    ifstream transactionlog;
-    transactionlog.open("transactionlog.txt");
-    if (transactionlog.is_open()) {
-        while (transactionlog.good()) {
-            string transaction;
-            getline (transactionlog,transaction);
-            if (transaction.empty()) {
-                break;
-            }
-            else {
-                if (transaction.find(usrID, posUsrID) == posUsrID) {
-                    ui->textBrowser_history->append(QString::fromStdString(transaction));
-                }
-            }
-        }
-    }
-    transactionlog.close();
+    engine.openUserTransactions(activeUserID, 0, 99991231, historyModel->getView()); // wartet, bis auch die letzten Buchungen im Log stehen
+    historyModel->reload();
+    ui->listView_history->scrollToTop();
 }
 
 /**\brief Mit einem Klick auf diesen Button wird die Seite zum Aufladen des Guthaben angezeigt
@@ -508,8 +700,7 @@ void userwindow::on_pushButton_addMoney_clicked()
     updateMenuButtons(false);
     ui->pushButton_pageBack->setEnabled(true);
     ui->stackedWidget->setCurrentIndex(3);
-    QString ID = QString::fromStdString(convertUserID(activeUserID));
-    ui->label_transactionID->setText(ID + QDateTime::currentDateTime().toString("MMddhhmm"));
+    ui->label_transactionID->setText(QString::fromStdString(engine.newTransactionID(activeUserID)));
 }
 
 /**\brief Mit einem Klick auf den Button wird eine Null in das Label auf der Seite zum Aufladen des Guthabens hinzugefügt
@@ -610,51 +801,35 @@ void userwindow::on_pushButton_back_clicked()
 }
 
 /**\brief Mit einem Klick auf den Button wird das Konto des Users mit dem eingegeben Geldbetrag aufgeladen
- * \Der gewünschte Geldbetrag wird ausgelesen, in einen Double konvertiert und dem Nutzer hinzugefügt
- * \Anschließend wird diese Transaktion in verschiedenen Logs niedergeschrieben und die veränderten Objekte werden in den jeweiligen Datenbanken gesichert
+ * \Der gewünschte Geldbetrag wird ausgelesen, exakt in Cent umgewandelt (mehr als zwei Nachkommastellen werden gerundet) und dem Nutzer hinzugefügt
+ * \Das Aufladen selbst (Logs und Journal) übernimmt die Engine (siehe PosEngine::deposit)
+ * \Die Laufzeiten von Eingabe, Anzeige und der ganzen Einzahlung werden für das Kommando stats erfasst
  */
 void userwindow::on_pushButton_saveTransaction_clicked()
 {
+    LatencyStats &latency = engine.getLatencyStats();
+    LatencyStats::Clock::time_point depositStart = LatencyStats::Clock::now();
     QString sNewBalance = ui->label_display->text();
     QString sTransactionID = ui->label_transactionID->text();
-    double dNewBalance;
-    if (sNewBalance.contains(",")) {
-        sNewBalance.replace(",","."); // , mit . ersetzen, da toDouble sonst nicht die gesamte Zahl erkennt
-        dNewBalance = sNewBalance.toDouble();
-        int iNewBalance = (dNewBalance * 100); // letzte zwei Nachkommastellen mit Aufnehmen, alles andere fällt weg
-        dNewBalance = (iNewBalance/100.0); // Zahl wieder in den Double zurück konvertieren
-    }
-    else {
-       dNewBalance = sNewBalance.toDouble();
+    Money newBalance;
+    string error;
+    if (!Money::parse(sNewBalance.toStdString(), newBalance)) { // Money::parse akzeptiert auch "," als Dezimaltrennzeichen
+        ui->label_error->setText("Ungültiger Betrag!");
+        return;
     }
-    users[activeUserID].setBalance(-dNewBalance);
-    system.setvBalance(system.getvBalance()+dNewBalance);
-    ofstream depositlog; //Transaktion in desositlog schreiben
-    depositlog.open("depositlog.txt", ios::out | ios::app);
-    if (depositlog.is_open()) {
-        depositlog << sTransactionID.toStdString() << " | " << users[activeUserID].getName() << "\t| +" << dNewBalance << "\t| " << system.getvBalance() << endl;
+    latency.record(LatencyStats::DepositParse, depositStart);
+    if (!engine.deposit(activeUserID, newBalance, sTransactionID.toStdString(), error)) {
+        ui->label_error->setText(QString::fromStdString(error));
+        return;
     }
-    else {
-        exit(-1);
-    }
-    depositlog.close();
-    ofstream transactionlog; //Transaktion in transactionlog schreiben
-           transactionlog.open("transactionlog.txt", ios::out | ios::app);
-           if (transactionlog.is_open()) {
-               QString timestamp = QDateTime::currentDateTime().toString("MMddhhmmss");
-               transactionlog << timestamp.toStdString() << " | " << convertUserID(activeUserID) << " | +" << dNewBalance << "\t| " << users[activeUserID].getBalance() << "\t| " << "AUFLADUNG" << endl;
-           }
-           else {
-               exit(-1);
-           }
-    transactionlog.close();
-    writeUsersToDB(users);
-    writeSystemToDB(system);
+    LatencyStats::Clock::time_point guiStart = LatencyStats::Clock::now();
     updateMenuButtons(true);
-    ui->label_balance->setText(QString::number(users[activeUserID].getBalance()) + " €");
+    ui->label_balance->setText(QString::fromStdString(users[activeUserID].getBalance().toString()) + " €");
     ui->label_display->setText("");
     ui->label_error->setText("");
     ui->stackedWidget->setCurrentIndex(1);
+    latency.record(LatencyStats::DepositGui, guiStart);
+    latency.record(LatencyStats::DepositTotal, depositStart);
 }
 
 /**\brief Zeigt das Einstellungs-Fenster
@@ -670,12 +845,10 @@ void userwindow::on_pushButton_settings_clicked()
 
 /**\brief HYDRA (kümmert sich um die Erkennung der Kommandos)
  * Im Grunde wurde hier ein CLI in einem GUI verbrochen...
- * Das eingegebene Kommando wird in einen String geschrieben und dieser wird dann in eine Liste aus Strings unterteilt. In dieser Stringliste ist jedes eingegebene Wort ein einzelner String.
- * Im nächsten Schritt wird mit if-else Prüfungen bestimmt, welches Kommando gerade gewünscht ist. (Das erste Wort bestimmt jeweils das gewünschte Kommando)
- * (Es wurde if-else verwendet, da case-switch nur umständlich mit Strings klar kommt)
- * Im weiteren Verlauf werden entweder direkt die gewünschten Operationen ausgeführt und Ausgaben an die Oberfläche erfolgen...
- * ... oder die in den anderen Wörtern angegebenen Parameter werden noch überprüft, umgewandelt und der gewünschten Operation als Attribut(e) übergeben.
- * Mit diesem Wissen sollten die jeweiligen Blöcke ziemlich selbsterklärend sein.
+ * Das eingegebene Kommando wird in eine Liste aus Strings unterteilt, in der jedes eingegebene Wort ein einzelner String ist.
+ * Das erste Wort wird mit runCommand über commandIndex in der commandTable nachgeschlagen (konstante Zeit statt einer Kette aus if-else Prüfungen),
+ * danach wird der eingetragene Handler (command...) mit der kompletten Liste aufgerufen.
+ * Jeder Handler prüft und wandelt seine Parameter selbst um und meldet Fehler über commandFailed; neue Kommandos brauchen also nur einen Handler und eine Zeile in der commandTable.
  * Etwas speziell ist noch die Funktion zum Einloggen. Es kann zwar nur ein Admin auf die Einstellungen zugreifen, aber um ganz großen Unfug zu verhindern, sind die Einstellungen noch pro-forma durch ein Passwort geschützt. (Schließlich muss man sich zur besseren Usability als Nutzer ja nicht einloggen)
  */
 void userwindow::on_lineEdit_cl_returnPressed()
@@ -683,394 +856,10 @@ void userwindow::on_lineEdit_cl_returnPressed()
     QString input = ui->lineEdit_cl->text();
     QStringList query = input.split(" ");
     if (adminLoggedIn) {
-    // Start der Kommandos die nach dem Einloggen verfügbar sind
-        if (query[0] != "setpw") {
-            ui->textBrowser_clOutput->append("~$ " + input);
-        }
-        if (query[0] == "logout") {
-            adminLoggedIn = false;
-            ui->textBrowser_clOutput->append("Erfolgreich ausgeloggt.");
-            ui->lineEdit_cl->setEchoMode(QLineEdit::Password);
-            updateMenuButtons(true);
-            ui->stackedWidget->setCurrentIndex(1);
-        }
-        else if (query[0] == "restart") {
-            ui->textBrowser_clOutput->append("Programm wird neu gestartet...");
-            writeUsersToDB(users); // sicherheitshalber noch alles abspeichern
-            writeBeveragesToDB(beverages);
-            qApp->quit();
-            QProcess::startDetached(qApp->arguments()[0], qApp->arguments());
-        }
-        else if (query[0] == "shutdown") {
-            ui->textBrowser_clOutput->append("Programm wird geschlossen...");
-            writeUsersToDB(users); // sicherheitshalber noch alles abspeichern
-            writeBeveragesToDB(beverages);
-            qApp->quit();
-        }
-        else if (query[0] == "setpw") {
-            ui->textBrowser_clOutput->append("~$ setpw *****");
-            if (query.size() == 2) {
-                string oldpw = system.getPassword();
-                QString newpw = query[1];
-                system.setPassword(newpw.toStdString());
-                if (system.getPassword() == oldpw) {
-                    ui->textBrowser_clOutput->append("Das Passwort wurde nicht geändert. War es lang genug?");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Das Passwort wurde erfolgreich geändert!");
-                    writeSystemToDB(system);
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'setpw'...");
-            }
-        }
-        else if (query[0] == "help") {
-            ui->textBrowser_clOutput->append("#### Hilfeseite des GK-Kommandozeilen-Tools ####");
-            ui->textBrowser_clOutput->append("logout");
-            ui->textBrowser_clOutput->append("   [Meldet Sie ab]");
-            ui->textBrowser_clOutput->append("shutdown");
-            ui->textBrowser_clOutput->append("   [Schließt das Programm]");
-            ui->textBrowser_clOutput->append("restart");
-            ui->textBrowser_clOutput->append("   [Startet das Programm neu]");
-            ui->textBrowser_clOutput->append("setpw <neues Passwort>");
-            ui->textBrowser_clOutput->append("   [Setzt ein neues globales Passwort]");
-            ui->textBrowser_clOutput->append("   <neues Passwort>=(string)");
-            ui->textBrowser_clOutput->append("help");
-            ui->textBrowser_clOutput->append("   [Zeigt diese Hilfeseite an]");
-            ui->textBrowser_clOutput->append("lsusr");
-            ui->textBrowser_clOutput->append("   [Listet alle Nutzer auf]");
-            ui->textBrowser_clOutput->append("addusr <Name> <Rolle>");
-            ui->textBrowser_clOutput->append("   [Erstellt einen neuen Nutzer]");
-            ui->textBrowser_clOutput->append("   [0=deaktiviert, 1=nutzer, 2=admin]");
-            ui->textBrowser_clOutput->append("   <Name>=(string)");
-            ui->textBrowser_clOutput->append("   <Rolle>=(int)");
-            ui->textBrowser_clOutput->append("delusr <ID>");
-            ui->textBrowser_clOutput->append("   [Löscht den Nutzer mit der angegebenen ID]");
-            ui->textBrowser_clOutput->append("   <ID>=(int)");
-            ui->textBrowser_clOutput->append("setrole <Nutzer-ID> <Rolle>");
-            ui->textBrowser_clOutput->append("   [setzt die Rolle eines Nutzers neu]");
-            ui->textBrowser_clOutput->append("   [0=deaktiviert, 1=nutzer, 2=admin]");
-            ui->textBrowser_clOutput->append("   <ID>=(int)");
-            ui->textBrowser_clOutput->append("   <Rolle>=(int)");
-            ui->textBrowser_clOutput->append("lsbvr");
-            ui->textBrowser_clOutput->append("   [Listet alle Getränke auf]");
-            ui->textBrowser_clOutput->append("addbvr <Name> <Preis> <Barcode>");
-            ui->textBrowser_clOutput->append("   [Erstellt ein neues Getränk]");
-            ui->textBrowser_clOutput->append("   <Name>=(string)");
-            ui->textBrowser_clOutput->append("   <Preis>=(double)");
-            ui->textBrowser_clOutput->append("   <Barcode>=(int)");
-            ui->textBrowser_clOutput->append("delbvr <ID>");
-            ui->textBrowser_clOutput->append("   [Löscht das Getränk mit der angegeben ID]");
-            ui->textBrowser_clOutput->append("   <ID>=(int)");
-            ui->textBrowser_clOutput->append("setbvrprice <ID> <Preis>");
-            ui->textBrowser_clOutput->append("   [Setzt den Preis eines Getränks neu]");
-            ui->textBrowser_clOutput->append("   <ID>=(int)");
-            ui->textBrowser_clOutput->append("   <Preis>=(double)");
-            ui->textBrowser_clOutput->append("abvro <ID> <Anzahl>");
-            ui->textBrowser_clOutput->append("   [Bucht eine gewünschte Anzahl an neuen");
-            ui->textBrowser_clOutput->append("    Flaschen dem angegebenen Getränk hinzu]");
-            ui->textBrowser_clOutput->append("   <ID>=(int)");
-            ui->textBrowser_clOutput->append("   <Anzahl>=(int)");
-            ui->textBrowser_clOutput->append("getconsumption");
-            ui->textBrowser_clOutput->append("   [Zeigt die Änderung des Bestandes seit der");
-            ui->textBrowser_clOutput->append("    letzten Getränkebestellung]");
-            ui->textBrowser_clOutput->append("depositlog");
-            ui->textBrowser_clOutput->append("   [Zeigt alle Einzahlungen aller Nutzer]");
-            ui->textBrowser_clOutput->append("statement");
-            ui->textBrowser_clOutput->append("   [Zeigt den aktuellen Kontostand der Kasse]");
-            ui->textBrowser_clOutput->append("withdraw <Betrag>");
-            ui->textBrowser_clOutput->append("   [Zieht virtuelles Guthaben von der Kasse ab,");
-            ui->textBrowser_clOutput->append("    wenn das reale Geld für eine Bestellung");
-            ui->textBrowser_clOutput->append("    verwendet wurde]");
-            ui->textBrowser_clOutput->append("   <Betrag>=(double)");
-            ui->textBrowser_clOutput->append("cleardeplog");
-            ui->textBrowser_clOutput->append("   [Löscht sämtliche vorherige Einzahlungen.");
-            ui->textBrowser_clOutput->append("    Sinvoll nach einem Kassensturz, damit beim");
-            ui->textBrowser_clOutput->append("    nächsten Sturz nicht alte Einzahlungen");
-            ui->textBrowser_clOutput->append("    überprüft werden.]");
-            ui->textBrowser_clOutput->append("############## Ende der Hilfeseite #############");
-        }
-        else if (query[0] == "lsusr") {
-            ui->textBrowser_clOutput->append("Liste aller Nutzer:");
-            for (int i=0; i < users.size(); i++) {
-                ui->textBrowser_clOutput->append("ID: " + QString::number(i) + " Name: " + QString::fromStdString(users[i].getName()));
-            }
-            ui->textBrowser_clOutput->append("Ende der Liste");
-        }
-        else if (query[0] == "lsbvr") {
-            ui->textBrowser_clOutput->append("Liste aller Getränke:");
-            for (int i=0; i < beverages.size(); i++) {
-                ui->textBrowser_clOutput->append("ID: " + QString::number(i) + " | " + QString::fromStdString(beverages[i].getName()) + " | " + QString::number(beverages[i].getPrice()) + "€ | " + QString::number(beverages[i].getStock()) + " Flaschen");
-            }
-            ui->textBrowser_clOutput->append("Ende der Liste");
-        }
-        else if (query[0] == "setrole") {
-            if (query.size() == 3) {
-                int userid = query[1].toInt();
-                int role = query[2].toInt();
-                if (userid >= 0 && role >= 0) {
-                    users[userid].editRole(role);
-                    ui->textBrowser_clOutput->append("Nutzerrolle von " + QString::fromStdString(users[userid].getName()) + " erfolgreich geändert!");
-                    writeUsersToDB(users);
-                    ui->textBrowser_clOutput->append("Änderungen erfolgreich in der Datenbank gesichert.");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Falsche Paramter für 'setrole'...");
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'setrole'...");
-            }
-        }
-        else if (query[0] == "withdraw") {
-            if (query.size() == 2) {
-                double withdrawal = query[1].toDouble();
-                double currentvBalance = system.getvBalance();
-                if (withdrawal > 0 && currentvBalance >= withdrawal) {
-                    system.setvBalance(currentvBalance-withdrawal);
-                    ui->textBrowser_clOutput->append("Es wurden " + QString::number(withdrawal) + "€ abgebucht.");
-                    ui->textBrowser_clOutput->append("Das Guthaben der Kasse beträgt jetzt: " + QString::number(system.getvBalance()) + "€");
-                    writeSystemToDB(system);
-                    ui->textBrowser_clOutput->append("Änderungen erfolgreich in der Datenbank gesichert.");
-                    ui->textBrowser_clOutput->append("Wollen Sie die letzten Buchungen löschen?");
-                    ui->textBrowser_clOutput->append("Nach einem Kassensturz ist dies zu empfehlen!");
-                    ui->textBrowser_clOutput->append("Führen Sie dazu bitte 'cleardeplog' aus...");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Nicht genug Geld in der Kasse...");
-
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'withdraw'...");
-            }
-
-        }
-        else if (query[0] == "cleardeplog") {
-            ofstream depositlog;
-            QString sID = "00" + QDateTime::currentDateTime().toString("MMddhhmm");
-            depositlog.open("depositlog.txt");
-            if (depositlog.is_open()) {
-                depositlog << sID.toStdString() << "-" << "Abbuchung durch Admin; neuer Kontostand [€]: " << system.getvBalance() << endl;
-                depositlog << "---" << endl;
-            }
-            else {
-                ui->textBrowser_clOutput->append("Probleme beim Öffnen der Datenbank...");
-            }
-            depositlog.close();
-            ui->textBrowser_clOutput->append("Letzte Buchungen wurden gelöscht!");
-        }
-        else if (query[0] == "addusr") {
-            if (query.size() == 3) {
-                string name = query[1].toStdString();
-                bool userexists = false;
-                for (int i=0; i < users.size(); i++) {
-                    if (query[1] == QString::fromStdString(users[i].getName())) {
-                        userexists = true;
-                    }
-                }
-                if (!userexists) {
-                    if (query[2] == "0" || query[2] == "1" || query[2] == "2") {
-                        int role = query[2].toInt();
-                        User newuser;
-                        newuser.createUser(name,role);
-                        users.push_back(newuser);
-                        writeUsersToDB(users);
-                        updateUserGrid(users);
-                        ui->textBrowser_clOutput->append("Der neue Nutzer " + QString::fromStdString(name) + " wurde erstellt und der Nutzderdatenbank hinzugefügt.");
-                    }
-                    else {
-                       ui->textBrowser_clOutput->append("Die eingegebene Rolle ist nicht gültig!");
-                    }
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Der eingegebene Name existiert bereits!");
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'adduser'...");
-            }
-        }
-        else if (query[0] == "delusr") {
-            if (query.size() == 2) {
-                int id = query[1].toInt();
-                users.erase(users.begin() + id);
-                writeUsersToDB(users);
-                clearGrid(ui->gridLayout_userselect);
-                updateUserGrid(users);
-                ui->textBrowser_clOutput->append("Nutzer wurde gelöscht und Datenbanken aktualisiert.");
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'adduser'...");
-            }
-        }
-        else if (query[0] == "abvro") {
-            if (query.size() == 3) {
-                int id = query[1].toInt();
-                int order = query[2].toInt();
-                if (id >= 0 && id < beverages.size() && order > 0) {
-                    beverages[id].setLastOrder(beverages[id].getStock() + order);
-                    beverages[id].setStock(beverages[id].getStock() + order);
-                    writeBeveragesToDB(beverages);
-                    clearGrid(ui->gridLayout_beverageselect);
-                    updateBeverageGrid(beverages);
-                    ui->textBrowser_clOutput->append("Neuer Bestand von " + QString::fromStdString(beverages[id].getName()) + ": " + QString::number(beverages[id].getStock()));
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Unbekanntes Getränk, oder die Anzahl der hinzuzufügenden Getränke ist kleiner/gleich 0");
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'abvro'...");
-            }
-        }
-        else if (query[0] == "getstock") {
-            if (query.size() == 2) {
-                int id = query[1].toInt();
-                if (id >= 0 && id < beverages.size()) {
-                    ui->textBrowser_clOutput->append(QString::fromStdString(beverages[id].getName()) + ": " + QString::number(beverages[id].getStock()) + " Flaschen");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Unbekanntes Getränk");
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'getstock'...");
-            }
-        }
-        else if (query[0] == "addbvr") {
-            if (query.size() == 4) {
-                if (query[2].contains(",")) {
-                        query[2].replace(",",".");
-                }
-                string name = query[1].toStdString();
-                double price = query[2].toDouble();
-                int barcode = query[3].toInt();
-                bool beverageexists = false;
-                for (int i=0; i < beverages.size(); i++) {
-                    if (name == beverages[i].getName() || barcode == beverages[i].getBarcode() ) {
-                        beverageexists = true;
-                    }
-                }
-                if (!beverageexists) {
-                    Beverage newbeverage;
-                    newbeverage.createBeverage(name,price,barcode);
-                    beverages.push_back(newbeverage);
-                    writeBeveragesToDB(beverages);
-                    clearGrid(ui->gridLayout_beverageselect);
-                    updateBeverageGrid(beverages);
-                    ui->textBrowser_clOutput->append("Getränk wurde hinzugefügt und Datenbank aktualisiert.");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Getränk mit dem gewünschten Namen oder Barcode existiert bereits!");
-                }
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'addbvr'...");
-            }
-        }
-        else if (query[0] == "delbvr") {
-            if (query.size() == 2) {
-                int id = query[1].toInt();
-                if (beverages[id].getStock() == 0) {
-                    beverages.erase(beverages.begin() + id);
-                    writeBeveragesToDB(beverages);
-                    clearGrid(ui->gridLayout_beverageselect);
-                    updateBeverageGrid(beverages);
-                    ui->textBrowser_clOutput->append("Getränk wurde gelöscht und Datenbanken aktualisiert.");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Getränk kann nicht gelöscht werden, es gibt noch Bestand!");
-                }
-
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'delbvr'...");
-            }
-        }
-        else if (query[0] == "setbvrprice") {
-            if (query.size() == 3) {
-                if (query[2].contains(",")) {
-                        query[2].replace(",",".");
-                }
-                int id = query[1].toInt();
-                double price = query[2].toDouble();
-                beverages[id].editPrice(price);
-                writeBeveragesToDB(beverages);
-                clearGrid(ui->gridLayout_beverageselect);
-                updateBeverageGrid(beverages);
-                ui->textBrowser_clOutput->append("Neuer Getränkepreis wurde gespeichert.");
-            }
-            else {
-                ui->textBrowser_clOutput->append("Nicht genug oder zu viele Parameter für 'setbvrprice'...");
-            }
-        }
-        else if (query[0] == "getconsumption") {
-            ui->textBrowser_clOutput->append("|=====Verbrauchsliste=====|");
-            for (int i=0; i < beverages.size(); i++) {
-                if (beverages[i].getLastOrder() > 0) {
-                    double stock = beverages[i].getStock();
-                    double lastOrder = beverages[i].getLastOrder();
-                    double reference = 25 * (stock / lastOrder);
-                    char cBar[26];
-                    //ui->textBrowser_clOutput->append(QString::number(reference));
-                    for (int i = 1; i <= 25; i++) {
-                        if (i < reference) {
-                            if (i+1 < reference || i == 24){
-                                cBar[i-1] = '=';
-                            }
-                            else {
-                                cBar[i-1] = '<';
-                            }
-                        }
-                        else {
-                            if (reference == 25) {
-                                cBar[i-1] = '=';
-                            }
-                            else {
-                                cBar[i-1] = ' ';
-                            }
-                        }
-                    }
-                    string sBar(cBar);
-                    ui->textBrowser_clOutput->append("|" + QString::fromStdString(sBar) + "| " + QString::fromStdString(beverages[i].getName()) + " (" + QString::number(beverages[i].getStock()) + "/" + QString::number(beverages[i].getLastOrder()) + ")");
-                }
-                else {
-                    ui->textBrowser_clOutput->append("Noch keine Bestellung von " + QString::fromStdString(beverages[i].getName()) + " vorhanden...");
-                }
-
-            }
-            ui->textBrowser_clOutput->append("|===Ende Verbrauchsliste==|");
-        }
-        else if (query[0] == "statement"){
-            ui->textBrowser_clOutput->append("allgemeines Guthaben der Getränkekasse: " + QString::number(system.getvBalance()) + "€");
-        }
-        else if (query[0] == "depositlog") {
-            ui->textBrowser_clOutput->append("|===============Einzahlungsliste===============|");
-            ifstream depositlog;
-            depositlog.open("depositlog.txt");
-            if (depositlog.is_open()) {
-                while (depositlog.good()) {
-                    string deposit;
-                    getline (depositlog,deposit);
-                    if (deposit.empty()) {
-                        break;
-                    }
-                    else {
-                        ui->textBrowser_clOutput->append(QString::fromStdString(deposit));
-
-                    }
-                }
-            }
-            depositlog.close();
-            ui->textBrowser_clOutput->append("|==========Ende der Einzahlungsliste===========|");
-        }
-        else {
-            ui->textBrowser_clOutput->append("Das Kommando wurde nicht erkannt.");
-        }
+    // Kommandos, die nach dem Einloggen verfügbar sind (siehe commandTable)
+        echoCommand(input);
+        runCommand(query);
     }
-    // Ende der Kommandos
     else {
     // Login
         if (query[0] == QString::fromStdString(system.getPassword())) {
@@ -1085,3 +874,960 @@ void userwindow::on_lineEdit_cl_returnPressed()
     }
     ui->lineEdit_cl->setText("");
 }
+
+/**\brief Tabelle aller Kommandos der Kommandozeile
+ * Nicht stapelbar sind Kommandos, die das Programm beenden, selbst speichern, eine andere Seite öffnen oder aus den Logs lesen
+ * (die Logzeilen eines Stapels werden erst mit dem Stapel geschrieben).
+ */
+const userwindow::Command userwindow::commandTable[] = {
+    {"logout", &userwindow::commandLogout, false},
+    {"restart", &userwindow::commandRestart, false},
+    {"shutdown", &userwindow::commandShutdown, false},
+    {"setpw", &userwindow::commandSetPassword, true},
+    {"help", &userwindow::commandHelp, false},
+    {"lsusr", &userwindow::commandListUsers, true},
+    {"lsbvr", &userwindow::commandListBeverages, true},
+    {"setrole", &userwindow::commandSetRole, true},
+    {"withdraw", &userwindow::commandWithdraw, true},
+    {"cleardeplog", &userwindow::commandClearDepositLog, true},
+    {"addusr", &userwindow::commandAddUser, true},
+    {"delusr", &userwindow::commandDeleteUser, true},
+    {"renusr", &userwindow::commandRenameUser, true},
+    {"abvro", &userwindow::commandRestock, true},
+    {"getstock", &userwindow::commandGetStock, true},
+    {"addbvr", &userwindow::commandAddBeverage, true},
+    {"delbvr", &userwindow::commandDeleteBeverage, true},
+    {"renbvr", &userwindow::commandRenameBeverage, true},
+    {"setbvrprice", &userwindow::commandSetPrice, true},
+    {"getconsumption", &userwindow::commandConsumption, false},
+    {"sales", &userwindow::commandSales, true},
+    {"topusr", &userwindow::commandTopUsers, true},
+    {"analyze", &userwindow::commandAnalyze, false},
+    {"audit", &userwindow::commandAudit, false},
+    {"round", &userwindow::commandRound, true},
+    {"statement", &userwindow::commandStatement, true},
+    {"history", &userwindow::commandHistory, false},
+    {"depositlog", &userwindow::commandDepositLog, false},
+    {"setdurability", &userwindow::commandSetDurability, true},
+    {"logstats", &userwindow::commandLogStats, false},
+    {"stats", &userwindow::commandStats, false},
+    {"exportdb", &userwindow::commandExportDB, false},
+    {"importdb", &userwindow::commandImportDB, false},
+    {"batch", &userwindow::commandBatch, false},
+};
+const int userwindow::commandCount = sizeof(commandTable) / sizeof(commandTable[0]);
+
+/**\brief Gibt eine Eingabe der Kommandozeile aus (Passwörter werden nicht angezeigt)
+ * \param input
+ */
+void userwindow::echoCommand(const QString &input)
+{
+    if (input.split(" ")[0] == "setpw") {
+        ui->textBrowser_clOutput->append("~$ setpw *****");
+    }
+    else {
+        ui->textBrowser_clOutput->append("~$ " + input);
+    }
+}
+
+/**\brief Sucht ein Kommando in der Kommandotabelle und führt es aus
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando unbekannt ist, im Stapel nicht erlaubt ist oder fehlschlägt)
+ */
+bool userwindow::runCommand(const QStringList &query)
+{
+    int slot = commandIndex.find(query[0].toStdString());
+    if (slot < 0) {
+        return commandFailed("Das Kommando wurde nicht erkannt.");
+    }
+    if (batchRunning && !commandTable[slot].batchable) {
+        return commandFailed("Das Kommando '" + query[0] + "' ist in einem Stapel nicht erlaubt.");
+    }
+    return (this->*commandTable[slot].handler)(query);
+}
+
+/**\brief Gibt die Fehlermeldung eines Kommandos aus
+ * \param message
+ * \return bool (immer false, damit Kommandos mit return commandFailed(...) abbrechen können)
+ */
+bool userwindow::commandFailed(const QString &message)
+{
+    ui->textBrowser_clOutput->append(message);
+    return false;
+}
+
+/**\brief Kommando "logout": meldet den Admin ab
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandLogout(const QStringList &query)
+{
+    Q_UNUSED(query);
+    adminLoggedIn = false;
+    ui->textBrowser_clOutput->append("Erfolgreich ausgeloggt.");
+    ui->lineEdit_cl->setEchoMode(QLineEdit::Password);
+    updateMenuButtons(true);
+    ui->stackedWidget->setCurrentIndex(1);
+    return true;
+}
+
+/**\brief Kommando "restart": sichert alles und startet das Programm neu
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandRestart(const QStringList &query)
+{
+    Q_UNUSED(query);
+    ui->textBrowser_clOutput->append("Programm wird neu gestartet...");
+    engine.saveSnapshot(); // sicherheitshalber noch alles abspeichern
+    engine.flush(); // und warten, bis wirklich alles geschrieben wurde
+    qApp->quit();
+    QProcess::startDetached(qApp->arguments()[0], qApp->arguments());
+    return true;
+}
+
+/**\brief Kommando "shutdown": sichert alles und beendet das Programm
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandShutdown(const QStringList &query)
+{
+    Q_UNUSED(query);
+    ui->textBrowser_clOutput->append("Programm wird geschlossen...");
+    engine.saveSnapshot(); // sicherheitshalber noch alles abspeichern
+    engine.flush(); // und warten, bis wirklich alles geschrieben wurde
+    qApp->quit();
+    return true;
+}
+
+/**\brief Kommando "setpw": setzt ein neues globales Passwort
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandSetPassword(const QStringList &query)
+{
+    if (query.size() == 2) {
+        if (engine.setPassword(query[1].toStdString())) {
+            ui->textBrowser_clOutput->append("Das Passwort wurde erfolgreich geändert!");
+        }
+        else {
+            return commandFailed("Das Passwort wurde nicht geändert. War es lang genug?");
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'setpw'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "help": zeigt alle Kommandos
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandHelp(const QStringList &query)
+{
+    Q_UNUSED(query);
+    ui->textBrowser_clOutput->append("#### Hilfeseite des GK-Kommandozeilen-Tools ####");
+    ui->textBrowser_clOutput->append("logout");
+    ui->textBrowser_clOutput->append("   [Meldet Sie ab]");
+    ui->textBrowser_clOutput->append("shutdown");
+    ui->textBrowser_clOutput->append("   [Schließt das Programm]");
+    ui->textBrowser_clOutput->append("restart");
+    ui->textBrowser_clOutput->append("   [Startet das Programm neu]");
+    ui->textBrowser_clOutput->append("setpw <neues Passwort>");
+    ui->textBrowser_clOutput->append("   [Setzt ein neues globales Passwort]");
+    ui->textBrowser_clOutput->append("   <neues Passwort>=(string)");
+    ui->textBrowser_clOutput->append("help");
+    ui->textBrowser_clOutput->append("   [Zeigt diese Hilfeseite an]");
+    ui->textBrowser_clOutput->append("lsusr");
+    ui->textBrowser_clOutput->append("   [Listet alle Nutzer auf]");
+    ui->textBrowser_clOutput->append("addusr <Name> <Rolle>");
+    ui->textBrowser_clOutput->append("   [Erstellt einen neuen Nutzer]");
+    ui->textBrowser_clOutput->append("   [0=deaktiviert, 1=nutzer, 2=admin]");
+    ui->textBrowser_clOutput->append("   <Name>=(string)");
+    ui->textBrowser_clOutput->append("   <Rolle>=(int)");
+    ui->textBrowser_clOutput->append("delusr <ID>");
+    ui->textBrowser_clOutput->append("   [Löscht den Nutzer mit der angegebenen ID]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("renusr <ID> <Name>");
+    ui->textBrowser_clOutput->append("   [Benennt einen Nutzer um]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("   <Name>=(string)");
+    ui->textBrowser_clOutput->append("setrole <Nutzer-ID> <Rolle>");
+    ui->textBrowser_clOutput->append("   [setzt die Rolle eines Nutzers neu]");
+    ui->textBrowser_clOutput->append("   [0=deaktiviert, 1=nutzer, 2=admin]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("   <Rolle>=(int)");
+    ui->textBrowser_clOutput->append("lsbvr");
+    ui->textBrowser_clOutput->append("   [Listet alle Getränke auf]");
+    ui->textBrowser_clOutput->append("addbvr <Name> <Preis> <Barcode>");
+    ui->textBrowser_clOutput->append("   [Erstellt ein neues Getränk]");
+    ui->textBrowser_clOutput->append("   <Name>=(string)");
+    ui->textBrowser_clOutput->append("   <Preis>=(Betrag, z.B. 1,20)");
+    ui->textBrowser_clOutput->append("   <Barcode>=(Ziffern, z.B. EAN-13)");
+    ui->textBrowser_clOutput->append("delbvr <ID>");
+    ui->textBrowser_clOutput->append("   [Löscht das Getränk mit der angegeben ID]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("renbvr <ID> <Name>");
+    ui->textBrowser_clOutput->append("   [Benennt ein Getränk um]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("   <Name>=(string)");
+    ui->textBrowser_clOutput->append("setbvrprice <ID> <Preis>");
+    ui->textBrowser_clOutput->append("   [Setzt den Preis eines Getränks neu]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("   <Preis>=(Betrag, z.B. 1,20)");
+    ui->textBrowser_clOutput->append("abvro <ID> <Anzahl>");
+    ui->textBrowser_clOutput->append("   [Bucht eine gewünschte Anzahl an neuen");
+    ui->textBrowser_clOutput->append("    Flaschen dem angegebenen Getränk hinzu]");
+    ui->textBrowser_clOutput->append("   <ID>=(int)");
+    ui->textBrowser_clOutput->append("   <Anzahl>=(int)");
+    ui->textBrowser_clOutput->append("round <Getränke-ID> <Nutzer-ID>[:<Getränke-ID>] ...");
+    ui->textBrowser_clOutput->append("   [Bucht eine Runde für mehrere Nutzer auf");
+    ui->textBrowser_clOutput->append("    einmal; ganz oder gar nicht]");
+    ui->textBrowser_clOutput->append("   <Getränke-ID>=(int, für alle Nutzer ohne");
+    ui->textBrowser_clOutput->append("    eigenes Getränk)");
+    ui->textBrowser_clOutput->append("   <Nutzer-ID>=(int)");
+    ui->textBrowser_clOutput->append("getconsumption");
+    ui->textBrowser_clOutput->append("   [Zeigt die Änderung des Bestandes seit der");
+    ui->textBrowser_clOutput->append("    letzten Getränkebestellung]");
+    ui->textBrowser_clOutput->append("sales [<von JJJJMMTT> [<bis JJJJMMTT>]]");
+    ui->textBrowser_clOutput->append("   [Zeigt Flaschen, Umsatz und Einzahlungen pro");
+    ui->textBrowser_clOutput->append("    Tag, ohne Parameter für den aktuellen Monat]");
+    ui->textBrowser_clOutput->append("topusr [<Anzahl>]");
+    ui->textBrowser_clOutput->append("   [Zeigt die Nutzer mit den meisten gekauften");
+    ui->textBrowser_clOutput->append("    Flaschen]");
+    ui->textBrowser_clOutput->append("analyze [<von JJJJMMTT> [<bis JJJJMMTT>]]");
+    ui->textBrowser_clOutput->append("   [Wertet alle Buchungen des Zeitraums nach");
+    ui->textBrowser_clOutput->append("    Tagen, Getränken und Nutzern aus, ohne");
+    ui->textBrowser_clOutput->append("    Parameter den aktuellen Monat]");
+    ui->textBrowser_clOutput->append("audit");
+    ui->textBrowser_clOutput->append("   [Prüft transactionlog.txt und depositlog.txt");
+    ui->textBrowser_clOutput->append("    gegen alle Guthaben und den Kassenstand und");
+    ui->textBrowser_clOutput->append("    zeigt abweichende Zeilen]");
+    ui->textBrowser_clOutput->append("history <ID> [<von> [<bis>]]");
+    ui->textBrowser_clOutput->append("   [Zeigt die Buchungen eines Nutzers (neueste");
+    ui->textBrowser_clOutput->append("    zuerst), optional nur aus einem Zeitraum]");
+    ui->textBrowser_clOutput->append("   <von>, <bis>=(int, JJJJMM oder JJJJMMTT)");
+    ui->textBrowser_clOutput->append("depositlog [<von> [<bis>]]");
+    ui->textBrowser_clOutput->append("   [Zeigt alle Einzahlungen aller Nutzer (neueste");
+    ui->textBrowser_clOutput->append("    zuerst), optional nur aus einem Zeitraum]");
+    ui->textBrowser_clOutput->append("   <von>, <bis>=(int, JJJJMM oder JJJJMMTT)");
+    ui->textBrowser_clOutput->append("statement");
+    ui->textBrowser_clOutput->append("   [Zeigt den aktuellen Kontostand der Kasse]");
+    ui->textBrowser_clOutput->append("withdraw <Betrag>");
+    ui->textBrowser_clOutput->append("   [Zieht virtuelles Guthaben von der Kasse ab,");
+    ui->textBrowser_clOutput->append("    wenn das reale Geld für eine Bestellung");
+    ui->textBrowser_clOutput->append("    verwendet wurde]");
+    ui->textBrowser_clOutput->append("   <Betrag>=(Betrag, z.B. 50,00)");
+    ui->textBrowser_clOutput->append("cleardeplog");
+    ui->textBrowser_clOutput->append("   [Löscht sämtliche vorherige Einzahlungen,");
+    ui->textBrowser_clOutput->append("    auch die archivierten Monate.");
+    ui->textBrowser_clOutput->append("    Sinvoll nach einem Kassensturz, damit beim");
+    ui->textBrowser_clOutput->append("    nächsten Sturz nicht alte Einzahlungen");
+    ui->textBrowser_clOutput->append("    überprüft werden.]");
+    ui->textBrowser_clOutput->append("setdurability <Stufe>");
+    ui->textBrowser_clOutput->append("   [Legt fest, wie sicher Journal und Logs");
+    ui->textBrowser_clOutput->append("    geschrieben werden]");
+    ui->textBrowser_clOutput->append("   [0=kein fsync, 1=fsync pro Gruppe,");
+    ui->textBrowser_clOutput->append("    2=fsync pro Eintrag]");
+    ui->textBrowser_clOutput->append("   <Stufe>=(int)");
+    ui->textBrowser_clOutput->append("logstats");
+    ui->textBrowser_clOutput->append("   [Zeigt Gruppengrößen und Schreibdauer von");
+    ui->textBrowser_clOutput->append("    Journal und Logs und setzt sie zurück]");
+    ui->textBrowser_clOutput->append("stats");
+    ui->textBrowser_clOutput->append("   [Zeigt p50/p99/max der einzelnen Phasen von");
+    ui->textBrowser_clOutput->append("    Verkauf und Einzahlung und setzt sie zurück;");
+    ui->textBrowser_clOutput->append("    dazu die Dauer des Programmstarts]");
+    ui->textBrowser_clOutput->append("exportdb");
+    ui->textBrowser_clOutput->append("   [Schreibt Nutzer, Getränke und System in die");
+    ui->textBrowser_clOutput->append("    Textdatenbanken (userDB.txt, ...)]");
+    ui->textBrowser_clOutput->append("importdb");
+    ui->textBrowser_clOutput->append("   [Ersetzt alle Nutzer, Getränke und das System");
+    ui->textBrowser_clOutput->append("    durch den Inhalt der Textdatenbanken]");
+    ui->textBrowser_clOutput->append("batch <Datei>");
+    ui->textBrowser_clOutput->append("   [Führt alle Kommandos der Datei (eins pro");
+    ui->textBrowser_clOutput->append("    Zeile) gemeinsam aus; schlägt eines fehl,");
+    ui->textBrowser_clOutput->append("    wird nichts gespeichert]");
+    ui->textBrowser_clOutput->append("############## Ende der Hilfeseite #############");
+    return true;
+}
+
+/**\brief Kommando "lsusr": listet alle Nutzer auf
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandListUsers(const QStringList &query)
+{
+    Q_UNUSED(query);
+    ui->textBrowser_clOutput->append("Liste aller Nutzer:");
+    for (int i=0; i < users.size(); i++) {
+        ui->textBrowser_clOutput->append("ID: " + QString::number(i) + " Name: " + QString::fromStdString(users[i].getName()));
+    }
+    ui->textBrowser_clOutput->append("Ende der Liste");
+    return true;
+}
+
+/**\brief Kommando "lsbvr": listet alle Getränke auf
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandListBeverages(const QStringList &query)
+{
+    Q_UNUSED(query);
+    ui->textBrowser_clOutput->append("Liste aller Getränke:");
+    for (int i=0; i < beverages.size(); i++) {
+        ui->textBrowser_clOutput->append("ID: " + QString::number(i) + " | " + QString::fromStdString(beverages[i].getName()) + " | " + QString::fromStdString(beverages[i].getPrice().toString()) + "€ | " + QString::number(beverages[i].getStock()) + " Flaschen");
+    }
+    ui->textBrowser_clOutput->append("Ende der Liste");
+    return true;
+}
+
+/**\brief Kommando "setrole": ändert die Rolle eines Nutzers
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandSetRole(const QStringList &query)
+{
+    if (query.size() == 3) {
+        int userid = query[1].toInt();
+        string error;
+        if (engine.setRole(userid, query[2].toInt(), error)) {
+            ui->textBrowser_clOutput->append("Nutzerrolle von " + QString::fromStdString(users[userid].getName()) + " erfolgreich geändert!");
+            ui->textBrowser_clOutput->append("Änderungen erfolgreich in der Datenbank gesichert.");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'setrole'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "withdraw": entnimmt Geld aus der Kasse
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandWithdraw(const QStringList &query)
+{
+    if (query.size() == 2) {
+        Money withdrawal;
+        string error;
+        if (Money::parse(query[1].toStdString(), withdrawal) && engine.withdraw(withdrawal, error)) {
+            ui->textBrowser_clOutput->append("Es wurden " + QString::fromStdString(withdrawal.toString()) + "€ abgebucht.");
+            ui->textBrowser_clOutput->append("Das Guthaben der Kasse beträgt jetzt: " + QString::fromStdString(system.getvBalance().toString()) + "€");
+            ui->textBrowser_clOutput->append("Änderungen erfolgreich in der Datenbank gesichert.");
+            ui->textBrowser_clOutput->append("Wollen Sie die letzten Buchungen löschen?");
+            ui->textBrowser_clOutput->append("Nach einem Kassensturz ist dies zu empfehlen!");
+            ui->textBrowser_clOutput->append("Führen Sie dazu bitte 'cleardeplog' aus...");
+        }
+        else {
+            return commandFailed("Nicht genug Geld in der Kasse...");
+
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'withdraw'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "cleardeplog": leert die Einzahlungsliste
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandClearDepositLog(const QStringList &query)
+{
+    Q_UNUSED(query);
+    engine.clearDepositLog();
+    ui->textBrowser_clOutput->append("Letzte Buchungen wurden gelöscht!");
+    return true;
+}
+
+/**\brief Kommando "addusr": legt einen Nutzer an
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandAddUser(const QStringList &query)
+{
+    if (query.size() == 3) {
+        string name = query[1].toStdString();
+        string error;
+        bool validRole;
+        int role = query[2].toInt(&validRole);
+        if (engine.addUser(name, validRole ? role : -1, error)) {
+            updateUserGrid();
+            ui->textBrowser_clOutput->append("Der neue Nutzer " + QString::fromStdString(name) + " wurde erstellt und der Nutzderdatenbank hinzugefügt.");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'adduser'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "delusr": löscht einen Nutzer
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandDeleteUser(const QStringList &query)
+{
+    if (query.size() == 2) {
+        string error;
+        if (engine.deleteUser(query[1].toInt(), error)) {
+            userModel->clearMarked(); // Positionen haben sich verschoben
+            updateUserGrid();
+            ui->textBrowser_clOutput->append("Nutzer wurde gelöscht und Datenbanken aktualisiert.");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'adduser'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "renusr": benennt einen Nutzer um
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandRenameUser(const QStringList &query)
+{
+    if (query.size() == 3) {
+        int id = query[1].toInt();
+        string error;
+        if (engine.renameUser(id, query[2].toStdString(), error)) {
+            if (ui->lineEdit_usersearch->text().trimmed().isEmpty()) {
+                userModel->updateUser(id);
+            }
+            else { // der neue Name passt evtl. nicht mehr zur Suche
+                updateUserGrid();
+            }
+            ui->textBrowser_clOutput->append("Nutzer heißt jetzt " + QString::fromStdString(users[id].getName()) + "."); // zu kurze Namen werden ignoriert, daher den tatsächlichen Namen ausgeben
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'renusr'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "abvro": bucht eine Lieferung
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandRestock(const QStringList &query)
+{
+    if (query.size() == 3) {
+        int id = query[1].toInt();
+        string error;
+        if (engine.restock(id, query[2].toInt(), error)) {
+            updateBeverageButton(id);
+            ui->textBrowser_clOutput->append("Neuer Bestand von " + QString::fromStdString(beverages[id].getName()) + ": " + QString::number(beverages[id].getStock()));
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'abvro'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "getstock": zeigt den Bestand eines Getränks
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandGetStock(const QStringList &query)
+{
+    if (query.size() == 2) {
+        int id = query[1].toInt();
+        if (id >= 0 && id < beverages.size()) {
+            ui->textBrowser_clOutput->append(QString::fromStdString(beverages[id].getName()) + ": " + QString::number(beverages[id].getStock()) + " Flaschen");
+        }
+        else {
+            return commandFailed("Unbekanntes Getränk");
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'getstock'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "addbvr": legt ein Getränk an
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandAddBeverage(const QStringList &query)
+{
+    Money price;
+    bool barcodeOk = false;
+    long long barcode = query.size() == 4 ? query[3].toLongLong(&barcodeOk) : 0;
+    if (query.size() == 4 && Money::parse(query[2].toStdString(), price) && barcodeOk && barcode >= 0) {
+        string error;
+        if (engine.addBeverage(query[1].toStdString(), price, barcode, error)) {
+            updateBeverageGrid(beverages);
+            ui->textBrowser_clOutput->append("Getränk wurde hinzugefügt und Datenbank aktualisiert.");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'addbvr'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "delbvr": löscht ein Getränk
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandDeleteBeverage(const QStringList &query)
+{
+    if (query.size() == 2) {
+        string error;
+        if (engine.deleteBeverage(query[1].toInt(), error)) {
+            updateBeverageGrid(beverages);
+            ui->textBrowser_clOutput->append("Getränk wurde gelöscht und Datenbanken aktualisiert.");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'delbvr'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "renbvr": benennt ein Getränk um
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandRenameBeverage(const QStringList &query)
+{
+    if (query.size() == 3) {
+        int id = query[1].toInt();
+        string error;
+        if (engine.renameBeverage(id, query[2].toStdString(), error)) {
+            updateBeverageButton(id);
+            ui->textBrowser_clOutput->append("Getränk heißt jetzt " + QString::fromStdString(beverages[id].getName()) + ".");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'renbvr'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "setbvrprice": setzt einen neuen Getränkepreis
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandSetPrice(const QStringList &query)
+{
+    Money price;
+    if (query.size() == 3 && Money::parse(query[2].toStdString(), price)) {
+        int id = query[1].toInt();
+        string error;
+        if (engine.setPrice(id, price, error)) {
+            updateBeverageButton(id);
+            ui->textBrowser_clOutput->append("Neuer Getränkepreis wurde gespeichert.");
+        }
+        else {
+            return commandFailed(QString::fromStdString(error));
+        }
+    }
+    else {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'setbvrprice'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "getconsumption": zeigt die Verbrauchsliste
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandConsumption(const QStringList &query)
+{
+    Q_UNUSED(query);
+    vector<string> fLines = engine.getConsumption();
+    for (int i=0; i < fLines.size(); i++) {
+        ui->textBrowser_clOutput->append(QString::fromStdString(fLines[i]));
+    }
+    return true;
+}
+
+/**\brief Kommando "round": bucht eine Runde für mehrere Nutzer
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandRound(const QStringList &query)
+{
+    if (query.size() >= 3) {
+        bool valid;
+        int defaultID = query[1].toInt(&valid);
+        vector<pair<int, int> > fSales;
+        for (int i=2; valid && i < query.size(); i++) {
+            QStringList order = query[i].split(":"); // <NutzerID> oder <NutzerID>:<GetränkeID>
+            bool userOk;
+            bool beverageOk = true;
+            int userID = order[0].toInt(&userOk);
+            int id = defaultID;
+            if (order.size() == 2) {
+                id = order[1].toInt(&beverageOk);
+            }
+            if (!userOk || !beverageOk || order.size() > 2) {
+                valid = false;
+                break;
+            }
+            fSales.push_back(make_pair(userID, id));
+        }
+        QString error;
+        if (!valid) {
+            return commandFailed("Falsche Paramter für 'round'...");
+        }
+        else if (bookSales(fSales, error)) {
+            ui->textBrowser_clOutput->append("Runde mit " + QString::number(fSales.size()) + " Getränken wurde gebucht.");
+        }
+        else {
+            return commandFailed("Runde wurde nicht gebucht: " + error);
+        }
+    }
+    else {
+        return commandFailed("Nicht genug Parameter für 'round'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "statement": zeigt das Geld in der Kasse
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandStatement(const QStringList &query)
+{
+    Q_UNUSED(query);
+    ui->textBrowser_clOutput->append("allgemeines Guthaben der Getränkekasse: " + QString::fromStdString(system.getvBalance().toString()) + "€");
+    int today = PosEngine::today();
+    DayTotals day = engine.getSalesTotals(today, today);
+    DayTotals month = engine.getSalesTotals(today / 100 * 100 + 1, today / 100 * 100 + 31);
+    ui->textBrowser_clOutput->append("Umsatz heute: " + QString::fromStdString(day.revenue.toString()) + "€ (" + QString::number(day.sales) + " Flaschen), eingezahlt: " + QString::fromStdString(day.deposited.toString()) + "€");
+    ui->textBrowser_clOutput->append("Umsatz diesen Monat: " + QString::fromStdString(month.revenue.toString()) + "€ (" + QString::number(month.sales) + " Flaschen), eingezahlt: " + QString::fromStdString(month.deposited.toString()) + "€");
+    return true;
+}
+
+/**\brief Kommando "sales": zeigt Flaschen, Umsatz und Einzahlungen pro Tag (ohne Parameter für den aktuellen Monat)
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandSales(const QStringList &query)
+{
+    int fromDay = PosEngine::today() / 100 * 100 + 1;
+    int toDay = fromDay + 30;
+    bool validRange = query.size() <= 3;
+    if (validRange && query.size() >= 2) {
+        fromDay = query[1].toInt(&validRange);
+        toDay = fromDay;
+    }
+    if (validRange && query.size() == 3) {
+        toDay = query[2].toInt(&validRange);
+    }
+    if (!validRange) {
+        return commandFailed("Falsche Parameter für 'sales'...");
+    }
+    vector<string> fLines = engine.getSalesReport(fromDay, toDay);
+    for (int i=0; i < fLines.size(); i++) {
+        ui->textBrowser_clOutput->append(QString::fromStdString(fLines[i]));
+    }
+    return true;
+}
+
+/**\brief Kommando "analyze": wertet alle Buchungen eines Zeitraums nach Tagen, Getränken und Nutzern aus (ohne Parameter den aktuellen Monat)
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandAnalyze(const QStringList &query)
+{
+    int fromDay = PosEngine::today() / 100 * 100 + 1;
+    int toDay = fromDay + 30;
+    bool validRange = query.size() <= 3;
+    if (validRange && query.size() >= 2) {
+        fromDay = query[1].toInt(&validRange);
+        toDay = fromDay;
+    }
+    if (validRange && query.size() == 3) {
+        toDay = query[2].toInt(&validRange);
+    }
+    if (!validRange) {
+        return commandFailed("Falsche Parameter für 'analyze'...");
+    }
+    vector<string> fLines = engine.getAnalysis(fromDay, toDay, 10); // wartet, bis alle Buchungen geschrieben sind
+    for (int i=0; i < fLines.size(); i++) {
+        ui->textBrowser_clOutput->append(QString::fromStdString(fLines[i]));
+    }
+    return true;
+}
+
+/**\brief Kommando "audit": prüft transactionlog.txt und depositlog.txt gegen alle Guthaben und den Kassenstand (siehe LedgerAudit)
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandAudit(const QStringList &query)
+{
+    if (query.size() != 1) {
+        return commandFailed("Zu viele Parameter für 'audit'...");
+    }
+    vector<string> fLines = engine.audit(0); // wartet, bis alle Buchungen geschrieben sind
+    for (int i=0; i < fLines.size(); i++) {
+        ui->textBrowser_clOutput->append(QString::fromStdString(fLines[i]));
+    }
+    return true;
+}
+
+/**\brief Kommando "topusr": zeigt die Nutzer mit den meisten gekauften Flaschen
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandTopUsers(const QStringList &query)
+{
+    int count = 10;
+    bool validCount = query.size() <= 2;
+    if (validCount && query.size() == 2) {
+        count = query[1].toInt(&validCount);
+    }
+    if (!validCount) {
+        return commandFailed("Falsche Parameter für 'topusr'...");
+    }
+    vector<string> fLines = engine.getUserReport(count);
+    for (int i=0; i < fLines.size(); i++) {
+        ui->textBrowser_clOutput->append(QString::fromStdString(fLines[i]));
+    }
+    return true;
+}
+
+/**\brief Kommando "history": zeigt die Buchungen eines Nutzers auf der Seite der Historie
+ * Mit Zeitraum werden per Binärsuche nur die passenden Zeilen der betroffenen Monate geöffnet (siehe LogView::addSegmentRange).
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandHistory(const QStringList &query)
+{
+    int userID = -1;
+    int fromDay = 0;
+    int toDay = 99991231;
+    bool validRange = query.size() >= 2 && query.size() <= 4;
+    if (validRange) {
+        userID = query[1].toInt(&validRange);
+    }
+    if (validRange && (userID < 0 || userID >= (int)users.size())) {
+        return commandFailed("Unbekannter Nutzer");
+    }
+    if (validRange && query.size() >= 3) {
+        fromDay = query[2].toInt(&validRange);
+        toDay = fromDay;
+    }
+    if (validRange && query.size() == 4) {
+        toDay = query[3].toInt(&validRange);
+    }
+    if (validRange) {
+        PosEngine::expandDayRange(fromDay, toDay);
+        engine.openUserTransactions(userID, fromDay, toDay, historyModel->getView()); // wartet, bis auch die letzten Buchungen im Log stehen
+        historyModel->reload();
+        ui->textBrowser_clOutput->append("Historie von " + QString::fromStdString(users[userID].getName()) + ": " + QString::number(historyModel->getView().getRowCount()) + " Einträge (zurück mit dem Zurück-Button)");
+        ui->stackedWidget->setCurrentIndex(2);
+        ui->listView_history->scrollToTop();
+    }
+    else {
+        return commandFailed("Falsche Parameter für 'history'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "depositlog": zeigt die Einzahlungsliste
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandDepositLog(const QStringList &query)
+{
+    int fromDay = 0;
+    int toDay = 99991231;
+    bool validRange = query.size() <= 3;
+    if (validRange && query.size() >= 2) {
+        fromDay = query[1].toInt(&validRange);
+        toDay = fromDay;
+    }
+    if (validRange && query.size() == 3) {
+        toDay = query[2].toInt(&validRange);
+    }
+    if (validRange) {
+        PosEngine::expandDayRange(fromDay, toDay);
+        engine.openDeposits(fromDay, toDay, historyModel->getView()); // wartet, bis auch die letzten Einzahlungen im Log stehen
+        historyModel->reload();
+        ui->textBrowser_clOutput->append("Einzahlungsliste: " + QString::number(historyModel->getView().getRowCount()) + " Einträge (zurück mit dem Zurück-Button)");
+        ui->stackedWidget->setCurrentIndex(2);
+        ui->listView_history->scrollToTop();
+    }
+    else {
+        return commandFailed("Falsche Parameter für 'depositlog'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "setdurability": legt fest, wie sicher Journal und Logs geschrieben werden
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandSetDurability(const QStringList &query)
+{
+    if (query.size() == 2 && (query[1] == "0" || query[1] == "1" || query[1] == "2") && engine.setDurability(query[1].toInt())) {
+        ui->textBrowser_clOutput->append("Neue Durability: " + query[1]);
+    }
+    else {
+        return commandFailed("Falsche Parameter für 'setdurability'...");
+    }
+    return true;
+}
+
+/**\brief Kommando "logstats": zeigt die Schreibstatistik
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandLogStats(const QStringList &query)
+{
+    Q_UNUSED(query);
+    vector<LogWriterStats> stats = engine.getLogStats(); // wartet, bis alles geschrieben ist
+    const char *names[] = {"journal.txt", "transactionlog.txt", "depositlog.txt"};
+    ui->textBrowser_clOutput->append("|=====Schreibstatistik (Durability " + QString::number(system.getDurability()) + ")=====|");
+    for (int i=0; i < stats.size(); i++) {
+        double avgBatch = stats[i].commits > 0 ? (double) stats[i].records / stats[i].commits : 0;
+        unsigned long avgLatency = stats[i].commits > 0 ? stats[i].totalLatency / stats[i].commits : 0;
+        ui->textBrowser_clOutput->append(QString(names[i]) + ": " + QString::number(stats[i].commits) + " Gruppen, " + QString::number(stats[i].records) + " Einträge");
+        ui->textBrowser_clOutput->append("   Gruppengröße Ø " + QString::number(avgBatch, 'f', 1) + " / max " + QString::number(stats[i].maxBatch));
+        ui->textBrowser_clOutput->append("   Dauer Ø " + QString::number(avgLatency) + " µs / max " + QString::number(stats[i].maxLatency) + " µs");
+    }
+    engine.resetLogStats();
+    return true;
+}
+
+/**\brief Kommando "stats": zeigt die Laufzeiten von Verkauf und Einzahlung sowie die Dauer des Programmstarts
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandStats(const QStringList &query)
+{
+    Q_UNUSED(query);
+    vector<string> fLines = engine.getLatencyStats().report();
+    ui->textBrowser_clOutput->append("|=====Laufzeiten seit dem letzten 'stats'=====|");
+    for (int i=0; i < fLines.size(); i++) {
+        ui->textBrowser_clOutput->append(QString::fromStdString(fLines[i]));
+    }
+    if (fLines.empty()) {
+        ui->textBrowser_clOutput->append("Noch keine Verkäufe oder Einzahlungen gemessen.");
+    }
+    long long logLoadTime = engine.getLogLoadTime();
+    ui->textBrowser_clOutput->append("Start: erstes Bild nach " + QString::number(firstFrameTime) + " ms (Laden " + QString::number(loadTime) + " ms), Logs "
+                                     + (logLoadTime < 0 ? QString("werden noch geladen") : "nach weiteren " + QString::number(logLoadTime) + " ms geladen"));
+    engine.getLatencyStats().reset();
+    return true;
+}
+
+/**\brief Kommando "exportdb": schreibt die Textdatenbanken
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandExportDB(const QStringList &query)
+{
+    Q_UNUSED(query);
+    if (engine.exportDB()) {
+        ui->textBrowser_clOutput->append("Textdatenbanken wurden erfolgreich geschrieben.");
+    }
+    else {
+        return commandFailed("Probleme beim Schreiben der Textdatenbanken...");
+    }
+    return true;
+}
+
+/**\brief Kommando "importdb": importiert die Textdatenbanken
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn das Kommando nicht ausgeführt werden konnte)
+ */
+bool userwindow::commandImportDB(const QStringList &query)
+{
+    Q_UNUSED(query);
+    if (engine.importDB()) {
+        userModel->clearMarked();
+        updateUserGrid();
+        updateBeverageGrid(beverages);
+        ui->textBrowser_clOutput->append("Textdatenbanken wurden importiert und im Snapshot gesichert.");
+    }
+    else {
+        return commandFailed("Keine Nutzer in userDB.txt gefunden, es wurde nichts importiert.");
+    }
+    return true;
+}
+
+/**\brief Kommando "batch": führt alle Kommandos einer Datei als einen Stapel aus
+ * Leere Zeilen und Zeilen, die mit # beginnen, werden übersprungen. Alle Änderungen werden erst am Ende mit einem Snapshot gespeichert;
+ * schlägt ein Kommando fehl, wird der Stapel abgebrochen und der Stand vor dem Stapel wiederhergestellt. Die Oberfläche wird nur einmal am Ende neu aufgebaut.
+ * \param query (Kommando und Parameter)
+ * \return bool (false, wenn die Datei nicht gelesen werden kann oder ein Kommando fehlschlägt)
+ */
+bool userwindow::commandBatch(const QStringList &query)
+{
+    if (query.size() != 2) {
+        return commandFailed("Nicht genug oder zu viele Parameter für 'batch'...");
+    }
+    ifstream file(query[1].toStdString());
+    if (!file) {
+        return commandFailed("Die Datei " + query[1] + " konnte nicht gelesen werden.");
+    }
+    engine.beginBatch();
+    batchRunning = true;
+    string line;
+    int lineNumber = 0;
+    int commands = 0;
+    bool success = true;
+    while (getline(file, line)) {
+        lineNumber++;
+        QString input = QString::fromStdString(line).trimmed();
+        if (input.isEmpty() || input.startsWith("#")) {
+            continue;
+        }
+        echoCommand(input);
+        if (!runCommand(input.split(" "))) {
+            success = false;
+            break;
+        }
+        commands++;
+    }
+    batchRunning = false;
+    if (success) {
+        engine.commitBatch();
+    }
+    else {
+        engine.rollbackBatch();
+    }
+    userModel->clearMarked();
+    updateUserGrid();
+    updateBeverageGrid(beverages);
+    if (!success) {
+        return commandFailed("Stapel in Zeile " + QString::number(lineNumber) + " abgebrochen, es wurde nichts gespeichert.");
+    }
+    ui->textBrowser_clOutput->append("Stapel mit " + QString::number(commands) + " Kommandos ausgeführt und gespeichert.");
+    return true;
+}
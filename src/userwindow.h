@@ -2,13 +2,18 @@
 #define USERWINDOW_H
 
 #include <QMainWindow>
+#include <QPushButton>
+#include <QSignalMapper>
+#include <QElapsedTimer>
 #include "includes.h"
 #include "headers.h"
+#include "logmodelclass.h"
+#include "usermodelclass.h"
 
 /**\brief Klasse "Userwindow" für das Anzeigen und die Interaktion mit der GUI
  * Erstellt das GUI (zum Teil dynamisch) und verbindet Eingaben über Signals und Slots mit verschiedenen Ausgaben.
- * Greift auf die Klassen "beverageclass", "userclass" und "systemclass" zu und managed die Objekte dieser Klassen (zum Teil in Vektoren).
- * Kümmert sich um die Persistenz der Daten.
+ * Ist nur eine Oberfläche über der Klasse "PosEngineclass", die die Objekte der Klassen "beverageclass", "userclass" und "systemclass" sowie deren Persistenz managed.
+ * Gelesen wird direkt aus den Vektoren der Engine, geändert wird ausschließlich über deren Methoden.
  */
 namespace Ui {
 class userwindow;
@@ -24,38 +29,67 @@ public:
     ~userwindow();
     // GUI Methoden
     void showTime();
-    bool updateUserGrid(vector<User> fUsers);
-    bool updateBeverageGrid(vector<Beverage> fBeverages);
+    bool updateUserGrid();
+    bool updateBeverageGrid(const vector<Beverage> &fBeverages);
+    void updateBeverageButton(int id);
     bool clearGrid(QLayout* layout);
     bool updateMenuButtons(bool status);
+    void startBackgroundAudit();
+    void setStartupTimer(const QElapsedTimer &timer);
 
     // Zugriff auf Objekte anderer Klassen etc.
-    System system;
-    // Verwendung eines Vektors um die user/beverage-Objekte abzuspeichern, da ein Array einen gravierenden Nachteil mit sich bringt: Die Größe geht bei der Übergabe an eine Funktion verloren. Es wären also noch weitere Attribute nötig.
-    // Zudem bringt der Vektor einige weitere Vorteile beim Umgang mit den Objekten (dynamische Größe, mehr Funktionen um mit den Objekten zu interagieren...)
-    vector<User> users;
-    vector<Beverage> beverages;
-
-    // Backend Methoden
-    bool writeUsersToDB(vector<User>);
-    bool writeBeveragesToDB(vector<Beverage>);
-    bool writeSystemToDB(System);
-    vector<User> readUsersFromDB();
-    vector<Beverage> readBeveragesFromDB();
-    System readSystemFromDB();
-    string convertUserID(int id);
+    PosEngine engine; // besitzt Nutzer, Getränke, System und Persistenz; sämtliche Änderungen laufen über die Engine
+    // nur lesende Sicht auf den Zustand der Engine (Position im Vektor = ID)
+    const System &system;
+    const vector<User> &users;
+    const vector<Beverage> &beverages;
 
 public slots:
     bool userButtonPressed(int id);
     bool beverageButtonPressed(int id);
+    bool barcodeScanned(string code);
+    bool sellBeverages(const map<int, int> &items);
+    bool bookSales(const vector<pair<int, int> > &sales, QString &error);
+    void showAuditReport(QStringList lines, int problems);
 
 private:
     Ui::userwindow *ui;
+    UserModel *userModel; // Model der Nutzerauswahl (listView_userselect)
+    QSignalMapper *beverageMapper; // verbindet alle Getränkebuttons mit beverageButtonPressed(int)
+    vector<QPushButton*> beverageButtons; // Button jedes Getränks (gleiche Position wie im Vektor beverages)
+    vector<bool> beverageLowStock; // true, wenn das Getränk gerade als niedriger Bestand gezählt wird
+    int lowStockCount; // Anzahl der Getränke mit niedrigem Bestand (stock <= 5)
+    string scanBuffer; // bisher empfangene Ziffern eines Barcodes
+    QElapsedTimer scanTimer; // Zeit seit der letzten Ziffer
+    map<int, int> cart; // Warenkorb des aktiven Nutzers: GetränkeID -> Anzahl
+    vector<int> roundUsers; // Nutzer, für die gerade eine Runde ausgegeben wird (leer, wenn keine Runde aktiv ist)
+    void updateRoundButton();
+    void addToCart(int id);
+    void clearCart();
+    void showCart();
+    void logoutAfterSale();
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    LogModel *historyModel; // Model der Historie bzw. Einzahlungsliste (listView_history)
     bool adminLoggedIn; // für das Einstellungs-Fenster wichtig: setzt fest ob ein Admin eingeloggt ist und erlaubt somit die Eingabe von Kommandos
+    std::thread auditThread; // Audit beim Start (siehe startBackgroundAudit)
+    int auditProblems; // Abweichungen des letzten Audits beim Start
+    bool auditPending; // Audit beim Start, sobald die Logs geladen sind
+    QElapsedTimer startupTimer; // läuft seit dem Programmstart
+    qint64 firstFrameTime; // ms vom Programmstart bis zum ersten Bild der Nutzerauswahl (-1, solange noch nichts angezeigt wurde)
+    qint64 loadTime; // ms für PosEngine::load im Konstruktor
+    bool beverageGridPending; // die Getränkeauswahl wurde noch nicht aufgebaut (siehe finishStartup)
+    void finishStartup();
     int activeUserID; // die Methode userButtonPressed(int id) bekommt zwar einmal durch Signal-Mapping den aktiven Nutzer, aber sämtliche andere Methoden wüssten nicht, wer gerade aktiv ist, also wird es in diesen int geschrieben. Beim "Ausloggen" muss also zwingend int=-1 erfolgen!!
 
 private slots:
+    void on_listView_userselect_clicked(const QModelIndex &index);
+    void on_lineEdit_usersearch_textChanged(const QString &text);
     void on_pushButton_pageBack_clicked();
+    void on_pushButton_cart_toggled(bool checked);
+    void on_pushButton_checkout_clicked();
+    void on_pushButton_clearCart_clicked();
+    void on_pushButton_round_toggled(bool checked);
+    void on_pushButton_roundBeverage_clicked();
     void on_pushButton_history_clicked();
     void on_pushButton_addMoney_clicked();
     void on_pushButton_0_clicked();
@@ -73,6 +107,55 @@ private slots:
     void on_pushButton_saveTransaction_clicked();
     void on_pushButton_settings_clicked();
     void on_lineEdit_cl_returnPressed();
+
+private:
+    // Kommandozeile: jedes Kommando ist eine Methode, die über commandTable bzw. commandIndex gefunden wird
+    struct Command {
+        const char *name;
+        bool (userwindow::*handler)(const QStringList &query);
+        bool batchable; // darf in einem Stapel (batch) vorkommen
+    };
+    static const Command commandTable[];
+    static const int commandCount;
+    HashIndex<string> commandIndex; // Name -> Position in commandTable
+    bool batchRunning; // true, während ein Stapel läuft: die Oberfläche wird erst am Ende neu aufgebaut
+    void echoCommand(const QString &input);
+    bool runCommand(const QStringList &query);
+    bool commandFailed(const QString &message);
+    bool commandLogout(const QStringList &query);
+    bool commandRestart(const QStringList &query);
+    bool commandShutdown(const QStringList &query);
+    bool commandSetPassword(const QStringList &query);
+    bool commandHelp(const QStringList &query);
+    bool commandListUsers(const QStringList &query);
+    bool commandListBeverages(const QStringList &query);
+    bool commandSetRole(const QStringList &query);
+    bool commandWithdraw(const QStringList &query);
+    bool commandClearDepositLog(const QStringList &query);
+    bool commandAddUser(const QStringList &query);
+    bool commandDeleteUser(const QStringList &query);
+    bool commandRenameUser(const QStringList &query);
+    bool commandRestock(const QStringList &query);
+    bool commandGetStock(const QStringList &query);
+    bool commandAddBeverage(const QStringList &query);
+    bool commandDeleteBeverage(const QStringList &query);
+    bool commandRenameBeverage(const QStringList &query);
+    bool commandSetPrice(const QStringList &query);
+    bool commandConsumption(const QStringList &query);
+    bool commandRound(const QStringList &query);
+    bool commandStatement(const QStringList &query);
+    bool commandSales(const QStringList &query);
+    bool commandTopUsers(const QStringList &query);
+    bool commandAnalyze(const QStringList &query);
+    bool commandAudit(const QStringList &query);
+    bool commandHistory(const QStringList &query);
+    bool commandDepositLog(const QStringList &query);
+    bool commandSetDurability(const QStringList &query);
+    bool commandLogStats(const QStringList &query);
+    bool commandStats(const QStringList &query);
+    bool commandExportDB(const QStringList &query);
+    bool commandImportDB(const QStringList &query);
+    bool commandBatch(const QStringList &query);
 };
 
 #endif // USERWINDOW_H